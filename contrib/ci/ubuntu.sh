@@ -17,5 +17,8 @@ ninja -C build install -v
 mkdir -p dist/docs
 cp build/docs/* dist/docs -R
 
+#check the firmware parsers still scale linearly, now the plugins are installed
+meson test -C build --benchmark --print-errorlogs firmware-benchmark
+
 #run static analysis (these mostly won't be critical)
 ninja -C build scan-build -v
@@ -0,0 +1,45 @@
+#!/usr/bin/python3
+# SPDX-License-Identifier: LGPL-2.1+
+
+import argparse
+import sys
+import subprocess
+import os
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run a libFuzzer harness on all cores')
+    parser.add_argument('--seeds', '-i', action='append', default=[],
+                        help='read-only seed corpus directory')
+    parser.add_argument('--output', '-o', help='findings output directory')
+    parser.add_argument('path', type=str, help='the fuzzer harness')
+    args = parser.parse_args()
+    if not args.output:
+        print('-o required')
+        return 1
+
+    # new corpus entries and crashes are written here, never into the seeds
+    corpus = os.path.join(args.output, 'corpus')
+    if not os.path.exists(corpus):
+        os.makedirs(corpus)
+
+    argv = [
+        args.path,
+        '-jobs=%i' % os.cpu_count(),
+        '-workers=%i' % os.cpu_count(),
+        '-rss_limit_mb=300',
+        '-artifact_prefix=%s/' % args.output,
+        corpus,
+    ]
+    for seed in args.seeds:
+        if os.path.isdir(seed):
+            argv.append(seed)
+    print(argv)
+    try:
+        return subprocess.call(argv, cwd=args.output)
+    except KeyboardInterrupt as _:
+        return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -4,16 +4,25 @@
  * SPDX-License-Identifier: LGPL-2.1+
  */
 
+/* for memfd_create() */
+#define _GNU_SOURCE
+
 #include "config.h"
 
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #ifdef HAVE_GIO_UNIX
 #include <gio/gunixfdlist.h>
+#include <unistd.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -47,8 +56,18 @@ typedef struct {
 	gchar				*host_machine_id;
 	GDBusConnection			*conn;
 	GDBusProxy			*proxy;
+	gboolean			 cache_enabled;
+	GPtrArray			*cache_devices;	/* (nullable) of FwupdDevice */
+	GPtrArray			*cache_remotes;	/* (nullable) of FwupdRemote */
+	GPtrArray			*cache_pending;	/* (nullable) of FwupdClientCacheSignal */
 } FwupdClientPrivate;
 
+/* a device signal received while GetDevices is in flight */
+typedef struct {
+	gchar				*signal_name;
+	FwupdDevice			*dev;
+} FwupdClientCacheSignal;
+
 enum {
 	SIGNAL_CHANGED,
 	SIGNAL_STATUS_CHANGED,
@@ -203,6 +222,133 @@ fwupd_client_properties_changed_cb (GDBusProxy *proxy,
 	}
 }
 
+static void
+fwupd_client_cache_signal_free (FwupdClientCacheSignal *item)
+{
+	g_free (item->signal_name);
+	g_object_unref (item->dev);
+	g_free (item);
+}
+
+/* also discards the result of any GetDevices call that is in flight */
+static void
+fwupd_client_cache_invalidate (FwupdClient *client)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_clear_pointer (&priv->cache_devices, g_ptr_array_unref);
+	g_clear_pointer (&priv->cache_remotes, g_ptr_array_unref);
+	g_clear_pointer (&priv->cache_pending, g_ptr_array_unref);
+}
+
+/* the returned objects are shared with the cache */
+static GPtrArray *
+fwupd_client_cache_copy (GPtrArray *array)
+{
+	GPtrArray *array_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < array->len; i++)
+		g_ptr_array_add (array_new, g_object_ref (g_ptr_array_index (array, i)));
+	return array_new;
+}
+
+static gboolean
+fwupd_client_cache_find_device (FwupdClient *client, FwupdDevice *dev, guint *idx)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	for (guint i = 0; i < priv->cache_devices->len; i++) {
+		FwupdDevice *dev_tmp = g_ptr_array_index (priv->cache_devices, i);
+		if (g_strcmp0 (fwupd_device_get_id (dev_tmp),
+			       fwupd_device_get_id (dev)) == 0) {
+			*idx = i;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void
+fwupd_client_cache_apply_device (FwupdClient *client, const gchar *signal_name, FwupdDevice *dev)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	guint idx = 0;
+
+	if (g_strcmp0 (signal_name, "DeviceAdded") == 0) {
+		if (fwupd_client_cache_find_device (client, dev, &idx))
+			g_ptr_array_remove_index (priv->cache_devices, idx);
+		g_ptr_array_add (priv->cache_devices, g_object_ref (dev));
+	} else if (g_strcmp0 (signal_name, "DeviceRemoved") == 0) {
+		if (fwupd_client_cache_find_device (client, dev, &idx))
+			g_ptr_array_remove_index (priv->cache_devices, idx);
+	} else if (g_strcmp0 (signal_name, "DeviceChanged") == 0) {
+		if (!fwupd_client_cache_find_device (client, dev, &idx)) {
+			g_ptr_array_add (priv->cache_devices, g_object_ref (dev));
+		} else {
+			g_object_unref (g_ptr_array_index (priv->cache_devices, idx));
+			priv->cache_devices->pdata[idx] = g_object_ref (dev);
+		}
+	}
+	fwupd_device_array_ensure_parents (priv->cache_devices);
+}
+
+/* apply a device signal to the cache before it is re-emitted, so that
+ * handlers calling fwupd_client_get_devices() see the new state */
+static void
+fwupd_client_cache_apply (FwupdClient *client, const gchar *signal_name, FwupdDevice *dev)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+
+	/* the signal may or may not be included in the GetDevices result, so
+	 * replay it on top once that arrives; the daemon emits a signal for
+	 * every change so the cache always ends up with the latest state */
+	if (priv->cache_pending != NULL) {
+		FwupdClientCacheSignal *item = g_new0 (FwupdClientCacheSignal, 1);
+		item->signal_name = g_strdup (signal_name);
+		item->dev = g_object_ref (dev);
+		g_ptr_array_add (priv->cache_pending, item);
+		return;
+	}
+	if (priv->cache_devices == NULL)
+		return;
+	fwupd_client_cache_apply_device (client, signal_name, dev);
+}
+
+/* start queueing device signals until fwupd_client_cache_fetch_done() */
+static void
+fwupd_client_cache_fetch_start (FwupdClient *client)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	if (!priv->cache_enabled || priv->cache_pending != NULL)
+		return;
+	priv->cache_pending = g_ptr_array_new_with_free_func ((GDestroyNotify) fwupd_client_cache_signal_free);
+}
+
+/* @devices is the GetDevices result, and is not used if the cache was
+ * invalidated while the call was in flight */
+static void
+fwupd_client_cache_fetch_done (FwupdClient *client, GPtrArray *devices)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(GPtrArray) pending = g_steal_pointer (&priv->cache_pending);
+
+	if (pending == NULL)
+		return;
+	g_clear_pointer (&priv->cache_devices, g_ptr_array_unref);
+	priv->cache_devices = fwupd_client_cache_copy (devices);
+	for (guint i = 0; i < pending->len; i++) {
+		FwupdClientCacheSignal *item = g_ptr_array_index (pending, i);
+		fwupd_client_cache_apply_device (client, item->signal_name, item->dev);
+	}
+}
+
+static void
+fwupd_client_name_owner_notify_cb (GDBusProxy *proxy,
+				   GParamSpec *pspec,
+				   FwupdClient *client)
+{
+	/* the daemon was restarted, so nothing we have is valid */
+	g_debug ("daemon name owner changed, invalidating cache");
+	fwupd_client_cache_invalidate (client);
+}
+
 static void
 fwupd_client_signal_cb (GDBusProxy *proxy,
 			const gchar *sender_name,
@@ -212,12 +358,16 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 {
 	g_autoptr(FwupdDevice) dev = NULL;
 	if (g_strcmp0 (signal_name, "Changed") == 0) {
+		/* there is no per-remote signal and devices may have been
+		 * changed without a DeviceChanged, so fetch everything again */
+		fwupd_client_cache_invalidate (client);
 		g_debug ("Emitting ::changed()");
 		g_signal_emit (client, signals[SIGNAL_CHANGED], 0);
 		return;
 	}
 	if (g_strcmp0 (signal_name, "DeviceAdded") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cache_apply (client, signal_name, dev);
 		g_debug ("Emitting ::device-added(%s)",
 			 fwupd_device_get_id (dev));
 		g_signal_emit (client, signals[SIGNAL_DEVICE_ADDED], 0, dev);
@@ -225,6 +375,7 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	}
 	if (g_strcmp0 (signal_name, "DeviceRemoved") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cache_apply (client, signal_name, dev);
 		g_signal_emit (client, signals[SIGNAL_DEVICE_REMOVED], 0, dev);
 		g_debug ("Emitting ::device-removed(%s)",
 			 fwupd_device_get_id (dev));
@@ -232,6 +383,7 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	}
 	if (g_strcmp0 (signal_name, "DeviceChanged") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cache_apply (client, signal_name, dev);
 		g_signal_emit (client, signals[SIGNAL_DEVICE_CHANGED], 0, dev);
 		g_debug ("Emitting ::device-changed(%s)",
 			 fwupd_device_get_id (dev));
@@ -240,6 +392,53 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	g_debug ("Unknown signal name '%s' from %s", signal_name, sender_name);
 }
 
+/**
+ * fwupd_client_set_cache_enabled:
+ * @client: A #FwupdClient
+ * @cache_enabled: %TRUE to cache devices and remotes
+ *
+ * Enables a client-side cache of the devices and remotes. The first call to
+ * fwupd_client_get_devices(), fwupd_client_get_devices_async() or
+ * fwupd_client_get_remotes() fetches the state from the daemon, and later
+ * calls return the cached objects, which are kept up to date from the device
+ * signals. Everything is fetched again after the daemon emits ::changed.
+ *
+ * The signals are only processed when the thread-default #GMainContext is
+ * iterated, so this should only be used by long-running clients with a
+ * main loop. Devices updated from signals do not include any properties
+ * that the daemon only returns to trusted callers, such as the serial
+ * number. The returned objects are shared and must not be modified.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_set_cache_enabled (FwupdClient *client, gboolean cache_enabled)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	priv->cache_enabled = cache_enabled;
+	if (!cache_enabled)
+		fwupd_client_cache_invalidate (client);
+}
+
+/**
+ * fwupd_client_get_cache_enabled:
+ * @client: A #FwupdClient
+ *
+ * Gets if the client-side cache is enabled.
+ *
+ * Returns: %TRUE if fwupd_client_set_cache_enabled() was used
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_get_cache_enabled (FwupdClient *client)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	return priv->cache_enabled;
+}
+
 /**
  * fwupd_client_connect:
  * @client: A #FwupdClient
@@ -289,6 +488,8 @@ fwupd_client_connect (FwupdClient *client, GCancellable *cancellable, GError **e
 			  G_CALLBACK (fwupd_client_properties_changed_cb), client);
 	g_signal_connect (priv->proxy, "g-signal",
 			  G_CALLBACK (fwupd_client_signal_cb), client);
+	g_signal_connect (priv->proxy, "notify::g-name-owner",
+			  G_CALLBACK (fwupd_client_name_owner_notify_cb), client);
 	val = g_dbus_proxy_get_cached_property (priv->proxy, "DaemonVersion");
 	if (val != NULL)
 		fwupd_client_set_daemon_version (client, g_variant_get_string (val, NULL));
@@ -341,6 +542,94 @@ fwupd_client_fixup_dbus_error (GError *error)
 	g_dbus_error_strip_remote_error (error);
 }
 
+/* returns a new #GTask, or %NULL if the client could not connect, in which
+ * case @callback is invoked with the error */
+static GTask *
+fwupd_client_task_new (FwupdClient *client,
+		       GCancellable *cancellable,
+		       GAsyncReadyCallback callback,
+		       gpointer callback_data,
+		       gpointer source_tag)
+{
+	GError *error = NULL;
+	GTask *task = g_task_new (client, cancellable, callback, callback_data);
+	g_task_set_source_tag (task, source_tag);
+
+	/* this only blocks the first time */
+	if (!fwupd_client_connect (client, cancellable, &error)) {
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return NULL;
+	}
+	return task;
+}
+
+static void
+fwupd_client_task_proxy_call_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	GError *error = NULL;
+	GVariant *val;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, error);
+		return;
+	}
+	g_task_return_pointer (task, val, (GDestroyNotify) g_variant_unref);
+}
+
+#ifdef HAVE_GIO_UNIX
+static void
+fwupd_client_task_proxy_call_fd_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	GError *error = NULL;
+	GVariant *val;
+
+	val = g_dbus_proxy_call_with_unix_fd_list_finish (G_DBUS_PROXY (source),
+							   NULL, res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, error);
+		return;
+	}
+	g_task_return_pointer (task, val, (GDestroyNotify) g_variant_unref);
+}
+#endif
+
+/* calls @method_name without waiting for the reply, which allows many
+ * requests to be in flight on the shared connection at the same time */
+static void
+fwupd_client_call_async (FwupdClient *client,
+			 const gchar *method_name,
+			 GVariant *parameters,
+			 GCancellable *cancellable,
+			 GAsyncReadyCallback callback,
+			 gpointer callback_data,
+			 gpointer source_tag)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(GVariant) parameters_ref = NULL;
+	GTask *task;
+
+	if (parameters != NULL)
+		parameters_ref = g_variant_ref_sink (parameters);
+	task = fwupd_client_task_new (client, cancellable, callback,
+				      callback_data, source_tag);
+	if (task == NULL)
+		return;
+	g_dbus_proxy_call (priv->proxy,
+			   method_name,
+			   parameters_ref,
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1,
+			   cancellable,
+			   fwupd_client_task_proxy_call_cb,
+			   task);
+}
+
 /**
  * fwupd_client_get_devices:
  * @client: A #FwupdClient
@@ -357,6 +646,8 @@ GPtrArray *
 fwupd_client_get_devices (FwupdClient *client, GCancellable *cancellable, GError **error)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
 	g_autoptr(GVariant) val = NULL;
 
 	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
@@ -367,6 +658,22 @@ fwupd_client_get_devices (FwupdClient *client, GCancellable *cancellable, GError
 	if (!fwupd_client_connect (client, cancellable, error))
 		return NULL;
 
+	/* kept up to date from signals */
+	if (priv->cache_devices != NULL) {
+		if (priv->cache_devices->len == 0) {
+			g_set_error_literal (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_NOTHING_TO_DO,
+					     "No detected devices");
+			return NULL;
+		}
+		return fwupd_client_cache_copy (priv->cache_devices);
+	}
+
+	/* the proxy subscribed to the device signals when it was created, so
+	 * none can be missed between the snapshot and the first signal */
+	fwupd_client_cache_fetch_start (client);
+
 	/* call into daemon */
 	val = g_dbus_proxy_call_sync (priv->proxy,
 				      "GetDevices",
@@ -374,13 +681,129 @@ fwupd_client_get_devices (FwupdClient *client, GCancellable *cancellable, GError
 				      G_DBUS_CALL_FLAGS_NONE,
 				      -1,
 				      cancellable,
-				      error);
+				      &error_local);
 	if (val == NULL) {
-		if (error != NULL)
-			fwupd_client_fixup_dbus_error (*error);
+		fwupd_client_fixup_dbus_error (error_local);
+
+		/* devices may be added later using DeviceAdded */
+		if (g_error_matches (error_local, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+			g_autoptr(GPtrArray) devices_empty = g_ptr_array_new ();
+			fwupd_client_cache_fetch_done (client, devices_empty);
+		} else {
+			g_clear_pointer (&priv->cache_pending, g_ptr_array_unref);
+		}
+		g_propagate_error (error, g_steal_pointer (&error_local));
 		return NULL;
 	}
-	return fwupd_device_array_from_variant (val);
+	devices = fwupd_device_array_from_variant (val);
+	fwupd_client_cache_fetch_done (client, devices);
+	return g_steal_pointer (&devices);
+}
+
+static void
+fwupd_client_get_devices_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClient *client = g_task_get_source_object (task);
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	GError *error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		if (g_error_matches (error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+			g_autoptr(GPtrArray) devices_empty = g_ptr_array_new ();
+			fwupd_client_cache_fetch_done (client, devices_empty);
+		} else {
+			g_clear_pointer (&priv->cache_pending, g_ptr_array_unref);
+		}
+		g_task_return_error (task, error);
+		return;
+	}
+	devices = fwupd_device_array_from_variant (val);
+	fwupd_client_cache_fetch_done (client, devices);
+	g_task_return_pointer (task,
+			       g_steal_pointer (&devices),
+			       (GDestroyNotify) g_ptr_array_unref);
+}
+
+/**
+ * fwupd_client_get_devices_async:
+ * @client: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the devices registered with the daemon without blocking.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_get_devices_async (FwupdClient *client,
+				GCancellable *cancellable,
+				GAsyncReadyCallback callback,
+				gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	GTask *task;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = fwupd_client_task_new (client, cancellable, callback,
+				      callback_data, fwupd_client_get_devices_async);
+	if (task == NULL)
+		return;
+
+	/* kept up to date from signals */
+	if (priv->cache_devices != NULL) {
+		if (priv->cache_devices->len == 0) {
+			g_task_return_new_error (task,
+						 FWUPD_ERROR,
+						 FWUPD_ERROR_NOTHING_TO_DO,
+						 "No detected devices");
+		} else {
+			g_task_return_pointer (task,
+					       fwupd_client_cache_copy (priv->cache_devices),
+					       (GDestroyNotify) g_ptr_array_unref);
+		}
+		g_object_unref (task);
+		return;
+	}
+
+	/* signals that arrive before the reply are queued */
+	fwupd_client_cache_fetch_start (client);
+	g_dbus_proxy_call (priv->proxy,
+			   "GetDevices",
+			   NULL,
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1,
+			   cancellable,
+			   fwupd_client_get_devices_cb,
+			   task);
+}
+
+/**
+ * fwupd_client_get_devices_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_devices_async().
+ *
+ * Returns: (element-type FwupdDevice) (transfer container): results
+ *
+ * Since: 1.5.0
+ **/
+GPtrArray *
+fwupd_client_get_devices_finish (FwupdClient *client, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer (G_TASK (res), error);
 }
 
 /**
@@ -568,6 +991,61 @@ fwupd_client_get_releases (FwupdClient *client, const gchar *device_id,
 	return fwupd_release_array_from_variant (val);
 }
 
+/**
+ * fwupd_client_get_releases_async:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the releases for a specific device without blocking.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_get_releases_async (FwupdClient *client,
+				 const gchar *device_id,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (device_id != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	fwupd_client_call_async (client, "GetReleases",
+				 g_variant_new ("(s)", device_id),
+				 cancellable, callback, callback_data,
+				 fwupd_client_get_releases_async);
+}
+
+/**
+ * fwupd_client_get_releases_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_releases_async().
+ *
+ * Returns: (element-type FwupdRelease) (transfer container): results
+ *
+ * Since: 1.5.0
+ **/
+GPtrArray *
+fwupd_client_get_releases_finish (FwupdClient *client, GAsyncResult *res, GError **error)
+{
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	val = g_task_propagate_pointer (G_TASK (res), error);
+	if (val == NULL)
+		return NULL;
+	return fwupd_release_array_from_variant (val);
+}
+
 /**
  * fwupd_client_get_downgrades:
  * @client: A #FwupdClient
@@ -658,6 +1136,61 @@ fwupd_client_get_upgrades (FwupdClient *client, const gchar *device_id,
 	return fwupd_release_array_from_variant (val);
 }
 
+/**
+ * fwupd_client_get_upgrades_async:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the upgrades for a specific device without blocking.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_get_upgrades_async (FwupdClient *client,
+				 const gchar *device_id,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (device_id != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	fwupd_client_call_async (client, "GetUpgrades",
+				 g_variant_new ("(s)", device_id),
+				 cancellable, callback, callback_data,
+				 fwupd_client_get_upgrades_async);
+}
+
+/**
+ * fwupd_client_get_upgrades_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_upgrades_async().
+ *
+ * Returns: (element-type FwupdRelease) (transfer container): results
+ *
+ * Since: 1.5.0
+ **/
+GPtrArray *
+fwupd_client_get_upgrades_finish (FwupdClient *client, GAsyncResult *res, GError **error)
+{
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	val = g_task_propagate_pointer (G_TASK (res), error);
+	if (val == NULL)
+		return NULL;
+	return fwupd_release_array_from_variant (val);
+}
+
 static void
 fwupd_client_proxy_call_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -818,37 +1351,90 @@ fwupd_client_verify (FwupdClient *client, const gchar *device_id,
 }
 
 /**
- * fwupd_client_verify_update:
+ * fwupd_client_verify_async:
  * @client: A #FwupdClient
  * @device_id: the device ID
  * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Verify a specific device without blocking.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_verify_async (FwupdClient *client,
+			   const gchar *device_id,
+			   GCancellable *cancellable,
+			   GAsyncReadyCallback callback,
+			   gpointer callback_data)
+{
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (device_id != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	fwupd_client_call_async (client, "Verify",
+				 g_variant_new ("(s)", device_id),
+				 cancellable, callback, callback_data,
+				 fwupd_client_verify_async);
+}
+
+/**
+ * fwupd_client_verify_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
  * @error: the #GError, or %NULL
  *
- * Update the verification record for a specific device.
+ * Gets the result of fwupd_client_verify_async().
  *
  * Returns: %TRUE for verification success
  *
- * Since: 0.8.0
+ * Since: 1.5.0
  **/
 gboolean
-fwupd_client_verify_update (FwupdClient *client, const gchar *device_id,
-		     GCancellable *cancellable, GError **error)
+fwupd_client_verify_finish (FwupdClient *client, GAsyncResult *res, GError **error)
 {
-	FwupdClientPrivate *priv = GET_PRIVATE (client);
-	g_autoptr(FwupdClientHelper) helper = NULL;
+	g_autoptr(GVariant) val = NULL;
 
 	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
-	g_return_val_if_fail (device_id != NULL, FALSE);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, client), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	/* connect */
-	if (!fwupd_client_connect (client, cancellable, error))
-		return FALSE;
+	val = g_task_propagate_pointer (G_TASK (res), error);
+	return val != NULL;
+}
 
-	/* call into daemon */
-	helper = fwupd_client_helper_new ();
-	g_dbus_proxy_call (priv->proxy,
+/**
+ * fwupd_client_verify_update:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Update the verification record for a specific device.
+ *
+ * Returns: %TRUE for verification success
+ *
+ * Since: 0.8.0
+ **/
+gboolean
+fwupd_client_verify_update (FwupdClient *client, const gchar *device_id,
+		     GCancellable *cancellable, GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	g_return_val_if_fail (device_id != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* connect */
+	if (!fwupd_client_connect (client, cancellable, error))
+		return FALSE;
+
+	/* call into daemon */
+	helper = fwupd_client_helper_new ();
+	g_dbus_proxy_call (priv->proxy,
 			   "VerifyUpdate",
 			   g_variant_new ("(s)", device_id),
 			   G_DBUS_CALL_FLAGS_NONE,
@@ -1030,55 +1616,88 @@ fwupd_client_send_message_cb (GObject *source_object, GAsyncResult *res, gpointe
 }
 #endif
 
-/**
- * fwupd_client_install:
- * @client: A #FwupdClient
- * @device_id: the device ID
- * @filename: the filename to install
- * @install_flags: the #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_ALLOW_REINSTALL
- * @cancellable: the #GCancellable, or %NULL
- * @error: the #GError, or %NULL
- *
- * Install a file onto a specific device.
- *
- * Returns: %TRUE for success
- *
- * Since: 0.7.0
- **/
-gboolean
-fwupd_client_install (FwupdClient *client,
-		      const gchar *device_id,
-		      const gchar *filename,
-		      FwupdInstallFlags install_flags,
-		      GCancellable *cancellable,
-		      GError **error)
-{
 #ifdef HAVE_GIO_UNIX
-	FwupdClientPrivate *priv = GET_PRIVATE (client);
-	GVariant *body;
-	GVariantBuilder builder;
-	gint retval;
+/* the caller must close the returned fd */
+static gint
+fwupd_client_bytes_to_fd (GBytes *bytes, GError **error)
+{
 	gint fd;
-	g_autoptr(FwupdClientHelper) helper = NULL;
-	g_autoptr(GDBusMessage) request = NULL;
-	g_autoptr(GUnixFDList) fd_list = NULL;
+	gsize bufsz = 0;
+	gsize offset = 0;
+	const guint8 *buf = g_bytes_get_data (bytes, &bufsz);
+#ifndef HAVE_MEMFD_CREATE
+	g_autofree gchar *tmpfn = NULL;
+#endif
 
-	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
-	g_return_val_if_fail (device_id != NULL, FALSE);
-	g_return_val_if_fail (filename != NULL, FALSE);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+#ifdef HAVE_MEMFD_CREATE
+	/* the daemon can map a sealed memfd without copying the data */
+	fd = memfd_create ("fwupd-client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INTERNAL,
+			     "failed to create memfd: %s",
+			     g_strerror (errno));
+		return -1;
+	}
+#else
+	fd = g_file_open_tmp ("fwupd-client-XXXXXX", &tmpfn, error);
+	if (fd < 0)
+		return -1;
+	g_unlink (tmpfn);
+#endif
+	while (offset < bufsz) {
+		gssize wrote = write (fd, buf + offset, bufsz - offset);
+		if (wrote < 0) {
+			if (errno == EINTR)
+				continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_WRITE,
+				     "failed to write blob: %s",
+				     g_strerror (errno));
+			close (fd);
+			return -1;
+		}
+		offset += (gsize) wrote;
+	}
+#ifdef HAVE_MEMFD_CREATE
+	if (fcntl (fd, F_ADD_SEALS,
+		   F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INTERNAL,
+			     "failed to seal memfd: %s",
+			     g_strerror (errno));
+		close (fd);
+		return -1;
+	}
+#endif
+	if (lseek (fd, 0, SEEK_SET) < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_READ,
+			     "failed to rewind: %s",
+			     g_strerror (errno));
+		close (fd);
+		return -1;
+	}
+	return fd;
+}
 
-	/* connect */
-	if (!fwupd_client_connect (client, cancellable, error))
-		return FALSE;
+/* returns a floating a{sv} */
+static GVariant *
+fwupd_client_install_options (const gchar *filename, FwupdInstallFlags install_flags)
+{
+	GVariantBuilder builder;
 
-	/* set options */
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
 	g_variant_builder_add (&builder, "{sv}",
 			       "reason", g_variant_new_string ("user-action"));
-	g_variant_builder_add (&builder, "{sv}",
-			       "filename", g_variant_new_string (filename));
+	if (filename != NULL) {
+		g_variant_builder_add (&builder, "{sv}",
+				       "filename", g_variant_new_string (filename));
+	}
 	if (install_flags & FWUPD_INSTALL_FLAG_OFFLINE) {
 		g_variant_builder_add (&builder, "{sv}",
 				       "offline", g_variant_new_boolean (TRUE));
@@ -1099,17 +1718,25 @@ fwupd_client_install (FwupdClient *client,
 		g_variant_builder_add (&builder, "{sv}",
 				       "no-history", g_variant_new_boolean (TRUE));
 	}
+	return g_variant_builder_end (&builder);
+}
 
-	/* open file */
-	fd = open (filename, O_RDONLY);
-	if (fd < 0) {
-		g_set_error (error,
-			     FWUPD_ERROR,
-			     FWUPD_ERROR_INVALID_FILE,
-			     "failed to open %s",
-			     filename);
-		return FALSE;
-	}
+/* closes @fd when done */
+static gboolean
+fwupd_client_install_fd (FwupdClient *client,
+			 const gchar *device_id,
+			 gint fd,
+			 const gchar *filename,
+			 FwupdInstallFlags install_flags,
+			 GCancellable *cancellable,
+			 GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	GVariant *body;
+	gint retval;
+	g_autoptr(FwupdClientHelper) helper = NULL;
+	g_autoptr(GDBusMessage) request = NULL;
+	g_autoptr(GUnixFDList) fd_list = NULL;
 
 	/* set out of band file descriptor */
 	fd_list = g_unix_fd_list_new ();
@@ -1126,7 +1753,8 @@ fwupd_client_install (FwupdClient *client,
 
 	/* call into daemon */
 	helper = fwupd_client_helper_new ();
-	body = g_variant_new ("(sha{sv})", device_id, fd, &builder);
+	body = g_variant_new ("(sh@a{sv})", device_id, fd,
+			      fwupd_client_install_options (filename, install_flags));
 	g_dbus_message_set_body (request, body);
 	g_dbus_connection_send_message_with_reply (priv->conn,
 						   request,
@@ -1143,6 +1771,221 @@ fwupd_client_install (FwupdClient *client,
 		return FALSE;
 	}
 	return TRUE;
+}
+#endif
+
+/**
+ * fwupd_client_install:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @filename: the filename to install
+ * @install_flags: the #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_ALLOW_REINSTALL
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Install a file onto a specific device.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 0.7.0
+ **/
+gboolean
+fwupd_client_install (FwupdClient *client,
+		      const gchar *device_id,
+		      const gchar *filename,
+		      FwupdInstallFlags install_flags,
+		      GCancellable *cancellable,
+		      GError **error)
+{
+#ifdef HAVE_GIO_UNIX
+	gint fd;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	g_return_val_if_fail (device_id != NULL, FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* connect */
+	if (!fwupd_client_connect (client, cancellable, error))
+		return FALSE;
+
+	/* open file */
+	fd = open (filename, O_RDONLY);
+	if (fd < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to open %s",
+			     filename);
+		return FALSE;
+	}
+	return fwupd_client_install_fd (client, device_id, fd, filename,
+					install_flags, cancellable, error);
+#else
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "Not supported as <glib-unix.h> is unavailable");
+	return FALSE;
+#endif
+}
+
+/**
+ * fwupd_client_install_async:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @filename: the filename to install
+ * @install_flags: the #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_ALLOW_REINSTALL
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Install a file onto a specific device without blocking.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_install_async (FwupdClient *client,
+			    const gchar *device_id,
+			    const gchar *filename,
+			    FwupdInstallFlags install_flags,
+			    GCancellable *cancellable,
+			    GAsyncReadyCallback callback,
+			    gpointer callback_data)
+{
+#ifdef HAVE_GIO_UNIX
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	GError *error = NULL;
+	GTask *task;
+	gint fd;
+	gint idx;
+	g_autoptr(GUnixFDList) fd_list = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (device_id != NULL);
+	g_return_if_fail (filename != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = fwupd_client_task_new (client, cancellable, callback, callback_data,
+				      fwupd_client_install_async);
+	if (task == NULL)
+		return;
+
+	/* open file */
+	fd = open (filename, O_RDONLY);
+	if (fd < 0) {
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "failed to open %s",
+					 filename);
+		g_object_unref (task);
+		return;
+	}
+
+	/* set out of band file descriptor, which does a dup() */
+	fd_list = g_unix_fd_list_new ();
+	idx = g_unix_fd_list_append (fd_list, fd, &error);
+	close (fd);
+	if (idx < 0) {
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	/* call into daemon */
+	g_dbus_proxy_call_with_unix_fd_list (priv->proxy,
+					     "Install",
+					     g_variant_new ("(sh@a{sv})",
+							    device_id, idx,
+							    fwupd_client_install_options (filename,
+											  install_flags)),
+					     G_DBUS_CALL_FLAGS_NONE,
+					     G_MAXINT,
+					     fd_list,
+					     cancellable,
+					     fwupd_client_task_proxy_call_fd_cb,
+					     task);
+#else
+	GTask *task = g_task_new (client, cancellable, callback, callback_data);
+	g_task_return_new_error (task,
+				 FWUPD_ERROR,
+				 FWUPD_ERROR_NOT_SUPPORTED,
+				 "Not supported as <glib-unix.h> is unavailable");
+	g_object_unref (task);
+#endif
+}
+
+/**
+ * fwupd_client_install_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_install_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_install_finish (FwupdClient *client, GAsyncResult *res, GError **error)
+{
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, client), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	val = g_task_propagate_pointer (G_TASK (res), error);
+	return val != NULL;
+}
+
+/**
+ * fwupd_client_install_bytes:
+ * @client: A #FwupdClient
+ * @device_id: the device ID
+ * @bytes: #GBytes
+ * @install_flags: the #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_ALLOW_REINSTALL
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Install firmware onto a specific device. Where supported the blob is
+ * passed to the daemon in a sealed memfd so that it does not have to be
+ * copied.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_install_bytes (FwupdClient *client,
+			    const gchar *device_id,
+			    GBytes *bytes,
+			    FwupdInstallFlags install_flags,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+#ifdef HAVE_GIO_UNIX
+	gint fd;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	g_return_val_if_fail (device_id != NULL, FALSE);
+	g_return_val_if_fail (bytes != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* connect */
+	if (!fwupd_client_connect (client, cancellable, error))
+		return FALSE;
+
+	/* copy the blob once into a sealed memfd */
+	fd = fwupd_client_bytes_to_fd (bytes, error);
+	if (fd < 0)
+		return FALSE;
+	return fwupd_client_install_fd (client, device_id, fd, NULL,
+					install_flags, cancellable, error);
 #else
 	g_set_error_literal (error,
 			     FWUPD_ERROR,
@@ -1480,6 +2323,131 @@ fwupd_client_update_metadata (FwupdClient *client,
 #endif
 }
 
+/**
+ * fwupd_client_update_metadata_async:
+ * @client: A #FwupdClient
+ * @remote_id: the remote ID, e.g. `lvfs-testing`
+ * @metadata_fn: the XML metadata filename
+ * @signature_fn: the GPG signature file
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Updates the metadata without blocking. See fwupd_client_update_metadata()
+ * for details.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_update_metadata_async (FwupdClient *client,
+				    const gchar *remote_id,
+				    const gchar *metadata_fn,
+				    const gchar *signature_fn,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data)
+{
+#ifdef HAVE_GIO_UNIX
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	GError *error = NULL;
+	GTask *task;
+	gint fd;
+	gint fd_sig;
+	gint idx;
+	gint idx_sig;
+	g_autoptr(GUnixFDList) fd_list = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (client));
+	g_return_if_fail (remote_id != NULL);
+	g_return_if_fail (metadata_fn != NULL);
+	g_return_if_fail (signature_fn != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = fwupd_client_task_new (client, cancellable, callback, callback_data,
+				      fwupd_client_update_metadata_async);
+	if (task == NULL)
+		return;
+
+	/* open files */
+	fd = open (metadata_fn, O_RDONLY);
+	if (fd < 0) {
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "failed to open %s",
+					 metadata_fn);
+		g_object_unref (task);
+		return;
+	}
+	fd_sig = open (signature_fn, O_RDONLY);
+	if (fd_sig < 0) {
+		close (fd);
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "failed to open %s",
+					 signature_fn);
+		g_object_unref (task);
+		return;
+	}
+
+	/* set out of band file descriptors, which does a dup() */
+	fd_list = g_unix_fd_list_new ();
+	idx = g_unix_fd_list_append (fd_list, fd, &error);
+	idx_sig = idx < 0 ? -1 : g_unix_fd_list_append (fd_list, fd_sig, &error);
+	close (fd);
+	close (fd_sig);
+	if (idx_sig < 0) {
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		return;
+	}
+
+	/* call into daemon */
+	g_dbus_proxy_call_with_unix_fd_list (priv->proxy,
+					     "UpdateMetadata",
+					     g_variant_new ("(shh)", remote_id, idx, idx_sig),
+					     G_DBUS_CALL_FLAGS_NONE,
+					     -1,
+					     fd_list,
+					     cancellable,
+					     fwupd_client_task_proxy_call_fd_cb,
+					     task);
+#else
+	GTask *task = g_task_new (client, cancellable, callback, callback_data);
+	g_task_return_new_error (task,
+				 FWUPD_ERROR,
+				 FWUPD_ERROR_NOT_SUPPORTED,
+				 "Not supported as <glib-unix.h> is unavailable");
+	g_object_unref (task);
+#endif
+}
+
+/**
+ * fwupd_client_update_metadata_finish:
+ * @client: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_update_metadata_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_update_metadata_finish (FwupdClient *client, GAsyncResult *res, GError **error)
+{
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, client), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	val = g_task_propagate_pointer (G_TASK (res), error);
+	return val != NULL;
+}
+
 /**
  * fwupd_client_get_remotes:
  * @client: A #FwupdClient
@@ -1496,6 +2464,7 @@ GPtrArray *
 fwupd_client_get_remotes (FwupdClient *client, GCancellable *cancellable, GError **error)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(GPtrArray) remotes = NULL;
 	g_autoptr(GVariant) val = NULL;
 
 	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
@@ -1506,6 +2475,10 @@ fwupd_client_get_remotes (FwupdClient *client, GCancellable *cancellable, GError
 	if (!fwupd_client_connect (client, cancellable, error))
 		return NULL;
 
+	/* invalidated by the Changed signal */
+	if (priv->cache_remotes != NULL)
+		return fwupd_client_cache_copy (priv->cache_remotes);
+
 	/* call into daemon */
 	val = g_dbus_proxy_call_sync (priv->proxy,
 				      "GetRemotes",
@@ -1519,7 +2492,59 @@ fwupd_client_get_remotes (FwupdClient *client, GCancellable *cancellable, GError
 			fwupd_client_fixup_dbus_error (*error);
 		return NULL;
 	}
-	return fwupd_remote_array_from_variant (val);
+	remotes = fwupd_remote_array_from_variant (val);
+	if (priv->cache_enabled) {
+		priv->cache_remotes = g_ptr_array_ref (remotes);
+		return fwupd_client_cache_copy (remotes);
+	}
+	return g_steal_pointer (&remotes);
+}
+
+/**
+ * fwupd_client_get_metrics:
+ * @client: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets the latency and throughput of each daemon method since the daemon
+ * was started. Each dictionary has the string key `Id` and the unsigned
+ * 64 bit keys `Count`, `Sum`, `BytesOut`, `P50`, `P95` and `P99`, where the
+ * durations are in microseconds.
+ *
+ * Returns: (transfer full): a #GVariant of type `aa{sv}`, or %NULL
+ *
+ * Since: 1.5.0
+ **/
+GVariant *
+fwupd_client_get_metrics (FwupdClient *client,
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (client);
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (client, cancellable, error))
+		return NULL;
+
+	/* call into daemon */
+	val = g_dbus_proxy_call_sync (priv->proxy,
+				      "GetMetrics",
+				      NULL,
+				      G_DBUS_CALL_FLAGS_NONE,
+				      -1,
+				      cancellable,
+				      error);
+	if (val == NULL) {
+		if (error != NULL)
+			fwupd_client_fixup_dbus_error (*error);
+		return NULL;
+	}
+	return g_variant_get_child_value (val, 0);
 }
 
 /**
@@ -2085,6 +3110,7 @@ fwupd_client_finalize (GObject *object)
 	g_free (priv->daemon_version);
 	g_free (priv->host_product);
 	g_free (priv->host_machine_id);
+	fwupd_client_cache_invalidate (client);
 	if (priv->conn != NULL)
 		g_object_unref (priv->conn);
 	if (priv->proxy != NULL)
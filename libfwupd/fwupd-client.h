@@ -44,9 +44,19 @@ FwupdClient	*fwupd_client_new			(void);
 gboolean	 fwupd_client_connect			(FwupdClient	*client,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_set_cache_enabled		(FwupdClient	*client,
+							 gboolean	 cache_enabled);
+gboolean	 fwupd_client_get_cache_enabled		(FwupdClient	*client);
 GPtrArray	*fwupd_client_get_devices		(FwupdClient	*client,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_get_devices_async		(FwupdClient	*client,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_devices_finish	(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_history		(FwupdClient	*client,
 							 GCancellable	*cancellable,
 							 GError		**error);
@@ -54,6 +64,14 @@ GPtrArray	*fwupd_client_get_releases		(FwupdClient	*client,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_get_releases_async	(FwupdClient	*client,
+							 const gchar	*device_id,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_releases_finish	(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_downgrades		(FwupdClient	*client,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
@@ -62,6 +80,14 @@ GPtrArray	*fwupd_client_get_upgrades		(FwupdClient	*client,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_get_upgrades_async	(FwupdClient	*client,
+							 const gchar	*device_id,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_upgrades_finish	(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_details		(FwupdClient	*client,
 							 const gchar	*filename,
 							 GCancellable	*cancellable,
@@ -70,6 +96,14 @@ gboolean	 fwupd_client_verify			(FwupdClient	*client,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_verify_async		(FwupdClient	*client,
+							 const gchar	*device_id,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_verify_finish		(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
 gboolean	 fwupd_client_verify_update		(FwupdClient	*client,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
@@ -109,12 +143,38 @@ gboolean	 fwupd_client_install			(FwupdClient	*client,
 							 FwupdInstallFlags install_flags,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_install_async		(FwupdClient	*client,
+							 const gchar	*device_id,
+							 const gchar	*filename,
+							 FwupdInstallFlags install_flags,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_install_finish		(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
+gboolean	 fwupd_client_install_bytes		(FwupdClient	*client,
+							 const gchar	*device_id,
+							 GBytes		*bytes,
+							 FwupdInstallFlags install_flags,
+							 GCancellable	*cancellable,
+							 GError		**error);
 gboolean	 fwupd_client_update_metadata		(FwupdClient	*client,
 							 const gchar	*remote_id,
 							 const gchar	*metadata_fn,
 							 const gchar	*signature_fn,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 fwupd_client_update_metadata_async	(FwupdClient	*client,
+							 const gchar	*remote_id,
+							 const gchar	*metadata_fn,
+							 const gchar	*signature_fn,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_update_metadata_finish	(FwupdClient	*client,
+							 GAsyncResult	*res,
+							 GError		**error);
 gboolean	 fwupd_client_modify_remote		(FwupdClient	*client,
 							 const gchar	*remote_id,
 							 const gchar	*key,
@@ -143,6 +203,9 @@ FwupdRemote	*fwupd_client_get_remote_by_id		(FwupdClient	*client,
 							 GCancellable	*cancellable,
 							 GError		**error);
 
+GVariant	*fwupd_client_get_metrics		(FwupdClient	*client,
+							 GCancellable	*cancellable,
+							 GError		**error);
 gchar		**fwupd_client_get_approved_firmware	(FwupdClient	*client,
 							 GCancellable	*cancellable,
 							 GError		**error);
@@ -12,6 +12,15 @@
 
 G_BEGIN_DECLS
 
+typedef struct {
+	const gchar	*key;
+	guint		 id;
+} FwupdVariantKey;
+
 gchar		*fwupd_checksum_format_for_display	(const gchar	*checksum);
+guint		 fwupd_variant_key_lookup		(FwupdVariantKey *keys,
+							 gsize		 nr_keys,
+							 gsize		*sorted,
+							 const gchar	*key);
 
 G_END_DECLS
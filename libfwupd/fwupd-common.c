@@ -12,16 +12,13 @@
 #include "fwupd-release.h"
 
 #include <locale.h>
+#include <stdlib.h>
 #include <string.h>
 #ifdef HAVE_UTSNAME_H
 #include <sys/utsname.h>
 #endif
 #include <json-glib/json-glib.h>
 
-#if !GLIB_CHECK_VERSION(2,54,0)
-#include <errno.h>
-#endif
-
 /**
  * fwupd_checksum_guess_kind:
  * @checksum: A checksum
@@ -565,124 +562,253 @@ fwupd_build_history_report_json (GPtrArray *devices, GError **error)
 	return data;
 }
 
-#define FWUPD_GUID_NAMESPACE_DEFAULT	"6ba7b810-9dad-11d1-80b4-00c04fd430c8"
-#define FWUPD_GUID_NAMESPACE_MICROSOFT	"70ffd812-4c7f-4c7d-0000-000000000000"
-
-typedef struct __attribute__((packed)) {
-	guint32		a;
-	guint16		b;
-	guint16		c;
-	guint16		d;
-	guint8		e[6];
-} fwupd_guid_native_t;
+static gboolean
+fwupd_build_history_report_json_write (GOutputStream *stream,
+				       const gchar *str,
+				       gsize strsz,
+				       GCancellable *cancellable,
+				       GError **error)
+{
+	return g_output_stream_write_all (stream, str, strsz, NULL, cancellable, error);
+}
 
 /**
- * fwupd_guid_to_string:
- * @guid: a #fwupd_guid_t to read
- * @flags: some %FwupdGuidFlags, e.g. %FWUPD_GUID_FLAG_MIXED_ENDIAN
+ * fwupd_build_history_report_json_to_stream:
+ * @devices: (element-type FwupdDevice): devices
+ * @stream: a #GOutputStream
+ * @flags: some %FwupdReportFlags, e.g. %FWUPD_REPORT_FLAG_COMPRESS
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: A #GError or %NULL
  *
- * Returns a text GUID of mixed or BE endian for a packed buffer.
+ * Writes the same JSON report as fwupd_build_history_report_json() to
+ * @stream, one device at a time, so that the memory used does not depend on
+ * the number of devices. The output is not pretty-printed.
  *
- * Returns: A new GUID
+ * If %FWUPD_REPORT_FLAG_COMPRESS is set the report is written in gzip
+ * format. @stream is flushed but not closed.
  *
- * Since: 1.2.5
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
  **/
-gchar *
-fwupd_guid_to_string (const fwupd_guid_t *guid, FwupdGuidFlags flags)
+gboolean
+fwupd_build_history_report_json_to_stream (GPtrArray *devices,
+					   GOutputStream *stream,
+					   FwupdReportFlags flags,
+					   GCancellable *cancellable,
+					   GError **error)
 {
-	fwupd_guid_native_t gnat;
+	gsize header_len = 0;
+	g_autofree gchar *header = NULL;
+	g_autofree gchar *machine_id = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(JsonBuilder) builder = NULL;
+	g_autoptr(JsonGenerator) json_generator = NULL;
+	g_autoptr(JsonNode) json_root = NULL;
 
-	g_return_val_if_fail (guid != NULL, NULL);
+	g_return_val_if_fail (devices != NULL, FALSE);
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	/* copy to avoid issues with aligning */
-	memcpy (&gnat, guid, sizeof(gnat));
+	/* get a hash that represents the machine */
+	machine_id = fwupd_build_machine_id ("fwupd", error);
+	if (machine_id == NULL)
+		return FALSE;
 
-	/* mixed is bizaar, but specified as the DCE encoding */
-	if (flags & FWUPD_GUID_FLAG_MIXED_ENDIAN) {
-		return g_strdup_printf ("%08x-%04x-%04x-%04x-%02x%02x%02x%02x%02x%02x",
-					GUINT32_FROM_LE(gnat.a),
-					GUINT16_FROM_LE(gnat.b),
-					GUINT16_FROM_LE(gnat.c),
-					GUINT16_FROM_BE(gnat.d),
-					gnat.e[0], gnat.e[1],
-					gnat.e[2], gnat.e[3],
-					gnat.e[4], gnat.e[5]);
+	/* compress everything written */
+	if (flags & FWUPD_REPORT_FLAG_COMPRESS) {
+		g_autoptr(GZlibCompressor) compressor = NULL;
+		compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+		ostream = g_converter_output_stream_new (stream, G_CONVERTER (compressor));
+		g_filter_output_stream_set_close_base_stream (G_FILTER_OUTPUT_STREAM (ostream), FALSE);
+	} else {
+		ostream = g_object_ref (stream);
+	}
+
+	/* create header, which is small */
+	builder = json_builder_new ();
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "ReportVersion");
+	json_builder_add_int_value (builder, 2);
+	json_builder_set_member_name (builder, "MachineId");
+	json_builder_add_string_value (builder, machine_id);
+	json_builder_set_member_name (builder, "Metadata");
+	json_builder_begin_object (builder);
+	if (!fwupd_build_history_report_json_metadata (builder, error))
+		return FALSE;
+	json_builder_end_object (builder);
+	json_builder_end_object (builder);
+	json_root = json_builder_get_root (builder);
+	json_generator = json_generator_new ();
+	json_generator_set_root (json_generator, json_root);
+	header = json_generator_to_data (json_generator, &header_len);
+	if (header == NULL || header_len < 2 || header[header_len - 1] != '}') {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "Failed to convert to JSON string");
+		return FALSE;
 	}
-	return g_strdup_printf ("%08x-%04x-%04x-%04x-%02x%02x%02x%02x%02x%02x",
-				GUINT32_FROM_BE(gnat.a),
-				GUINT16_FROM_BE(gnat.b),
-				GUINT16_FROM_BE(gnat.c),
-				GUINT16_FROM_BE(gnat.d),
-				gnat.e[0], gnat.e[1],
-				gnat.e[2], gnat.e[3],
-				gnat.e[4], gnat.e[5]);
+
+	/* leave the object open for the reports */
+	if (!fwupd_build_history_report_json_write (ostream, header, header_len - 1,
+						    cancellable, error))
+		return FALSE;
+	if (!fwupd_build_history_report_json_write (ostream, ",\"Reports\":[", 12,
+						    cancellable, error))
+		return FALSE;
+
+	/* add each device */
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		g_autoptr(JsonNode) json_device = NULL;
+		if (i > 0) {
+			if (!fwupd_build_history_report_json_write (ostream, ",", 1,
+								    cancellable, error))
+				return FALSE;
+		}
+		json_builder_reset (builder);
+		json_builder_begin_object (builder);
+		fwupd_build_history_report_json_device (builder, dev);
+		json_builder_end_object (builder);
+		json_device = json_builder_get_root (builder);
+		json_generator_set_root (json_generator, json_device);
+		if (!json_generator_to_stream (json_generator, ostream, cancellable, error))
+			return FALSE;
+	}
+	if (!fwupd_build_history_report_json_write (ostream, "]}", 2, cancellable, error))
+		return FALSE;
+
+	/* closing the converter writes the gzip trailer */
+	if (flags & FWUPD_REPORT_FLAG_COMPRESS)
+		return g_output_stream_close (ostream, cancellable, error);
+	return g_output_stream_flush (ostream, cancellable, error);
 }
 
-#if !GLIB_CHECK_VERSION(2,54,0)
-static gboolean
-str_has_sign (const gchar *str)
+static gint
+fwupd_variant_key_cmp (gconstpointer a, gconstpointer b)
 {
-	return str[0] == '-' || str[0] == '+';
+	const FwupdVariantKey *key1 = (const FwupdVariantKey *) a;
+	const FwupdVariantKey *key2 = (const FwupdVariantKey *) b;
+	return strcmp (key1->key, key2->key);
 }
 
-static gboolean
-str_has_hex_prefix (const gchar *str)
+/**
+ * fwupd_variant_key_lookup: (skip)
+ * @keys: an array of #FwupdVariantKey
+ * @nr_keys: number of elements in @keys
+ * @sorted: a static flag, initially zero
+ * @key: a dictionary key, e.g. `DeviceId`
+ *
+ * Finds the ID for a dictionary key using a binary search, which is much
+ * faster than comparing the key against every known property name in turn.
+ * The @keys are sorted in place the first time this is called.
+ *
+ * Returns: the ID, or %G_MAXUINT if @key is not known
+ **/
+guint
+fwupd_variant_key_lookup (FwupdVariantKey *keys, gsize nr_keys, gsize *sorted, const gchar *key)
 {
-	return str[0] == '0' && g_ascii_tolower (str[1]) == 'x';
+	FwupdVariantKey needle = { key, 0 };
+	FwupdVariantKey *item;
+
+	if (g_once_init_enter (sorted)) {
+		qsort (keys, nr_keys, sizeof(FwupdVariantKey), fwupd_variant_key_cmp);
+		g_once_init_leave (sorted, 1);
+	}
+	item = bsearch (&needle, keys, nr_keys, sizeof(FwupdVariantKey), fwupd_variant_key_cmp);
+	if (item == NULL)
+		return G_MAXUINT;
+	return item->id;
 }
 
-static gboolean
-g_ascii_string_to_unsigned (const gchar *str,
-			    guint base,
-			    guint64 min,
-			    guint64 max,
-			    guint64 *out_num,
-			    GError **error)
+/* 6ba7b810-9dad-11d1-80b4-00c04fd430c8, always BE */
+static const fwupd_guid_t fwupd_guid_namespace_default = {
+	0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1,
+	0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8 };
+
+/* 70ffd812-4c7f-4c7d-0000-000000000000, always BE */
+static const fwupd_guid_t fwupd_guid_namespace_microsoft = {
+	0x70, 0xff, 0xd8, 0x12, 0x4c, 0x7f, 0x4c, 0x7d,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+/* value of each hex digit plus one, so that zero means invalid */
+static const guint8 fwupd_guid_hex_lut[256] = {
+	['0'] = 0x1, ['1'] = 0x2, ['2'] = 0x3, ['3'] = 0x4, ['4'] = 0x5,
+	['5'] = 0x6, ['6'] = 0x7, ['7'] = 0x8, ['8'] = 0x9, ['9'] = 0xa,
+	['a'] = 0xb, ['b'] = 0xc, ['c'] = 0xd, ['d'] = 0xe, ['e'] = 0xf, ['f'] = 0x10,
+	['A'] = 0xb, ['B'] = 0xc, ['C'] = 0xd, ['D'] = 0xe, ['E'] = 0xf, ['F'] = 0x10,
+};
+
+/* offset of the first hex digit of each byte in the string form */
+static const guint8 fwupd_guid_str_offsets[16] = {
+	0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34 };
+
+/* the mixed encoding swaps the first three sections */
+static const guint8 fwupd_guid_mixed_order[16] = {
+	3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 };
+static const guint8 fwupd_guid_be_order[16] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+/**
+ * fwupd_guid_to_buf:
+ * @guid: a #fwupd_guid_t to read
+ * @flags: some %FwupdGuidFlags, e.g. %FWUPD_GUID_FLAG_MIXED_ENDIAN
+ * @buf: (out caller-allocates): a buffer of at least %FWUPD_GUID_STRING_SIZE bytes
+ *
+ * Writes a NUL-terminated text GUID of mixed or BE endian for a packed buffer
+ * without allocating any memory.
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_guid_to_buf (const fwupd_guid_t *guid, FwupdGuidFlags flags, gchar *buf)
 {
-	const gchar *end_ptr = NULL;
-	gint saved_errno = 0;
-	guint64 number;
+	static const gchar hex[] = "0123456789abcdef";
+	const guint8 *order = fwupd_guid_be_order;
+	const guint8 *data = (const guint8 *) guid;
 
-	g_return_val_if_fail (str != NULL, FALSE);
-	g_return_val_if_fail (base >= 2 && base <= 36, FALSE);
-	g_return_val_if_fail (min <= max, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_if_fail (guid != NULL);
+	g_return_if_fail (buf != NULL);
 
-	if (str[0] == '\0') {
-		g_set_error_literal (error,
-				     G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
-				     "Empty string is not a number");
-		return FALSE;
+	/* mixed is bizaar, but specified as the DCE encoding */
+	if (flags & FWUPD_GUID_FLAG_MIXED_ENDIAN)
+		order = fwupd_guid_mixed_order;
+	for (guint i = 0; i < 16; i++) {
+		guint8 tmp = data[order[i]];
+		buf[fwupd_guid_str_offsets[i] + 0] = hex[tmp >> 4];
+		buf[fwupd_guid_str_offsets[i] + 1] = hex[tmp & 0x0f];
 	}
+	buf[8] = '-';
+	buf[13] = '-';
+	buf[18] = '-';
+	buf[23] = '-';
+	buf[36] = '\0';
+}
 
-	errno = 0;
-	number = g_ascii_strtoull (str, (gchar **)&end_ptr, base);
-	saved_errno = errno;
-
-	if (g_ascii_isspace (str[0]) || str_has_sign (str) ||
-	    (base == 16 && str_has_hex_prefix (str)) ||
-	    (saved_errno != 0 && saved_errno != ERANGE) ||
-	    end_ptr == NULL ||
-	    *end_ptr != '\0') {
-		g_set_error (error,
-			     G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
-			     "“%s” is not an unsigned number", str);
-		return FALSE;
-	}
-	if (saved_errno == ERANGE || number < min || number > max) {
-		g_autofree gchar *min_str = g_strdup_printf ("%" G_GUINT64_FORMAT, min);
-		g_autofree gchar *max_str = g_strdup_printf ("%" G_GUINT64_FORMAT, max);
-		g_set_error (error,
-			     G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
-			     "Number “%s” is out of bounds [%s, %s]",
-			     str, min_str, max_str);
-		return FALSE;
-	}
-	if (out_num != NULL)
-		*out_num = number;
-	return TRUE;
+/**
+ * fwupd_guid_to_string:
+ * @guid: a #fwupd_guid_t to read
+ * @flags: some %FwupdGuidFlags, e.g. %FWUPD_GUID_FLAG_MIXED_ENDIAN
+ *
+ * Returns a text GUID of mixed or BE endian for a packed buffer.
+ *
+ * Returns: A new GUID
+ *
+ * Since: 1.2.5
+ **/
+gchar *
+fwupd_guid_to_string (const fwupd_guid_t *guid, FwupdGuidFlags flags)
+{
+	gchar *buf;
+
+	g_return_val_if_fail (guid != NULL, NULL);
+
+	buf = g_malloc (FWUPD_GUID_STRING_SIZE);
+	fwupd_guid_to_buf (guid, flags, buf);
+	return buf;
 }
-#endif /* GLIB_CHECK_VERSION(2,54,0) */
 
 /**
  * fwupd_guid_from_string:
@@ -704,14 +830,12 @@ fwupd_guid_from_string (const gchar *guidstr,
 			FwupdGuidFlags flags,
 			GError **error)
 {
-	fwupd_guid_native_t gu = { 0x0 };
-	gboolean mixed_endian = flags & FWUPD_GUID_FLAG_MIXED_ENDIAN;
-	guint64 tmp;
-	g_auto(GStrv) split = NULL;
+	const guint8 *order = fwupd_guid_be_order;
+	guint8 tmp[16];
 
 	g_return_val_if_fail (guidstr != NULL, FALSE);
 
-	/* split into sections */
+	/* check the dashes are where they should be */
 	if (strlen (guidstr) != 36) {
 		g_set_error_literal (error,
 				     G_IO_ERROR,
@@ -719,93 +843,83 @@ fwupd_guid_from_string (const gchar *guidstr,
 				     "is not valid format");
 		return FALSE;
 	}
-	split = g_strsplit (guidstr, "-", 5);
-	if (g_strv_length (split) != 5) {
+	if (guidstr[8] != '-' || guidstr[13] != '-' ||
+	    guidstr[18] != '-' || guidstr[23] != '-') {
 		g_set_error_literal (error,
 				     G_IO_ERROR,
 				     G_IO_ERROR_INVALID_DATA,
 				     "is not valid format, no dashes");
 		return FALSE;
 	}
-	if (strlen (split[0]) != 8 && strlen (split[1]) != 4 &&
-	    strlen (split[2]) != 4 && strlen (split[3]) != 4 &&
-	    strlen (split[4]) != 12) {
-		g_set_error_literal (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_INVALID_DATA,
-				     "is not valid format, not GUID");
-		return FALSE;
-	}
 
 	/* parse */
-	if (!g_ascii_string_to_unsigned (split[0], 16, 0, 0xffffffff, &tmp, error))
-		return FALSE;
-	gu.a = mixed_endian ? GUINT32_TO_LE(tmp) : GUINT32_TO_BE(tmp);
-	if (!g_ascii_string_to_unsigned (split[1], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.b = mixed_endian ? GUINT16_TO_LE(tmp) : GUINT16_TO_BE(tmp);
-	if (!g_ascii_string_to_unsigned (split[2], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.c = mixed_endian ? GUINT16_TO_LE(tmp) : GUINT16_TO_BE(tmp);
-	if (!g_ascii_string_to_unsigned (split[3], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.d = GUINT16_TO_BE(tmp);
-	for (guint i = 0; i < 6; i++) {
-		gchar buffer[3] = { 0x0 };
-		memcpy (buffer, split[4] + (i * 2), 2);
-		if (!g_ascii_string_to_unsigned (buffer, 16, 0, 0xff, &tmp, error))
+	if (flags & FWUPD_GUID_FLAG_MIXED_ENDIAN)
+		order = fwupd_guid_mixed_order;
+	for (guint i = 0; i < 16; i++) {
+		guint8 hi = fwupd_guid_hex_lut[(guint8) guidstr[fwupd_guid_str_offsets[i] + 0]];
+		guint8 lo = fwupd_guid_hex_lut[(guint8) guidstr[fwupd_guid_str_offsets[i] + 1]];
+		if (hi == 0 || lo == 0) {
+			g_set_error_literal (error,
+					     G_IO_ERROR,
+					     G_IO_ERROR_INVALID_DATA,
+					     "is not valid format, not GUID");
 			return FALSE;
-		gu.e[i] = tmp;
+		}
+		tmp[order[i]] = (guint8) (((hi - 1) << 4) | (lo - 1));
 	}
 	if (guid != NULL)
-		memcpy (guid, &gu, sizeof(gu));
+		memcpy (guid, tmp, sizeof(tmp));
 
 	/* success */
 	return TRUE;
 }
 
+static GPrivate fwupd_guid_checksum = G_PRIVATE_INIT ((GDestroyNotify) g_checksum_free);
+
 /**
- * fwupd_guid_hash_data:
+ * fwupd_guid_hash_data_to_buf:
  * @data: data to hash
  * @datasz: length of @data
  * @flags: some %FwupdGuidFlags, e.g. %FWUPD_GUID_FLAG_NAMESPACE_MICROSOFT
+ * @buf: (out caller-allocates): a buffer of at least %FWUPD_GUID_STRING_SIZE bytes
  *
- * Returns a GUID for some data. This uses a hash and so even small
- * differences in the @data will produce radically different return values.
- *
- * The implementation is taken from RFC4122, Section 4.1.3; specifically
- * using a type-5 SHA-1 hash.
- *
- * Returns: A new GUID, or %NULL for internal error
+ * Writes a GUID for some data into @buf, in the same way as
+ * fwupd_guid_hash_data() but without allocating memory for each call.
+ * If @datasz is zero then @buf is set to an empty string.
  *
- * Since: 1.2.5
+ * Since: 1.5.0
  **/
-gchar *
-fwupd_guid_hash_data (const guint8 *data, gsize datasz, FwupdGuidFlags flags)
+void
+fwupd_guid_hash_data_to_buf (const guint8 *data, gsize datasz, FwupdGuidFlags flags, gchar *buf)
 {
-	const gchar *namespace_id = FWUPD_GUID_NAMESPACE_DEFAULT;
+	const fwupd_guid_t *uu_namespace = &fwupd_guid_namespace_default;
 	gsize digestlen = 20;
 	guint8 hash[20];
-	fwupd_guid_t uu_namespace;
 	fwupd_guid_t uu_new;
-	g_autoptr(GChecksum) csum = NULL;
+	GChecksum *csum;
 
-	g_return_val_if_fail (namespace_id != NULL, NULL);
-	g_return_val_if_fail (data != NULL, NULL);
-	g_return_val_if_fail (datasz != 0, NULL);
+	/* never leave @buf uninitialized */
+	g_return_if_fail (buf != NULL);
+	buf[0] = '\0';
+	g_return_if_fail (data != NULL);
+	g_return_if_fail (datasz != 0);
 
 	/* old MS GUID */
 	if (flags & FWUPD_GUID_FLAG_NAMESPACE_MICROSOFT)
-		namespace_id = FWUPD_GUID_NAMESPACE_MICROSOFT;
-
-	/* convert the namespace to binary: hardcoded BE, not @flags */
-	if (!fwupd_guid_from_string (namespace_id, &uu_namespace, FWUPD_GUID_FLAG_NONE, NULL))
-		return NULL;
+		uu_namespace = &fwupd_guid_namespace_microsoft;
+
+	/* reuse the context for this thread */
+	csum = g_private_get (&fwupd_guid_checksum);
+	if (csum == NULL) {
+		csum = g_checksum_new (G_CHECKSUM_SHA1);
+		g_private_set (&fwupd_guid_checksum, csum);
+	} else {
+		g_checksum_reset (csum);
+	}
 
 	/* hash the namespace and then the string */
-	csum = g_checksum_new (G_CHECKSUM_SHA1);
-	g_checksum_update (csum, (guchar *) &uu_namespace, sizeof(uu_namespace));
-	g_checksum_update (csum, (guchar *) data, (gssize) datasz);
+	g_checksum_update (csum, (const guchar *) uu_namespace, sizeof(*uu_namespace));
+	g_checksum_update (csum, (const guchar *) data, (gssize) datasz);
 	g_checksum_get_digest (csum, hash, &digestlen);
 
 	/* copy most parts of the hash 1:1 */
@@ -814,7 +928,36 @@ fwupd_guid_hash_data (const guint8 *data, gsize datasz, FwupdGuidFlags flags)
 	/* set specific bits according to Section 4.1.3 */
 	uu_new[6] = (guint8) ((uu_new[6] & 0x0f) | (5 << 4));
 	uu_new[8] = (guint8) ((uu_new[8] & 0x3f) | 0x80);
-	return fwupd_guid_to_string ((const fwupd_guid_t *) &uu_new, flags);
+	fwupd_guid_to_buf ((const fwupd_guid_t *) &uu_new, flags, buf);
+}
+
+/**
+ * fwupd_guid_hash_data:
+ * @data: data to hash
+ * @datasz: length of @data
+ * @flags: some %FwupdGuidFlags, e.g. %FWUPD_GUID_FLAG_NAMESPACE_MICROSOFT
+ *
+ * Returns a GUID for some data. This uses a hash and so even small
+ * differences in the @data will produce radically different return values.
+ *
+ * The implementation is taken from RFC4122, Section 4.1.3; specifically
+ * using a type-5 SHA-1 hash.
+ *
+ * Returns: A new GUID, or %NULL for internal error
+ *
+ * Since: 1.2.5
+ **/
+gchar *
+fwupd_guid_hash_data (const guint8 *data, gsize datasz, FwupdGuidFlags flags)
+{
+	gchar *buf;
+
+	g_return_val_if_fail (data != NULL, NULL);
+	g_return_val_if_fail (datasz != 0, NULL);
+
+	buf = g_malloc (FWUPD_GUID_STRING_SIZE);
+	fwupd_guid_hash_data_to_buf (data, datasz, flags, buf);
+	return buf;
 }
 
 /**
@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <glib.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -15,6 +15,7 @@ G_BEGIN_DECLS
 #define FWUPD_DBUS_INTERFACE		"org.freedesktop.fwupd"
 
 #define FWUPD_DEVICE_ID_ANY		"*"
+#define FWUPD_GUID_STRING_SIZE		37	/* Since: 1.5.0 */
 
 /**
  * FwupdGuidFlags:
@@ -32,6 +33,20 @@ typedef enum {
 	FWUPD_GUID_FLAG_LAST
 } FwupdGuidFlags;
 
+/**
+ * FwupdReportFlags:
+ * @FWUPD_REPORT_FLAG_NONE:			No flags set
+ * @FWUPD_REPORT_FLAG_COMPRESS:			Compress the report using gzip
+ *
+ * The flags to use when writing a report.
+ **/
+typedef enum {
+	FWUPD_REPORT_FLAG_NONE			= 0,		/* Since: 1.5.0 */
+	FWUPD_REPORT_FLAG_COMPRESS		= 1 << 0,	/* Since: 1.5.0 */
+	/*< private >*/
+	FWUPD_REPORT_FLAG_LAST
+} FwupdReportFlags;
+
 /* GObject Introspection does not understand typedefs with sizes */
 #ifndef __GI_SCANNER__
 typedef guint8 fwupd_guid_t[16];
@@ -48,10 +63,18 @@ gchar		*fwupd_build_machine_id			(const gchar 	*salt,
 GHashTable	*fwupd_get_os_release			(GError		**error);
 gchar		*fwupd_build_history_report_json	(GPtrArray	*devices,
 							 GError		**error);
+gboolean	 fwupd_build_history_report_json_to_stream (GPtrArray	*devices,
+							 GOutputStream	*stream,
+							 FwupdReportFlags flags,
+							 GCancellable	*cancellable,
+							 GError		**error);
 gboolean	 fwupd_device_id_is_valid		(const gchar	*device_id);
 #ifndef __GI_SCANNER__
 gchar		*fwupd_guid_to_string			(const fwupd_guid_t *guid,
 							 FwupdGuidFlags	 flags);
+void		 fwupd_guid_to_buf			(const fwupd_guid_t *guid,
+							 FwupdGuidFlags	 flags,
+							 gchar		*buf);
 gboolean	 fwupd_guid_from_string			(const gchar	*guidstr,
 							 fwupd_guid_t	*guid,
 							 FwupdGuidFlags	 flags,
@@ -59,6 +82,9 @@ gboolean	 fwupd_guid_from_string			(const gchar	*guidstr,
 #else
 gchar		*fwupd_guid_to_string			(const guint8	 guid[16],
 							 FwupdGuidFlags	 flags);
+void		 fwupd_guid_to_buf			(const guint8	 guid[16],
+							 FwupdGuidFlags	 flags,
+							 gchar		*buf);
 gboolean	 fwupd_guid_from_string			(const gchar	*guidstr,
 							 guint8		 guid[16],
 							 FwupdGuidFlags	 flags,
@@ -69,5 +95,9 @@ gchar		*fwupd_guid_hash_string			(const gchar	*str);
 gchar		*fwupd_guid_hash_data			(const guint8	*data,
 							 gsize		 datasz,
 							 FwupdGuidFlags	 flags);
+void		 fwupd_guid_hash_data_to_buf		(const guint8	*data,
+							 gsize		 datasz,
+							 FwupdGuidFlags	 flags,
+							 gchar		*buf);
 
 G_END_DECLS
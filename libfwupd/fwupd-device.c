@@ -1456,151 +1456,211 @@ fwupd_device_to_variant (FwupdDevice *device)
 	return fwupd_device_to_variant_full (device, FWUPD_DEVICE_FLAG_NONE);
 }
 
+typedef enum {
+	FWUPD_DEVICE_KEY_RELEASE,
+	FWUPD_DEVICE_KEY_DEVICE_ID,
+	FWUPD_DEVICE_KEY_PARENT_DEVICE_ID,
+	FWUPD_DEVICE_KEY_FLAGS,
+	FWUPD_DEVICE_KEY_CREATED,
+	FWUPD_DEVICE_KEY_MODIFIED,
+	FWUPD_DEVICE_KEY_GUID,
+	FWUPD_DEVICE_KEY_INSTANCE_IDS,
+	FWUPD_DEVICE_KEY_ICON,
+	FWUPD_DEVICE_KEY_NAME,
+	FWUPD_DEVICE_KEY_VENDOR,
+	FWUPD_DEVICE_KEY_VENDOR_ID,
+	FWUPD_DEVICE_KEY_SERIAL,
+	FWUPD_DEVICE_KEY_SUMMARY,
+	FWUPD_DEVICE_KEY_DESCRIPTION,
+	FWUPD_DEVICE_KEY_CHECKSUM,
+	FWUPD_DEVICE_KEY_PLUGIN,
+	FWUPD_DEVICE_KEY_PROTOCOL,
+	FWUPD_DEVICE_KEY_VERSION,
+	FWUPD_DEVICE_KEY_VERSION_LOWEST,
+	FWUPD_DEVICE_KEY_VERSION_BOOTLOADER,
+	FWUPD_DEVICE_KEY_FLASHES_LEFT,
+	FWUPD_DEVICE_KEY_INSTALL_DURATION,
+	FWUPD_DEVICE_KEY_UPDATE_ERROR,
+	FWUPD_DEVICE_KEY_UPDATE_MESSAGE,
+	FWUPD_DEVICE_KEY_UPDATE_STATE,
+	FWUPD_DEVICE_KEY_STATUS,
+	FWUPD_DEVICE_KEY_VERSION_FORMAT,
+	FWUPD_DEVICE_KEY_VERSION_RAW,
+	FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW,
+	FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW,
+} FwupdDeviceKey;
+
+/* sorted on first use */
+static FwupdVariantKey fwupd_device_keys[] = {
+	{ FWUPD_RESULT_KEY_RELEASE,			FWUPD_DEVICE_KEY_RELEASE },
+	{ FWUPD_RESULT_KEY_DEVICE_ID,			FWUPD_DEVICE_KEY_DEVICE_ID },
+	{ FWUPD_RESULT_KEY_PARENT_DEVICE_ID,		FWUPD_DEVICE_KEY_PARENT_DEVICE_ID },
+	{ FWUPD_RESULT_KEY_FLAGS,			FWUPD_DEVICE_KEY_FLAGS },
+	{ FWUPD_RESULT_KEY_CREATED,			FWUPD_DEVICE_KEY_CREATED },
+	{ FWUPD_RESULT_KEY_MODIFIED,			FWUPD_DEVICE_KEY_MODIFIED },
+	{ FWUPD_RESULT_KEY_GUID,			FWUPD_DEVICE_KEY_GUID },
+	{ FWUPD_RESULT_KEY_INSTANCE_IDS,		FWUPD_DEVICE_KEY_INSTANCE_IDS },
+	{ FWUPD_RESULT_KEY_ICON,			FWUPD_DEVICE_KEY_ICON },
+	{ FWUPD_RESULT_KEY_NAME,			FWUPD_DEVICE_KEY_NAME },
+	{ FWUPD_RESULT_KEY_VENDOR,			FWUPD_DEVICE_KEY_VENDOR },
+	{ FWUPD_RESULT_KEY_VENDOR_ID,			FWUPD_DEVICE_KEY_VENDOR_ID },
+	{ FWUPD_RESULT_KEY_SERIAL,			FWUPD_DEVICE_KEY_SERIAL },
+	{ FWUPD_RESULT_KEY_SUMMARY,			FWUPD_DEVICE_KEY_SUMMARY },
+	{ FWUPD_RESULT_KEY_DESCRIPTION,			FWUPD_DEVICE_KEY_DESCRIPTION },
+	{ FWUPD_RESULT_KEY_CHECKSUM,			FWUPD_DEVICE_KEY_CHECKSUM },
+	{ FWUPD_RESULT_KEY_PLUGIN,			FWUPD_DEVICE_KEY_PLUGIN },
+	{ FWUPD_RESULT_KEY_PROTOCOL,			FWUPD_DEVICE_KEY_PROTOCOL },
+	{ FWUPD_RESULT_KEY_VERSION,			FWUPD_DEVICE_KEY_VERSION },
+	{ FWUPD_RESULT_KEY_VERSION_LOWEST,		FWUPD_DEVICE_KEY_VERSION_LOWEST },
+	{ FWUPD_RESULT_KEY_VERSION_BOOTLOADER,		FWUPD_DEVICE_KEY_VERSION_BOOTLOADER },
+	{ FWUPD_RESULT_KEY_FLASHES_LEFT,		FWUPD_DEVICE_KEY_FLASHES_LEFT },
+	{ FWUPD_RESULT_KEY_INSTALL_DURATION,		FWUPD_DEVICE_KEY_INSTALL_DURATION },
+	{ FWUPD_RESULT_KEY_UPDATE_ERROR,		FWUPD_DEVICE_KEY_UPDATE_ERROR },
+	{ FWUPD_RESULT_KEY_UPDATE_MESSAGE,		FWUPD_DEVICE_KEY_UPDATE_MESSAGE },
+	{ FWUPD_RESULT_KEY_UPDATE_STATE,		FWUPD_DEVICE_KEY_UPDATE_STATE },
+	{ FWUPD_RESULT_KEY_STATUS,			FWUPD_DEVICE_KEY_STATUS },
+	{ FWUPD_RESULT_KEY_VERSION_FORMAT,		FWUPD_DEVICE_KEY_VERSION_FORMAT },
+	{ FWUPD_RESULT_KEY_VERSION_RAW,			FWUPD_DEVICE_KEY_VERSION_RAW },
+	{ FWUPD_RESULT_KEY_VERSION_LOWEST_RAW,		FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW },
+	{ FWUPD_RESULT_KEY_VERSION_BOOTLOADER_RAW,	FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW },
+};
+static gsize fwupd_device_keys_sorted = 0;
+
 static void
-fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *value)
+fwupd_device_add_releases_from_variant (FwupdDevice *device, GVariant *value)
 {
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_RELEASE) == 0) {
-		GVariantIter iter;
-		GVariant *child;
-		g_variant_iter_init (&iter, value);
-		while ((child = g_variant_iter_next_value (&iter))) {
-			g_autoptr(FwupdRelease) release = fwupd_release_from_variant (child);
-			if (release != NULL)
-				fwupd_device_add_release (device, release);
-			g_variant_unref (child);
-		}
-		return;
+	GVariantIter iter;
+	GVariant *child;
+	g_variant_iter_init (&iter, value);
+	while ((child = g_variant_iter_next_value (&iter))) {
+		g_autoptr(FwupdRelease) release = fwupd_release_from_variant (child);
+		if (release != NULL)
+			fwupd_device_add_release (device, release);
+		g_variant_unref (child);
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DEVICE_ID) == 0) {
+}
+
+static void
+fwupd_device_add_checksums_from_variant (FwupdDevice *device, GVariant *value)
+{
+	const gchar *checksums = g_variant_get_string (value, NULL);
+	g_auto(GStrv) split = g_strsplit (checksums, ",", -1);
+	for (guint i = 0; split[i] != NULL; i++)
+		fwupd_device_add_checksum (device, split[i]);
+}
+
+static void
+fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *value)
+{
+	GVariantIter iter;
+	const gchar *tmp;
+	FwupdDeviceKey id = fwupd_variant_key_lookup (fwupd_device_keys,
+						      G_N_ELEMENTS (fwupd_device_keys),
+						      &fwupd_device_keys_sorted,
+						      key);
+
+	switch (id) {
+	case FWUPD_DEVICE_KEY_RELEASE:
+		fwupd_device_add_releases_from_variant (device, value);
+		break;
+	case FWUPD_DEVICE_KEY_DEVICE_ID:
 		fwupd_device_set_id (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PARENT_DEVICE_ID) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_PARENT_DEVICE_ID:
 		fwupd_device_set_parent_id (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_FLAGS) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_FLAGS:
 		fwupd_device_set_flags (device, g_variant_get_uint64 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CREATED) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_CREATED:
 		fwupd_device_set_created (device, g_variant_get_uint64 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_MODIFIED) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_MODIFIED:
 		fwupd_device_set_modified (device, g_variant_get_uint64 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_GUID) == 0) {
-		g_autofree const gchar **guids = g_variant_get_strv (value, NULL);
-		for (guint i = 0; guids != NULL && guids[i] != NULL; i++)
-			fwupd_device_add_guid (device, guids[i]);
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_INSTANCE_IDS) == 0) {
-		g_autofree const gchar **instance_ids = g_variant_get_strv (value, NULL);
-		for (guint i = 0; instance_ids != NULL && instance_ids[i] != NULL; i++)
-			fwupd_device_add_instance_id (device, instance_ids[i]);
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_ICON) == 0) {
-		g_autofree const gchar **icons = g_variant_get_strv (value, NULL);
-		for (guint i = 0; icons != NULL && icons[i] != NULL; i++)
-			fwupd_device_add_icon (device, icons[i]);
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_NAME) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_GUID:
+		g_variant_iter_init (&iter, value);
+		while (g_variant_iter_next (&iter, "&s", &tmp))
+			fwupd_device_add_guid (device, tmp);
+		break;
+	case FWUPD_DEVICE_KEY_INSTANCE_IDS:
+		g_variant_iter_init (&iter, value);
+		while (g_variant_iter_next (&iter, "&s", &tmp))
+			fwupd_device_add_instance_id (device, tmp);
+		break;
+	case FWUPD_DEVICE_KEY_ICON:
+		g_variant_iter_init (&iter, value);
+		while (g_variant_iter_next (&iter, "&s", &tmp))
+			fwupd_device_add_icon (device, tmp);
+		break;
+	case FWUPD_DEVICE_KEY_NAME:
 		fwupd_device_set_name (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VENDOR) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VENDOR:
 		fwupd_device_set_vendor (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VENDOR_ID) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VENDOR_ID:
 		fwupd_device_set_vendor_id (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SERIAL) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_SERIAL:
 		fwupd_device_set_serial (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SUMMARY) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_SUMMARY:
 		fwupd_device_set_summary (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DESCRIPTION) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_DESCRIPTION:
 		fwupd_device_set_description (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CHECKSUM) == 0) {
-		const gchar *checksums = g_variant_get_string (value, NULL);
-		if (checksums != NULL) {
-			g_auto(GStrv) split = g_strsplit (checksums, ",", -1);
-			for (guint i = 0; split[i] != NULL; i++)
-				fwupd_device_add_checksum (device, split[i]);
-		}
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PLUGIN) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_CHECKSUM:
+		fwupd_device_add_checksums_from_variant (device, value);
+		break;
+	case FWUPD_DEVICE_KEY_PLUGIN:
 		fwupd_device_set_plugin (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PROTOCOL) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_PROTOCOL:
 		fwupd_device_set_protocol (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION:
 		fwupd_device_set_version (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_LOWEST) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_LOWEST:
 		fwupd_device_set_version_lowest (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_BOOTLOADER) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_BOOTLOADER:
 		fwupd_device_set_version_bootloader (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_FLASHES_LEFT) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_FLASHES_LEFT:
 		fwupd_device_set_flashes_left (device, g_variant_get_uint32 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_INSTALL_DURATION) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_INSTALL_DURATION:
 		fwupd_device_set_install_duration (device, g_variant_get_uint32 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_ERROR) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_UPDATE_ERROR:
 		fwupd_device_set_update_error (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_MESSAGE) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_UPDATE_MESSAGE:
 		fwupd_device_set_update_message (device, g_variant_get_string (value, NULL));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_STATE) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_UPDATE_STATE:
 		fwupd_device_set_update_state (device, g_variant_get_uint32 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_STATUS) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_STATUS:
 		fwupd_device_set_status (device, g_variant_get_uint32 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_FORMAT) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_FORMAT:
 		fwupd_device_set_version_format (device, g_variant_get_uint32 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_RAW) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_RAW:
 		fwupd_device_set_version_raw (device, g_variant_get_uint64 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_LOWEST_RAW) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW:
 		fwupd_device_set_version_lowest_raw (device, g_variant_get_uint64 (value));
-		return;
-	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_BOOTLOADER_RAW) == 0) {
+		break;
+	case FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW:
 		fwupd_device_set_version_bootloader_raw (device, g_variant_get_uint64 (value));
-		return;
+		break;
+	default:
+		break;
 	}
 }
 
@@ -310,10 +310,13 @@ fwupd_device_func (void)
 	gboolean ret;
 	g_autofree gchar *data = NULL;
 	g_autofree gchar *str = NULL;
+	g_autofree gchar *str2 = NULL;
 	g_autoptr(FwupdDevice) dev = NULL;
+	g_autoptr(FwupdDevice) dev2 = NULL;
 	g_autoptr(FwupdRelease) rel = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GString) str_ascii = NULL;
+	g_autoptr(GVariant) variant = NULL;
 	g_autoptr(JsonBuilder) builder = NULL;
 	g_autoptr(JsonGenerator) json_generator = NULL;
 	g_autoptr(JsonNode) json_root = NULL;
@@ -427,6 +430,56 @@ fwupd_device_func (void)
 		"}", &error);
 	g_assert_no_error (error);
 	g_assert (ret);
+
+	/* round-trip through a variant */
+	variant = fwupd_device_to_variant (dev);
+	dev2 = fwupd_device_from_variant (variant);
+	str2 = fwupd_device_to_string (dev2);
+	g_assert_cmpstr (str2, ==, str);
+}
+
+static void
+fwupd_device_benchmark_func (void)
+{
+	GVariantBuilder builder;
+	const guint iterations = 100;
+	g_autoptr(GTimer) timer = NULL;
+	g_autoptr(GVariant) value = NULL;
+
+	/* simulate a GetDevices reply with 1,000 devices */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+	for (guint i = 0; i < 1000; i++) {
+		g_autofree gchar *id = g_strdup_printf ("%040u", i);
+		g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+		g_autoptr(FwupdRelease) rel = fwupd_release_new ();
+		fwupd_device_set_id (dev, id);
+		fwupd_device_set_name (dev, "ColorHug2");
+		fwupd_device_set_vendor (dev, "Hughski Limited");
+		fwupd_device_set_version (dev, "1.2.3");
+		fwupd_device_set_plugin (dev, "colorhug");
+		fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+		fwupd_device_add_instance_id (dev, "USB\\VID_273F&PID_1004");
+		fwupd_device_add_icon (dev, "input-gaming");
+		fwupd_device_add_checksum (dev, "beefdead");
+		fwupd_device_add_flag (dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+		fwupd_release_set_appstream_id (rel, "org.dave.ColorHug.firmware");
+		fwupd_release_set_version (rel, "1.2.4");
+		fwupd_release_set_description (rel, "<p>Hi there!</p>");
+		fwupd_release_add_checksum (rel, "deadbeef");
+		fwupd_release_set_size (rel, 1024);
+		fwupd_device_add_release (dev, rel);
+		g_variant_builder_add_value (&builder, fwupd_device_to_variant (dev));
+	}
+	value = g_variant_ref_sink (g_variant_new ("(aa{sv})", &builder));
+
+	/* decode */
+	timer = g_timer_new ();
+	for (guint i = 0; i < iterations; i++) {
+		g_autoptr(GPtrArray) devices = fwupd_device_array_from_variant (value);
+		g_assert_cmpint (devices->len, ==, 1000);
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL) / iterations,
+				 "decoded 1000 devices");
 }
 
 static void
@@ -480,6 +533,299 @@ fwupd_client_devices_func (void)
 	g_assert_cmpstr (fwupd_device_get_id (dev), !=, NULL);
 }
 
+/* a minimal daemon that only implements GetDevices, run in its own thread */
+typedef struct {
+	GTestDBus	*bus;
+	gchar		*system_bus_address;	/* (nullable), restored on free */
+	GDBusConnection	*connection;
+	GMainContext	*context;
+	GMainLoop	*loop;
+	GThread		*thread;
+	GMutex		 mutex;
+	GCond		 cond;
+	gboolean	 ready;
+	gint		 get_devices_cnt;
+} FwupdTestDaemon;
+
+static FwupdDevice *
+fwupd_test_daemon_device_new (guint idx)
+{
+	FwupdDevice *dev = fwupd_device_new ();
+	g_autofree gchar *id = g_strdup_printf ("%040u", idx);
+	fwupd_device_set_id (dev, id);
+	fwupd_device_set_name (dev, "ColorHug2");
+	fwupd_device_set_version (dev, "1.2.3");
+	fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	fwupd_device_add_flag (dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+	return dev;
+}
+
+static void
+fwupd_test_daemon_method_call (GDBusConnection *connection,
+			       const gchar *sender,
+			       const gchar *object_path,
+			       const gchar *interface_name,
+			       const gchar *method_name,
+			       GVariant *parameters,
+			       GDBusMethodInvocation *invocation,
+			       gpointer user_data)
+{
+	FwupdTestDaemon *daemon = (FwupdTestDaemon *) user_data;
+	GVariantBuilder builder;
+
+	g_atomic_int_inc (&daemon->get_devices_cnt);
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+	for (guint i = 0; i < 10; i++) {
+		g_autoptr(FwupdDevice) dev = fwupd_test_daemon_device_new (i);
+		g_variant_builder_add_value (&builder, fwupd_device_to_variant (dev));
+	}
+	g_dbus_method_invocation_return_value (invocation,
+					       g_variant_new ("(aa{sv})", &builder));
+}
+
+static gpointer
+fwupd_test_daemon_thread_cb (gpointer user_data)
+{
+	FwupdTestDaemon *daemon = (FwupdTestDaemon *) user_data;
+	guint registration_id;
+	g_autoptr(GDBusNodeInfo) info = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+	static const GDBusInterfaceVTable vtable = {
+		fwupd_test_daemon_method_call, NULL, NULL
+	};
+
+	g_main_context_push_thread_default (daemon->context);
+	daemon->connection = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (daemon->bus),
+								     G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+								     G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+								     NULL, NULL, &error);
+	g_assert_no_error (error);
+	info = g_dbus_node_info_new_for_xml ("<node>"
+					     "<interface name='" FWUPD_DBUS_INTERFACE "'>"
+					     "<method name='GetDevices'>"
+					     "<arg type='aa{sv}' name='devices' direction='out'/>"
+					     "</method>"
+					     "</interface>"
+					     "</node>", &error);
+	g_assert_no_error (error);
+	registration_id = g_dbus_connection_register_object (daemon->connection,
+							     FWUPD_DBUS_PATH,
+							     info->interfaces[0],
+							     &vtable,
+							     daemon, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (registration_id, >, 0);
+	val = g_dbus_connection_call_sync (daemon->connection,
+					   "org.freedesktop.DBus",
+					   "/org/freedesktop/DBus",
+					   "org.freedesktop.DBus",
+					   "RequestName",
+					   g_variant_new ("(su)", FWUPD_DBUS_SERVICE, 0x4),
+					   NULL, G_DBUS_CALL_FLAGS_NONE, -1,
+					   NULL, &error);
+	g_assert_no_error (error);
+
+	/* let the client start */
+	g_mutex_lock (&daemon->mutex);
+	daemon->ready = TRUE;
+	g_cond_signal (&daemon->cond);
+	g_mutex_unlock (&daemon->mutex);
+
+	g_main_loop_run (daemon->loop);
+	g_dbus_connection_unregister_object (daemon->connection, registration_id);
+	g_main_context_pop_thread_default (daemon->context);
+	return NULL;
+}
+
+/* starts a private bus in place of the system bus, and a daemon on it */
+static FwupdTestDaemon *
+fwupd_test_daemon_new (void)
+{
+	FwupdTestDaemon *daemon = g_new0 (FwupdTestDaemon, 1);
+	daemon->bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+	g_test_dbus_up (daemon->bus);
+	daemon->system_bus_address = g_strdup (g_getenv ("DBUS_SYSTEM_BUS_ADDRESS"));
+	g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address (daemon->bus), TRUE);
+	daemon->context = g_main_context_new ();
+	daemon->loop = g_main_loop_new (daemon->context, FALSE);
+	g_mutex_init (&daemon->mutex);
+	g_cond_init (&daemon->cond);
+	daemon->thread = g_thread_new ("fwupd-test-daemon",
+				       fwupd_test_daemon_thread_cb, daemon);
+	g_mutex_lock (&daemon->mutex);
+	while (!daemon->ready)
+		g_cond_wait (&daemon->cond, &daemon->mutex);
+	g_mutex_unlock (&daemon->mutex);
+	return daemon;
+}
+
+static void
+fwupd_test_daemon_emit (FwupdTestDaemon *daemon, const gchar *signal_name, FwupdDevice *dev)
+{
+	GVariant *val = fwupd_device_to_variant (dev);
+	g_autoptr(GError) error = NULL;
+	g_dbus_connection_emit_signal (daemon->connection,
+				       NULL,
+				       FWUPD_DBUS_PATH,
+				       FWUPD_DBUS_INTERFACE,
+				       signal_name,
+				       g_variant_new_tuple (&val, 1),
+				       &error);
+	g_assert_no_error (error);
+}
+
+static void
+fwupd_test_daemon_free (FwupdTestDaemon *daemon)
+{
+	g_main_loop_quit (daemon->loop);
+	g_thread_join (daemon->thread);
+	g_object_unref (daemon->connection);
+	g_main_loop_unref (daemon->loop);
+	g_main_context_unref (daemon->context);
+	g_mutex_clear (&daemon->mutex);
+	g_cond_clear (&daemon->cond);
+	g_test_dbus_down (daemon->bus);
+	g_object_unref (daemon->bus);
+	if (daemon->system_bus_address != NULL)
+		g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", daemon->system_bus_address, TRUE);
+	else
+		g_unsetenv ("DBUS_SYSTEM_BUS_ADDRESS");
+	g_free (daemon->system_bus_address);
+	g_free (daemon);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdTestDaemon, fwupd_test_daemon_free)
+#pragma clang diagnostic pop
+
+static void
+fwupd_client_device_changed_cb (FwupdClient *client, FwupdDevice *dev, GMainLoop *loop)
+{
+	g_main_loop_quit (loop);
+}
+
+static void
+fwupd_client_cache_func (void)
+{
+	g_autoptr(FwupdClient) client = NULL;
+	g_autoptr(FwupdDevice) dev_changed = fwupd_test_daemon_device_new (3);
+	g_autoptr(FwupdDevice) dev_removed = fwupd_test_daemon_device_new (5);
+	g_autoptr(FwupdTestDaemon) daemon = fwupd_test_daemon_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+	g_autoptr(GPtrArray) devices1 = NULL;
+	g_autoptr(GPtrArray) devices2 = NULL;
+	g_autoptr(GPtrArray) devices3 = NULL;
+
+	/* only the first call goes to the daemon */
+	client = fwupd_client_new ();
+	fwupd_client_set_cache_enabled (client, TRUE);
+	g_signal_connect (client, "device-changed",
+			  G_CALLBACK (fwupd_client_device_changed_cb), loop);
+	g_signal_connect (client, "device-removed",
+			  G_CALLBACK (fwupd_client_device_changed_cb), loop);
+	devices1 = fwupd_client_get_devices (client, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices1);
+	g_assert_cmpint (devices1->len, ==, 10);
+	devices2 = fwupd_client_get_devices (client, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices2);
+	g_assert_cmpint (devices2->len, ==, 10);
+	g_assert_cmpint (g_atomic_int_get (&daemon->get_devices_cnt), ==, 1);
+
+	/* apply the signals */
+	fwupd_device_set_version (dev_changed, "4.5.6");
+	fwupd_test_daemon_emit (daemon, "DeviceChanged", dev_changed);
+	g_main_loop_run (loop);
+	fwupd_test_daemon_emit (daemon, "DeviceRemoved", dev_removed);
+	g_main_loop_run (loop);
+	devices3 = fwupd_client_get_devices (client, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices3);
+	g_assert_cmpint (devices3->len, ==, 9);
+	g_assert_cmpstr (fwupd_device_get_version (g_ptr_array_index (devices3, 3)), ==, "4.5.6");
+	g_assert_cmpint (g_atomic_int_get (&daemon->get_devices_cnt), ==, 1);
+
+	/* disabling the cache goes back to the daemon */
+	fwupd_client_set_cache_enabled (client, FALSE);
+	g_clear_pointer (&devices3, g_ptr_array_unref);
+	devices3 = fwupd_client_get_devices (client, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices3);
+	g_assert_cmpint (g_atomic_int_get (&daemon->get_devices_cnt), ==, 2);
+
+	/* the client has to be destroyed before the bus */
+	g_clear_object (&client);
+}
+
+typedef struct {
+	guint		 pending;
+	GMainLoop	*loop;
+} FwupdBenchmarkHelper;
+
+static void
+fwupd_client_benchmark_get_devices_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdBenchmarkHelper *helper = (FwupdBenchmarkHelper *) user_data;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	devices = fwupd_client_get_devices_finish (FWUPD_CLIENT (source), res, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (devices->len, ==, 10);
+	if (--helper->pending == 0)
+		g_main_loop_quit (helper->loop);
+}
+
+static void
+fwupd_client_benchmark_func (void)
+{
+	FwupdBenchmarkHelper helper = { 0 };
+	const guint iterations = 2000;
+	gdouble elapsed_sync;
+	gdouble elapsed_async;
+	g_autoptr(FwupdClient) client = NULL;
+	g_autoptr(FwupdTestDaemon) daemon = fwupd_test_daemon_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* one request at a time */
+	client = fwupd_client_new ();
+	g_assert_true (fwupd_client_connect (client, NULL, &error));
+	g_assert_no_error (error);
+	g_timer_reset (timer);
+	for (guint i = 0; i < iterations; i++) {
+		g_autoptr(GPtrArray) devices = fwupd_client_get_devices (client, NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (devices->len, ==, 10);
+	}
+	elapsed_sync = g_timer_elapsed (timer, NULL);
+
+	/* all requests in flight at once */
+	helper.loop = g_main_loop_new (NULL, FALSE);
+	helper.pending = iterations;
+	g_timer_reset (timer);
+	for (guint i = 0; i < iterations; i++) {
+		fwupd_client_get_devices_async (client, NULL,
+						fwupd_client_benchmark_get_devices_cb,
+						&helper);
+	}
+	g_main_loop_run (helper.loop);
+	elapsed_async = g_timer_elapsed (timer, NULL);
+	g_main_loop_unref (helper.loop);
+
+	g_test_message ("sync: %.0f calls/s, pipelined: %.0f calls/s",
+			iterations / elapsed_sync, iterations / elapsed_async);
+	g_test_maximized_result (iterations / elapsed_async,
+				 "pipelined GetDevices calls per second");
+
+	/* the client has to be destroyed before the bus */
+	g_clear_object (&client);
+}
+
 static void
 fwupd_client_remotes_func (void)
 {
@@ -552,6 +898,17 @@ fwupd_has_system_bus (void)
 	return FALSE;
 }
 
+/* GTestDBus needs to spawn a private bus */
+static gboolean
+fwupd_has_dbus_daemon (void)
+{
+	g_autofree gchar *fn = g_find_program_in_path ("dbus-daemon");
+	if (fn != NULL)
+		return TRUE;
+	g_debug ("dbus-daemon unavailable, skipping tests.");
+	return FALSE;
+}
+
 static void
 fwupd_common_machine_hash_func (void)
 {
@@ -605,6 +962,7 @@ fwupd_common_guid_func (void)
 	g_autofree gchar *guid_be = NULL;
 	g_autofree gchar *guid_me = NULL;
 	fwupd_guid_t buf = { 0x0 };
+	gchar strbuf[FWUPD_GUID_STRING_SIZE] = { '\0' };
 	gboolean ret;
 	g_autoptr(GError) error = NULL;
 
@@ -647,6 +1005,154 @@ fwupd_common_guid_func (void)
 	/* check failure */
 	g_assert_false (fwupd_guid_from_string ("001122334455-6677-8899-aabbccddeeff", NULL, 0, NULL));
 	g_assert_false (fwupd_guid_from_string ("0112233-4455-6677-8899-aabbccddeeff", NULL, 0, NULL));
+	g_assert_false (fwupd_guid_from_string ("0011223-34455-6677-8899-aabbccddeeff", NULL, 0, NULL));
+	g_assert_false (fwupd_guid_from_string ("00112233-4455-6677-8899-aabbccddeefg", NULL, 0, NULL));
+
+	/* upper case is allowed when parsing */
+	ret = fwupd_guid_from_string ("00112233-4455-6677-8899-AABBCCDDEEFF", &buf,
+				      FWUPD_GUID_FLAG_NONE, &error);
+	g_assert_true (ret);
+	g_assert_no_error (error);
+	fwupd_guid_to_buf ((const fwupd_guid_t *) &buf, FWUPD_GUID_FLAG_NONE, strbuf);
+	g_assert_cmpstr (strbuf, ==, "00112233-4455-6677-8899-aabbccddeeff");
+
+	/* hash into a buffer */
+	fwupd_guid_hash_data_to_buf ((const guint8 *) "python.org", 10,
+				     FWUPD_GUID_FLAG_NONE, strbuf);
+	g_assert_cmpstr (strbuf, ==, "886313e1-3b8a-5372-9b90-0c9aee199e5d");
+}
+
+static gchar *
+fwupd_common_history_report_normalize (const gchar *data, gsize datasz)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JsonGenerator) json_generator = json_generator_new ();
+	g_autoptr(JsonParser) json_parser = json_parser_new ();
+	g_assert_true (json_parser_load_from_data (json_parser, data, (gssize) datasz, &error));
+	g_assert_no_error (error);
+	json_generator_set_root (json_generator, json_parser_get_root (json_parser));
+	return json_generator_to_data (json_generator, NULL);
+}
+
+static void
+fwupd_common_history_report_func (void)
+{
+	gsize bufsz = 0;
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *str1 = NULL;
+	g_autofree gchar *str2 = NULL;
+	g_autofree gchar *str3 = NULL;
+	g_autoptr(GConverter) decompressor = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) istream = NULL;
+	g_autoptr(GInputStream) istream_gz = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(GOutputStream) ostream_gz = NULL;
+	g_autoptr(GOutputStream) ostream_out = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+	if (!g_file_get_contents ("/etc/machine-id", &buf, &bufsz, NULL) || bufsz == 0) {
+		g_test_skip ("Missing /etc/machine-id");
+		return;
+	}
+	if (!g_file_test ("/etc/os-release", G_FILE_TEST_EXISTS) &&
+	    !g_file_test ("/usr/lib/os-release", G_FILE_TEST_EXISTS)) {
+		g_test_skip ("Missing os-release");
+		return;
+	}
+
+	/* two failed updates */
+	for (guint i = 0; i < 2; i++) {
+		g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+		g_autoptr(FwupdRelease) rel = fwupd_release_new ();
+		fwupd_device_set_plugin (dev, "colorhug");
+		fwupd_device_set_version (dev, "1.2.3");
+		fwupd_device_set_update_state (dev, FWUPD_UPDATE_STATE_FAILED);
+		fwupd_device_set_update_error (dev, "device \"exploded\"");
+		fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+		fwupd_release_set_version (rel, "1.2.4");
+		fwupd_release_add_checksum (rel, "7c211433f02071597741e6ff5a8ea34789abbf43");
+		fwupd_release_add_metadata_item (rel, "DistroId", "fedora");
+		fwupd_device_add_release (dev, rel);
+		g_ptr_array_add (devices, g_steal_pointer (&dev));
+	}
+
+	/* in memory */
+	data = fwupd_build_history_report_json (devices, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data);
+	str1 = fwupd_common_history_report_normalize (data, strlen (data));
+
+	/* streamed */
+	ostream = g_memory_output_stream_new_resizable ();
+	g_assert_true (fwupd_build_history_report_json_to_stream (devices, ostream,
+								  FWUPD_REPORT_FLAG_NONE,
+								  NULL, &error));
+	g_assert_no_error (error);
+	str2 = fwupd_common_history_report_normalize (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+						      g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)));
+	g_assert_cmpstr (str2, ==, str1);
+
+	/* streamed and compressed */
+	ostream_gz = g_memory_output_stream_new_resizable ();
+	g_assert_true (fwupd_build_history_report_json_to_stream (devices, ostream_gz,
+								  FWUPD_REPORT_FLAG_COMPRESS,
+								  NULL, &error));
+	g_assert_no_error (error);
+	g_assert_true (g_output_stream_close (ostream_gz, NULL, &error));
+	decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+	istream = g_memory_input_stream_new_from_data (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream_gz)),
+						       (gssize) g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream_gz)),
+						       NULL);
+	istream_gz = g_converter_input_stream_new (istream, decompressor);
+	ostream_out = g_memory_output_stream_new_resizable ();
+	g_assert_cmpint (g_output_stream_splice (ostream_out, istream_gz,
+						 G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+						 G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+						 NULL, &error), >, 0);
+	g_assert_no_error (error);
+	str3 = fwupd_common_history_report_normalize (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream_out)),
+						      g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream_out)));
+	g_assert_cmpstr (str3, ==, str1);
+}
+
+static void
+fwupd_common_guid_benchmark_func (void)
+{
+	const guint iterations = 1000000;
+	fwupd_guid_t buf = { 0x0 };
+	gchar strbuf[FWUPD_GUID_STRING_SIZE] = { '\0' };
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* parse */
+	for (guint i = 0; i < iterations; i++) {
+		if (!fwupd_guid_from_string ("1ff60ab2-3905-06a1-b476-0371f00c9e9b",
+					     &buf, FWUPD_GUID_FLAG_NONE, NULL))
+			g_assert_not_reached ();
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "parsed %u GUIDs", iterations);
+
+	/* format */
+	g_timer_reset (timer);
+	for (guint i = 0; i < iterations; i++) {
+		buf[15] = (guint8) i;
+		fwupd_guid_to_buf ((const fwupd_guid_t *) &buf, FWUPD_GUID_FLAG_MIXED_ENDIAN, strbuf);
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "formatted %u GUIDs", iterations);
+
+	/* hash */
+	g_timer_reset (timer);
+	for (guint i = 0; i < iterations; i++) {
+		gchar instance_id[32];
+		g_snprintf (instance_id, sizeof(instance_id), "USB\\VID_273F&PID_%04X", i);
+		fwupd_guid_hash_data_to_buf ((const guint8 *) instance_id, strlen (instance_id),
+					     FWUPD_GUID_FLAG_NONE, strbuf);
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "hashed %u GUIDs", iterations);
 }
 
 int
@@ -663,8 +1169,13 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{machine-hash}", fwupd_common_machine_hash_func);
 	g_test_add_func ("/fwupd/common{device-id}", fwupd_common_device_id_func);
 	g_test_add_func ("/fwupd/common{guid}", fwupd_common_guid_func);
+	g_test_add_func ("/fwupd/common{history-report}", fwupd_common_history_report_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/common{guid-benchmark}", fwupd_common_guid_benchmark_func);
 	g_test_add_func ("/fwupd/release", fwupd_release_func);
 	g_test_add_func ("/fwupd/device", fwupd_device_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/device{benchmark}", fwupd_device_benchmark_func);
 	g_test_add_func ("/fwupd/remote{download}", fwupd_remote_download_func);
 	g_test_add_func ("/fwupd/remote{base-uri}", fwupd_remote_baseuri_func);
 	g_test_add_func ("/fwupd/remote{no-path}", fwupd_remote_nopath_func);
@@ -673,5 +1184,10 @@ main (int argc, char **argv)
 		g_test_add_func ("/fwupd/client{remotes}", fwupd_client_remotes_func);
 		g_test_add_func ("/fwupd/client{devices}", fwupd_client_devices_func);
 	}
+	if (fwupd_has_dbus_daemon ()) {
+		g_test_add_func ("/fwupd/client{cache}", fwupd_client_cache_func);
+		if (g_test_perf ())
+			g_test_add_func ("/fwupd/client{benchmark}", fwupd_client_benchmark_func);
+	}
 	return g_test_run ();
 }
@@ -13,6 +13,7 @@
 
 #include "fu-cabinet.h"
 #include "fu-common.h"
+#include "fu-common-delta.h"
 
 #include "fwupd-enums.h"
 #include "fwupd-error.h"
@@ -117,7 +118,7 @@ fu_cabinet_get_silo (FuCabinet *self)
 }
 
 static GCabFile *
-fu_cabinet_get_file_by_name (FuCabinet *self, const gchar *basename)
+fu_cabinet_get_cabfile_by_name (FuCabinet *self, const gchar *basename)
 {
 	GPtrArray *folders = gcab_cabinet_get_folders (self->gcab_cabinet);
 	for (guint i = 0; i < folders->len; i++) {
@@ -129,18 +130,126 @@ fu_cabinet_get_file_by_name (FuCabinet *self, const gchar *basename)
 	return NULL;
 }
 
-/* sets the firmware and signature blobs on XbNode */
+static gboolean
+fu_cabinet_extract_file_cb (GCabFile *file, gpointer user_data)
+{
+	return file == GCAB_FILE (user_data);
+}
+
+/* decompresses just one file, which is then kept by the GCabFile */
+static GBytes *
+fu_cabinet_extract_file (GCabCabinet *gcab_cabinet, GCabFile *cabfile, GError **error)
+{
+	GBytes *blob;
+	g_autoptr(GError) error_local = NULL;
+
+	/* already done */
+	blob = gcab_file_get_bytes (cabfile);
+	if (blob != NULL)
+		return blob;
+
+	g_debug ("decompressing %s", gcab_file_get_extract_name (cabfile));
+	if (!gcab_cabinet_extract_simple (gcab_cabinet, NULL,
+					  fu_cabinet_extract_file_cb, cabfile,
+					  NULL, &error_local)) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     error_local->message);
+		return NULL;
+	}
+	blob = gcab_file_get_bytes (cabfile);
+	if (blob == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "no GBytes from GCabFile %s",
+			     gcab_file_get_extract_name (cabfile));
+		return NULL;
+	}
+	return blob;
+}
+
+/**
+ * fu_cabinet_get_file_by_name:
+ * @self: A #FuCabinet
+ * @basename: A filename in the archive, e.g. `firmware.bin`
+ * @error: A #GError, or %NULL
+ *
+ * Gets the contents of a file in the parsed archive. Only the metadata is
+ * decompressed by fu_cabinet_parse() and other files are decompressed the
+ * first time they are requested.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ *
+ * Since: 1.5.0
+ **/
+GBytes *
+fu_cabinet_get_file_by_name (FuCabinet *self, const gchar *basename, GError **error)
+{
+	GBytes *blob;
+	GCabFile *cabfile;
+
+	g_return_val_if_fail (FU_IS_CABINET (self), NULL);
+	g_return_val_if_fail (basename != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	cabfile = fu_cabinet_get_cabfile_by_name (self, basename);
+	if (cabfile == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "cannot find %s in archive",
+			     basename);
+		return NULL;
+	}
+	blob = fu_cabinet_extract_file (self->gcab_cabinet, cabfile, error);
+	if (blob == NULL)
+		return NULL;
+	return g_bytes_ref (blob);
+}
+
+/* what is needed to decompress and verify the payload of a release later;
+ * this does not reference the FuCabinet as the silo outlives it */
+typedef struct {
+	GCabCabinet		*gcab_cabinet;
+	GCabFile		*cabfile;
+	GCabFile		*cabfile_sig;
+	JcatContext		*jcat_context;
+	JcatItem		*jcat_item;
+	gchar			*checksum;
+	gboolean		 is_delta;
+	FwupdReleaseFlags	 release_flags;
+} FuCabinetPayload;
+
+static void
+fu_cabinet_payload_free (FuCabinetPayload *payload)
+{
+	g_object_unref (payload->gcab_cabinet);
+	g_object_unref (payload->cabfile);
+	if (payload->cabfile_sig != NULL)
+		g_object_unref (payload->cabfile_sig);
+	g_object_unref (payload->jcat_context);
+	if (payload->jcat_item != NULL)
+		g_object_unref (payload->jcat_item);
+	g_free (payload->checksum);
+	g_free (payload);
+}
+
+/* finds the payload and sets the size, the blobs are set by
+ * fu_cabinet_load_release() when the release is actually used */
 static gboolean
 fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 {
+	FuCabinetPayload *payload;
 	GCabFile *cabfile;
-	GBytes *blob;
+	gboolean is_delta = FALSE;
+	gsize blob_size = 0;
 	const gchar *csum_filename = NULL;
 	g_autofree gchar *basename = NULL;
 	g_autoptr(XbNode) csum_tmp = NULL;
 	g_autoptr(XbNode) metadata_trust = NULL;
 	g_autoptr(XbNode) nsize = NULL;
-	g_autoptr(JcatItem) item = NULL;
 	g_autoptr(GBytes) release_flags_blob = NULL;
 	FwupdReleaseFlags release_flags = FWUPD_RELEASE_FLAG_NONE;
 
@@ -159,70 +268,148 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 	if (csum_filename == NULL)
 		csum_filename = "firmware.bin";
 
-	/* get the main firmware file */
+	/* get the main firmware file, falling back to a delta against the
+	 * installed image that is reconstructed by the engine */
 	basename = g_path_get_basename (csum_filename);
-	cabfile = fu_cabinet_get_file_by_name (self, basename);
+	cabfile = fu_cabinet_get_cabfile_by_name (self, basename);
 	if (cabfile == NULL) {
-		g_set_error (error,
-			     FWUPD_ERROR,
-			     FWUPD_ERROR_INVALID_FILE,
-			     "cannot find %s in archive",
-			     basename);
-		return FALSE;
-	}
-	blob = gcab_file_get_bytes (cabfile);
-	if (blob == NULL) {
-		g_set_error_literal (error,
+		g_autofree gchar *basename_delta = g_strdup_printf ("%s.delta", basename);
+		cabfile = fu_cabinet_get_cabfile_by_name (self, basename_delta);
+		if (cabfile == NULL) {
+			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "no GBytes from GCabFile firmware");
-		return FALSE;
+				     "cannot find %s in archive",
+				     basename);
+			return FALSE;
+		}
+		is_delta = TRUE;
+		g_free (basename);
+		basename = g_steal_pointer (&basename_delta);
 	}
 
-	/* set the blob */
-	xb_node_set_data (release, "fwupd::FirmwareBlob", blob);
+	/* the size of a delta is only known from the header */
+	if (is_delta) {
+		GBytes *blob = fu_cabinet_extract_file (self->gcab_cabinet, cabfile, error);
+		if (blob == NULL)
+			return FALSE;
+		if (!fu_common_delta_parse_header (blob, NULL, NULL, &blob_size, error)) {
+			g_prefix_error (error, "failed to parse %s: ", basename);
+			return FALSE;
+		}
+	} else {
+		blob_size = gcab_file_get_size (cabfile);
+	}
 
 	/* set as metadata if unset, but error if specified and incorrect */
 	nsize = xb_node_query_first (release, "size[@type='installed']", NULL);
 	if (nsize != NULL) {
 		guint64 size = fu_common_strtoull (xb_node_get_text (nsize));
-		if (size != g_bytes_get_size (blob)) {
+		if (size != blob_size) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "contents size invalid, expected "
 				     "%" G_GSIZE_FORMAT ", got %" G_GUINT64_FORMAT,
-				     g_bytes_get_size (blob), size);
+				     blob_size, size);
 			return FALSE;
 		}
 	} else {
-		guint64 size = g_bytes_get_size (blob);
+		guint64 size = blob_size;
 		g_autoptr(GBytes) blob_sz = g_bytes_new (&size, sizeof(guint64));
 		xb_node_set_data (release, "fwupd::ReleaseSize", blob_sz);
 	}
 
-	/* set if unspecified, but error out if specified and incorrect */
-	if (csum_tmp != NULL && xb_node_get_text (csum_tmp) != NULL) {
+	/* find out if the payload is signed, falling back to detached */
+	payload = g_new0 (FuCabinetPayload, 1);
+	payload->gcab_cabinet = g_object_ref (self->gcab_cabinet);
+	payload->cabfile = g_object_ref (cabfile);
+	payload->jcat_context = g_object_ref (self->jcat_context);
+	payload->jcat_item = jcat_file_get_item_by_id (self->jcat_file, basename, NULL);
+	if (payload->jcat_item == NULL) {
+		g_autofree gchar *basename_sig = g_strdup_printf ("%s.asc", basename);
+		GCabFile *cabfile_sig = fu_cabinet_get_cabfile_by_name (self, basename_sig);
+		if (cabfile_sig != NULL)
+			payload->cabfile_sig = g_object_ref (cabfile_sig);
+	}
+
+	/* for deltas this is checked by the engine after reconstruction */
+	if (!is_delta && csum_tmp != NULL)
+		payload->checksum = g_strdup (xb_node_get_text (csum_tmp));
+	payload->is_delta = is_delta;
+	payload->release_flags = release_flags;
+	g_object_set_data_full (G_OBJECT (release), "fwupd::CabinetPayload",
+				payload, (GDestroyNotify) fu_cabinet_payload_free);
+
+	/* the payload trust is added when the release is loaded */
+	release_flags_blob = g_bytes_new (&release_flags, sizeof(release_flags));
+	xb_node_set_data (release, "fwupd::ReleaseFlags", release_flags_blob);
+
+	/* success */
+	return TRUE;
+}
+
+/**
+ * fu_cabinet_load_release: (skip):
+ * @release: A #XbNode of a release from the silo of a #FuCabinet
+ * @error: A #GError, or %NULL
+ *
+ * Decompresses and verifies the firmware payload of the release, setting the
+ * `fwupd::FirmwareBlob` or `fwupd::FirmwareDelta` data and adding the payload
+ * trust to `fwupd::ReleaseFlags`.
+ *
+ * Releases that have already been loaded, or that were not created by a
+ * #FuCabinet, are ignored.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fu_cabinet_load_release (XbNode *release, GError **error)
+{
+	FuCabinetPayload *payload;
+	GBytes *blob;
+	const gchar *basename;
+	FwupdReleaseFlags release_flags;
+	g_autoptr(GBytes) release_flags_blob = NULL;
+
+	g_return_val_if_fail (XB_IS_NODE (release), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* nothing to do */
+	payload = g_object_get_data (G_OBJECT (release), "fwupd::CabinetPayload");
+	if (payload == NULL)
+		return TRUE;
+
+	/* only this file is decompressed */
+	basename = gcab_file_get_extract_name (payload->cabfile);
+	blob = fu_cabinet_extract_file (payload->gcab_cabinet, payload->cabfile, error);
+	if (blob == NULL)
+		return FALSE;
+
+	/* error out if specified and incorrect */
+	if (payload->checksum != NULL) {
 		g_autofree gchar *checksum = NULL;
 		checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, blob);
-		if (g_strcmp0 (checksum, xb_node_get_text (csum_tmp)) != 0) {
+		if (g_strcmp0 (checksum, payload->checksum) != 0) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "contents checksum invalid, expected %s, got %s",
 				     checksum,
-				     xb_node_get_text (csum_tmp));
+				     payload->checksum);
 			return FALSE;
 		}
 	}
 
-	/* find out if the payload is signed, falling back to detached */
-	item = jcat_file_get_item_by_id (self->jcat_file, basename, NULL);
-	if (item != NULL) {
+	/* verify the signature */
+	release_flags = payload->release_flags;
+	if (payload->jcat_item != NULL) {
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) results = NULL;
-		results = jcat_context_verify_item (self->jcat_context,
-						    blob, item,
+		results = jcat_context_verify_item (payload->jcat_context,
+						    blob, payload->jcat_item,
 						    JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
 						    JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
 						    &error_local);
@@ -236,45 +423,43 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 		}
 
 	/* legacy GPG detached signature */
-	} else {
-		g_autofree gchar *basename_sig = NULL;
-		basename_sig = g_strdup_printf ("%s.asc", basename);
-		cabfile = fu_cabinet_get_file_by_name (self, basename_sig);
-		if (cabfile != NULL) {
-			GBytes *data_sig;
-			g_autoptr(JcatResult) jcat_result = NULL;
-			g_autoptr(JcatBlob) jcat_blob = NULL;
-			g_autoptr(GError) error_local = NULL;
-
-			data_sig = gcab_file_get_bytes (cabfile);
-			if (data_sig == NULL) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "no GBytes from GCabFile %s",
-					     basename_sig);
-				return FALSE;
-			}
-			jcat_blob = jcat_blob_new (JCAT_BLOB_KIND_GPG, data_sig);
-			jcat_result = jcat_context_verify_blob (self->jcat_context,
-								blob, jcat_blob,
-								JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-								&error_local);
-			if (jcat_result == NULL) {
-				g_debug ("failed to verify payload %s using detached: %s",
-					 basename, error_local->message);
-			} else {
-				g_debug ("verified payload %s using detached", basename);
-				release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
-			}
+	} else if (payload->cabfile_sig != NULL) {
+		GBytes *data_sig;
+		g_autoptr(JcatResult) jcat_result = NULL;
+		g_autoptr(JcatBlob) jcat_blob = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		data_sig = fu_cabinet_extract_file (payload->gcab_cabinet,
+						    payload->cabfile_sig,
+						    error);
+		if (data_sig == NULL)
+			return FALSE;
+		jcat_blob = jcat_blob_new (JCAT_BLOB_KIND_GPG, data_sig);
+		jcat_result = jcat_context_verify_blob (payload->jcat_context,
+							blob, jcat_blob,
+							JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+							&error_local);
+		if (jcat_result == NULL) {
+			g_debug ("failed to verify payload %s using detached: %s",
+				 basename, error_local->message);
+		} else {
+			g_debug ("verified payload %s using detached", basename);
+			release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
 		}
 	}
 
+	/* set the blob */
+	if (payload->is_delta)
+		xb_node_set_data (release, "fwupd::FirmwareDelta", blob);
+	else
+		xb_node_set_data (release, "fwupd::FirmwareBlob", blob);
+
 	/* this means we can get the data from fu_keyring_get_release_flags */
 	release_flags_blob = g_bytes_new (&release_flags, sizeof(release_flags));
 	xb_node_set_data (release, "fwupd::ReleaseFlags", release_flags_blob);
 
-	/* success */
+	/* only verify once */
+	g_object_set_data (G_OBJECT (release), "fwupd::CabinetPayload", NULL);
 	return TRUE;
 }
 
@@ -584,7 +769,10 @@ fu_cabinet_decompress_file_cb (GCabFile *file, gpointer user_data)
 	/* ignore the dirname completely */
 	basename = g_path_get_basename (name);
 	gcab_file_set_extract_name (file, basename);
-	return TRUE;
+
+	/* payloads are decompressed when required */
+	return g_str_has_suffix (basename, ".metainfo.xml") ||
+	       g_str_has_suffix (basename, ".jcat");
 }
 
 static gboolean
@@ -615,7 +803,7 @@ fu_cabinet_decompress (FuCabinet *self, GBytes *data, GError **error)
 		return FALSE;
 	}
 
-	/* decompress the file to memory */
+	/* decompress the metadata to memory */
 	if (!gcab_cabinet_extract_simple (self->gcab_cabinet, NULL,
 					  fu_cabinet_decompress_file_cb, &helper,
 					  NULL, &error_local)) {
@@ -643,7 +831,8 @@ fu_cabinet_decompress (FuCabinet *self, GBytes *data, GError **error)
  * @flags: A #FuCabinetParseFlags, e.g. %FU_CABINET_PARSE_FLAG_NONE
  * @error: A #GError, or %NULL
  *
- * Parses the cabinet archive.
+ * Parses the cabinet archive. Only the metadata is decompressed, and the
+ * payload of each release is decompressed by fu_cabinet_load_release().
  *
  * Returns: %TRUE for success
  *
@@ -36,3 +36,8 @@ gboolean	 fu_cabinet_parse		(FuCabinet		*self,
 						 FuCabinetParseFlags	 flags,
 						 GError			**error);
 XbSilo		*fu_cabinet_get_silo		(FuCabinet		*self);
+GBytes		*fu_cabinet_get_file_by_name	(FuCabinet		*self,
+						 const gchar		*basename,
+						 GError			**error);
+gboolean	 fu_cabinet_load_release	(XbNode			*release,
+						 GError			**error);
@@ -103,6 +103,83 @@ fu_chunk_array_to_string (GPtrArray *chunks)
 	return g_string_free (str, FALSE);
 }
 
+/**
+ * fu_chunk_iter_init: (skip):
+ * @iter: an uninitialized #FuChunkIter
+ * @data: a linear blob of memory, or %NULL
+ * @data_sz: size of @data_sz
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Initializes an iterator that returns the same packets as fu_chunk_array_new()
+ * one at a time, without allocating any memory.
+ *
+ * Since: 1.5.0
+ **/
+void
+fu_chunk_iter_init (FuChunkIter *iter,
+		    const guint8 *data,
+		    guint32 data_sz,
+		    guint32 addr_start,
+		    guint32 page_sz,
+		    guint32 packet_sz)
+{
+	g_return_if_fail (iter != NULL);
+	iter->data = data;
+	iter->data_sz = data_sz;
+	iter->addr_start = addr_start;
+	iter->page_sz = page_sz;
+	iter->packet_sz = packet_sz;
+	iter->offset = 0;
+	iter->idx = 0;
+}
+
+/**
+ * fu_chunk_iter_next: (skip):
+ * @iter: a #FuChunkIter
+ * @chk: (out caller-allocates): a #FuChunk to populate
+ *
+ * Gets the next packet, where each packet does not cross a page boundary and
+ * is no larger than the transfer size.
+ *
+ * Return value: %FALSE if there are no more packets
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fu_chunk_iter_next (FuChunkIter *iter, FuChunk *chk)
+{
+	guint32 address;
+	guint32 chunk_sz;
+	guint32 page = 0;
+
+	g_return_val_if_fail (iter != NULL, FALSE);
+	g_return_val_if_fail (chk != NULL, FALSE);
+
+	if (iter->offset >= iter->data_sz)
+		return FALSE;
+
+	/* limit to the end of the page, then to the transfer size */
+	address = iter->addr_start + iter->offset;
+	chunk_sz = iter->data_sz - iter->offset;
+	if (iter->page_sz > 0) {
+		page = address / iter->page_sz;
+		address %= iter->page_sz;
+		chunk_sz = MIN (chunk_sz, iter->page_sz - address);
+	}
+	if (iter->packet_sz > 0)
+		chunk_sz = MIN (chunk_sz, iter->packet_sz);
+
+	chk->idx = iter->idx++;
+	chk->page = page;
+	chk->address = address;
+	chk->data = iter->data != NULL ? iter->data + iter->offset : NULL;
+	chk->data_sz = chunk_sz;
+	iter->offset += chunk_sz;
+	return TRUE;
+}
+
 /**
  * fu_chunk_array_new: (skip):
  * @data: a linear blob of memory, or %NULL
@@ -125,65 +202,20 @@ fu_chunk_array_new (const guint8 *data,
 		    guint32 page_sz,
 		    guint32 packet_sz)
 {
+	FuChunk chk;
+	FuChunkIter iter;
 	GPtrArray *segments = NULL;
-	guint32 page_old = G_MAXUINT32;
-	guint32 idx;
-	guint32 last_flush = 0;
 
 	g_return_val_if_fail (data_sz > 0, NULL);
 
 	segments = g_ptr_array_new_with_free_func (g_free);
-	for (idx = 1; idx < data_sz; idx++) {
-		guint32 page = 0;
-		if (page_sz > 0)
-			page = (addr_start + idx) / page_sz;
-		if (page_old == G_MAXUINT32) {
-			page_old = page;
-		} else if (page != page_old) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page_old,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			page_old = page;
-			continue;
-		}
-		if (packet_sz > 0 && idx - last_flush >= packet_sz) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			continue;
-		}
-	}
-	if (last_flush != idx) {
-		const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-		guint32 address_offset = addr_start + last_flush;
-		guint32 page = 0;
-		if (page_sz > 0) {
-			address_offset %= page_sz;
-			page = (addr_start + (idx - 1)) / page_sz;
-		}
-		g_ptr_array_add (segments,
-				 fu_chunk_new (segments->len,
-					       page,
-					       address_offset,
-					       data_offset,
-					       data_sz - last_flush));
-	}
+	fu_chunk_iter_init (&iter, data, data_sz, addr_start, page_sz, packet_sz);
+	while (fu_chunk_iter_next (&iter, &chk))
+		g_ptr_array_add (segments, fu_chunk_new (chk.idx,
+							 chk.page,
+							 chk.address,
+							 chk.data,
+							 chk.data_sz));
 	return segments;
 }
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuCommon"
+
+#include <config.h>
+
+#include "fu-common-checksum.h"
+
+/* data is fed to each digest in blocks that stay in the CPU cache */
+#define FU_COMMON_CHECKSUM_CHUNK_SIZE		0x10000
+
+/* smaller blobs are not worth starting a thread for */
+#define FU_COMMON_CHECKSUM_THREAD_MIN		0x400000
+
+#define FU_COMMON_CHECKSUM_TREE_LEAF_SIZE	0x100000
+#define FU_COMMON_CHECKSUM_TREE_THREADS_MAX	16
+
+typedef struct {
+	GChecksum	*csum;
+	GChecksumType	 kind;
+	const guint8	*buf;
+	gsize		 bufsz;
+	guint8		*digests;
+	gsize		 digest_len;
+	guint		 idx;
+	guint		 stride;
+} FuCommonChecksumHelper;
+
+static void
+fu_common_checksum_update (GChecksum *csum, const guint8 *buf, gsize bufsz)
+{
+	for (gsize offset = 0; offset < bufsz; offset += FU_COMMON_CHECKSUM_CHUNK_SIZE) {
+		gsize chunksz = MIN (bufsz - offset, FU_COMMON_CHECKSUM_CHUNK_SIZE);
+		g_checksum_update (csum, buf + offset, (gssize) chunksz);
+	}
+}
+
+static gpointer
+fu_common_checksum_thread_cb (gpointer user_data)
+{
+	FuCommonChecksumHelper *helper = (FuCommonChecksumHelper *) user_data;
+	fu_common_checksum_update (helper->csum, helper->buf, helper->bufsz);
+	return NULL;
+}
+
+/**
+ * fu_common_checksums_for_bytes:
+ * @blob: A #GBytes
+ * @kinds: (array length=kinds_len): checksum types, e.g. %G_CHECKSUM_SHA1
+ * @kinds_len: number of @kinds
+ *
+ * Computes several digests of the same data. Small blobs are read once with
+ * each block fed to every digest in turn, and large blobs are hashed by one
+ * thread for each checksum type.
+ *
+ * Returns: (transfer container) (element-type utf8): hex checksums, in the
+ * same order as @kinds
+ *
+ * Since: 1.5.0
+ **/
+GPtrArray *
+fu_common_checksums_for_bytes (GBytes *blob, const GChecksumType *kinds, guint kinds_len)
+{
+	const guint8 *buf;
+	gsize bufsz = 0;
+	GPtrArray *checksums;
+	g_autoptr(GPtrArray) csums = NULL;
+
+	g_return_val_if_fail (blob != NULL, NULL);
+	g_return_val_if_fail (kinds != NULL || kinds_len == 0, NULL);
+
+	buf = g_bytes_get_data (blob, &bufsz);
+	checksums = g_ptr_array_new_with_free_func (g_free);
+	csums = g_ptr_array_new_with_free_func ((GDestroyNotify) g_checksum_free);
+	for (guint i = 0; i < kinds_len; i++)
+		g_ptr_array_add (csums, g_checksum_new (kinds[i]));
+
+	if (kinds_len > 1 && bufsz >= FU_COMMON_CHECKSUM_THREAD_MIN) {
+		g_autofree FuCommonChecksumHelper *helpers = NULL;
+		g_autofree GThread **threads = NULL;
+
+		/* the first digest is computed on this thread */
+		helpers = g_new0 (FuCommonChecksumHelper, kinds_len);
+		threads = g_new0 (GThread *, kinds_len);
+		for (guint i = 0; i < kinds_len; i++) {
+			helpers[i].csum = g_ptr_array_index (csums, i);
+			helpers[i].buf = buf;
+			helpers[i].bufsz = bufsz;
+			if (i == 0)
+				continue;
+			threads[i] = g_thread_try_new ("fu-checksum",
+						       fu_common_checksum_thread_cb,
+						       &helpers[i], NULL);
+			if (threads[i] == NULL)
+				fu_common_checksum_thread_cb (&helpers[i]);
+		}
+		fu_common_checksum_thread_cb (&helpers[0]);
+		for (guint i = 1; i < kinds_len; i++) {
+			if (threads[i] != NULL)
+				g_thread_join (threads[i]);
+		}
+	} else {
+		for (gsize offset = 0; offset < bufsz; offset += FU_COMMON_CHECKSUM_CHUNK_SIZE) {
+			gsize chunksz = MIN (bufsz - offset, FU_COMMON_CHECKSUM_CHUNK_SIZE);
+			for (guint i = 0; i < csums->len; i++) {
+				GChecksum *csum = g_ptr_array_index (csums, i);
+				g_checksum_update (csum, buf + offset, (gssize) chunksz);
+			}
+		}
+	}
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index (csums, i);
+		g_ptr_array_add (checksums, g_strdup (g_checksum_get_string (csum)));
+	}
+	return checksums;
+}
+
+static gpointer
+fu_common_checksum_tree_thread_cb (gpointer user_data)
+{
+	FuCommonChecksumHelper *helper = (FuCommonChecksumHelper *) user_data;
+	guint leaves = MAX (1, (helper->bufsz + FU_COMMON_CHECKSUM_TREE_LEAF_SIZE - 1) /
+				FU_COMMON_CHECKSUM_TREE_LEAF_SIZE);
+	for (guint i = helper->idx; i < leaves; i += helper->stride) {
+		gsize offset = (gsize) i * FU_COMMON_CHECKSUM_TREE_LEAF_SIZE;
+		gsize digest_len = helper->digest_len;
+		g_autoptr(GChecksum) csum = g_checksum_new (helper->kind);
+		fu_common_checksum_update (csum,
+					   helper->buf + offset,
+					   MIN (helper->bufsz - offset,
+						FU_COMMON_CHECKSUM_TREE_LEAF_SIZE));
+		g_checksum_get_digest (csum,
+				       helper->digests + (i * helper->digest_len),
+				       &digest_len);
+	}
+	return NULL;
+}
+
+/**
+ * fu_common_checksum_tree_for_bytes:
+ * @blob: A #GBytes
+ * @kind: A checksum type, e.g. %G_CHECKSUM_SHA256
+ *
+ * Computes a two level hash tree of the data, where each 1MiB leaf is hashed
+ * in parallel and the root is the digest of the leaf digests and the size.
+ *
+ * The result is NOT the same as g_compute_checksum_for_bytes() and must only
+ * be used to identify data in local caches, never compared with checksums
+ * from metadata.
+ *
+ * Returns: a hex checksum, or %NULL for an invalid @kind
+ *
+ * Since: 1.5.0
+ **/
+gchar *
+fu_common_checksum_tree_for_bytes (GBytes *blob, GChecksumType kind)
+{
+	const guint8 *buf;
+	gssize digest_len = g_checksum_type_get_length (kind);
+	gsize bufsz = 0;
+	guint leaves;
+	guint nthreads;
+	guint64 bufsz_le;
+	g_autofree FuCommonChecksumHelper *helpers = NULL;
+	g_autofree GThread **threads = NULL;
+	g_autofree guint8 *digests = NULL;
+	g_autoptr(GChecksum) csum = NULL;
+
+	g_return_val_if_fail (blob != NULL, NULL);
+	g_return_val_if_fail (digest_len > 0, NULL);
+
+	/* hash each leaf */
+	buf = g_bytes_get_data (blob, &bufsz);
+	leaves = MAX (1, (bufsz + FU_COMMON_CHECKSUM_TREE_LEAF_SIZE - 1) /
+			 FU_COMMON_CHECKSUM_TREE_LEAF_SIZE);
+	nthreads = MIN ((guint) g_get_num_processors (), leaves);
+	nthreads = CLAMP (nthreads, 1, FU_COMMON_CHECKSUM_TREE_THREADS_MAX);
+	digests = g_malloc0 ((gsize) leaves * (gsize) digest_len);
+	helpers = g_new0 (FuCommonChecksumHelper, nthreads);
+	threads = g_new0 (GThread *, nthreads);
+	for (guint i = 0; i < nthreads; i++) {
+		helpers[i].kind = kind;
+		helpers[i].buf = buf;
+		helpers[i].bufsz = bufsz;
+		helpers[i].digests = digests;
+		helpers[i].digest_len = (gsize) digest_len;
+		helpers[i].idx = i;
+		helpers[i].stride = nthreads;
+		if (i == 0)
+			continue;
+		threads[i] = g_thread_try_new ("fu-checksum",
+					       fu_common_checksum_tree_thread_cb,
+					       &helpers[i], NULL);
+		if (threads[i] == NULL)
+			fu_common_checksum_tree_thread_cb (&helpers[i]);
+	}
+	fu_common_checksum_tree_thread_cb (&helpers[0]);
+	for (guint i = 1; i < nthreads; i++) {
+		if (threads[i] != NULL)
+			g_thread_join (threads[i]);
+	}
+
+	/* root */
+	csum = g_checksum_new (kind);
+	g_checksum_update (csum, digests, (gssize) leaves * digest_len);
+	bufsz_le = GUINT64_TO_LE ((guint64) bufsz);
+	g_checksum_update (csum, (const guchar *) &bufsz_le, sizeof(bufsz_le));
+	return g_strdup (g_checksum_get_string (csum));
+}
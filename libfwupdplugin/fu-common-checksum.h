@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib.h>
+
+GPtrArray	*fu_common_checksums_for_bytes	(GBytes		*blob,
+						 const GChecksumType *kinds,
+						 guint		 kinds_len);
+gchar		*fu_common_checksum_tree_for_bytes (GBytes	*blob,
+						 GChecksumType	 kind);
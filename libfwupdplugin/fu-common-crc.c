@@ -0,0 +1,559 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuCommon"
+
+#include <config.h>
+
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define FU_CRC_HAVE_PCLMUL
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define FU_CRC_HAVE_ARMV8
+#endif
+
+#include "fu-common-crc.h"
+
+typedef struct {
+	const gchar	*id;
+	guint		 width;
+	guint32		 poly;
+	guint32		 init;
+	gboolean	 refin;
+	gboolean	 refout;
+	guint32		 xorout;
+} FuCrcParams;
+
+/* see https://reveng.sourceforge.io/crc-catalogue/ for the definitions */
+static const FuCrcParams crc_params[FU_CRC_KIND_LAST] = {
+	[FU_CRC_KIND_UNKNOWN] =		{ "unknown",		32, 0x00000000, 0x00000000, TRUE,  TRUE,  0x00000000 },
+	[FU_CRC_KIND_B32_STANDARD] =	{ "b32-standard",	32, 0x04c11db7, 0xffffffff, TRUE,  TRUE,  0xffffffff },
+	[FU_CRC_KIND_B32_JAMCRC] =	{ "b32-jamcrc",		32, 0x04c11db7, 0xffffffff, TRUE,  TRUE,  0x00000000 },
+	[FU_CRC_KIND_B32_MPEG2] =	{ "b32-mpeg2",		32, 0x04c11db7, 0xffffffff, FALSE, FALSE, 0x00000000 },
+	[FU_CRC_KIND_B16_USB] =		{ "b16-usb",		16, 0x8005,     0xffff,     TRUE,  TRUE,  0xffff },
+	[FU_CRC_KIND_B16_UMTS] =	{ "b16-umts",		16, 0x8005,     0x0000,     FALSE, FALSE, 0x0000 },
+	[FU_CRC_KIND_B8_SMBUS] =	{ "b8-smbus",		8,  0x07,       0x00,       FALSE, FALSE, 0x00 },
+	[FU_CRC_KIND_B8_DVB_S2] =	{ "b8-dvb-s2",		8,  0xd5,       0x00,       FALSE, FALSE, 0x00 },
+	[FU_CRC_KIND_B8_WACOM] =	{ "b8-wacom",		8,  0x31,       0x00,       FALSE, TRUE,  0x00 },
+};
+
+/* the polynomial the hardware instructions and slice-by-8 tables are for */
+#define FU_CRC_POLY_IEEE			0x04c11db7
+
+/* the lookup tables are built on first use; the reflected IEEE kinds get
+ * eight tables so the input can be processed eight bytes at a time */
+static gsize crc_tables[FU_CRC_KIND_LAST] = { 0 };
+
+/**
+ * fu_common_crc_kind_to_string:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B32_STANDARD
+ *
+ * Converts an enumerated CRC kind to a string.
+ *
+ * Returns: identifier string, or %NULL
+ *
+ * Since: 1.5.0
+ **/
+const gchar *
+fu_common_crc_kind_to_string (FuCrcKind kind)
+{
+	if (kind <= FU_CRC_KIND_UNKNOWN || kind >= FU_CRC_KIND_LAST)
+		return NULL;
+	return crc_params[kind].id;
+}
+
+static guint32
+fu_common_crc_reflect (guint32 value, guint width)
+{
+	guint32 tmp = 0;
+	for (guint i = 0; i < width; i++) {
+		if (value & (1u << i))
+			tmp |= 1u << (width - 1 - i);
+	}
+	return tmp;
+}
+
+static guint32
+fu_common_crc_mask (const FuCrcParams *params)
+{
+	return params->width == 32 ? 0xffffffff : (1u << params->width) - 1;
+}
+
+static gboolean
+fu_common_crc_is_reflected_ieee (const FuCrcParams *params)
+{
+	return params->refin && params->width == 32 && params->poly == FU_CRC_POLY_IEEE;
+}
+
+static const guint32 *
+fu_common_crc_get_table (FuCrcKind kind)
+{
+	const FuCrcParams *params = &crc_params[kind];
+
+	if (g_once_init_enter (&crc_tables[kind])) {
+		guint32 *tbl;
+		guint32 mask = fu_common_crc_mask (params);
+		guint ntbls = fu_common_crc_is_reflected_ieee (params) ? 8 : 1;
+
+		tbl = g_new0 (guint32, 256 * ntbls);
+		if (params->refin) {
+			guint32 poly = fu_common_crc_reflect (params->poly, params->width);
+			for (guint32 i = 0; i < 256; i++) {
+				guint32 crc = i;
+				for (guint j = 0; j < 8; j++)
+					crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+				tbl[i] = crc;
+			}
+		} else {
+			guint32 topbit = 1u << (params->width - 1);
+			for (guint32 i = 0; i < 256; i++) {
+				guint32 crc = i << (params->width - 8);
+				for (guint j = 0; j < 8; j++)
+					crc = (crc & topbit) ? (crc << 1) ^ params->poly : crc << 1;
+				tbl[i] = crc & mask;
+			}
+		}
+
+		/* table k is the CRC of a byte followed by k zero bytes */
+		for (guint k = 1; k < ntbls; k++) {
+			for (guint i = 0; i < 256; i++) {
+				guint32 tmp = tbl[(k - 1) * 256 + i];
+				tbl[k * 256 + i] = (tmp >> 8) ^ tbl[tmp & 0xff];
+			}
+		}
+		g_once_init_leave (&crc_tables[kind], (gsize) tbl);
+	}
+	return (const guint32 *) crc_tables[kind];
+}
+
+#ifdef FU_CRC_HAVE_PCLMUL
+/* fold 16 byte blocks using carry-less multiplication, see "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Intel;
+ * @bufsz has to be at least 64 and a multiple of 16 */
+__attribute__((target("pclmul,sse4.1"))) static guint32
+fu_common_crc32_pclmul (const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+	const __m128i k1k2 = _mm_set_epi64x (0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x (0x00ccaa009e, 0x01751997d0);
+	const __m128i k5k0 = _mm_set_epi64x (0x0000000000, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x (0x01f7011641, 0x01db710641);
+
+	/* there is at least one block of 64 */
+	x1 = _mm_loadu_si128 ((const __m128i *) (buf + 0x00));
+	x2 = _mm_loadu_si128 ((const __m128i *) (buf + 0x10));
+	x3 = _mm_loadu_si128 ((const __m128i *) (buf + 0x20));
+	x4 = _mm_loadu_si128 ((const __m128i *) (buf + 0x30));
+	x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 ((gint) crc));
+	x0 = k1k2;
+	buf += 64;
+	bufsz -= 64;
+
+	/* fold blocks of 64 in parallel */
+	while (bufsz >= 64) {
+		x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128 (x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128 (x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128 (x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128 (x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128 (x4, x0, 0x11);
+		y5 = _mm_loadu_si128 ((const __m128i *) (buf + 0x00));
+		y6 = _mm_loadu_si128 ((const __m128i *) (buf + 0x10));
+		y7 = _mm_loadu_si128 ((const __m128i *) (buf + 0x20));
+		y8 = _mm_loadu_si128 ((const __m128i *) (buf + 0x30));
+		x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5), y5);
+		x2 = _mm_xor_si128 (_mm_xor_si128 (x2, x6), y6);
+		x3 = _mm_xor_si128 (_mm_xor_si128 (x3, x7), y7);
+		x4 = _mm_xor_si128 (_mm_xor_si128 (x4, x8), y8);
+		buf += 64;
+		bufsz -= 64;
+	}
+
+	/* fold into 128 bits */
+	x0 = k3k4;
+	x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+	x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x3), x5);
+	x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+	x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x4), x5);
+
+	/* fold any remaining blocks of 16 */
+	while (bufsz >= 16) {
+		x2 = _mm_loadu_si128 ((const __m128i *) buf);
+		x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+		x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+		buf += 16;
+		bufsz -= 16;
+	}
+
+	/* fold 128 bits to 64 bits */
+	x2 = _mm_clmulepi64_si128 (x1, x0, 0x10);
+	x3 = _mm_setr_epi32 (~0, 0, ~0, 0);
+	x1 = _mm_srli_si128 (x1, 8);
+	x1 = _mm_xor_si128 (x1, x2);
+	x0 = k5k0;
+	x2 = _mm_srli_si128 (x1, 4);
+	x1 = _mm_and_si128 (x1, x3);
+	x1 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+	x1 = _mm_xor_si128 (x1, x2);
+
+	/* Barrett reduce to 32 bits */
+	x0 = poly;
+	x2 = _mm_and_si128 (x1, x3);
+	x2 = _mm_clmulepi64_si128 (x2, x0, 0x10);
+	x2 = _mm_and_si128 (x2, x3);
+	x2 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+	x1 = _mm_xor_si128 (x1, x2);
+	return (guint32) _mm_extract_epi32 (x1, 1);
+}
+
+static gboolean
+fu_common_crc32_pclmul_supported (void)
+{
+	static gsize supported = 0;
+	if (g_once_init_enter (&supported)) {
+		gsize tmp = 1;
+		__builtin_cpu_init ();
+		if (__builtin_cpu_supports ("pclmul") &&
+		    __builtin_cpu_supports ("sse4.1"))
+			tmp = 2;
+		g_once_init_leave (&supported, tmp);
+	}
+	return supported == 2;
+}
+#endif
+
+static guint32
+fu_common_crc32_step_reflected (const guint32 *tbl,
+				const guint8 *buf,
+				gsize bufsz,
+				guint32 crc)
+{
+#ifdef FU_CRC_HAVE_PCLMUL
+	if (bufsz >= 64 && fu_common_crc32_pclmul_supported ()) {
+		gsize chunksz = bufsz & ~((gsize) 0xf);
+		crc = fu_common_crc32_pclmul (buf, chunksz, crc);
+		buf += chunksz;
+		bufsz -= chunksz;
+	}
+#endif
+#ifdef FU_CRC_HAVE_ARMV8
+	for (; bufsz >= 8; buf += 8, bufsz -= 8) {
+		guint64 tmp;
+		memcpy (&tmp, buf, sizeof(tmp));
+		crc = __crc32d (crc, GUINT64_FROM_LE (tmp));
+	}
+#endif
+
+	/* slice-by-8 */
+	for (; bufsz >= 8; buf += 8, bufsz -= 8) {
+		guint32 lo, hi;
+		memcpy (&lo, buf + 0, sizeof(lo));
+		memcpy (&hi, buf + 4, sizeof(hi));
+		lo = GUINT32_FROM_LE (lo) ^ crc;
+		hi = GUINT32_FROM_LE (hi);
+		crc = tbl[7 * 256 + (lo & 0xff)] ^
+		      tbl[6 * 256 + ((lo >> 8) & 0xff)] ^
+		      tbl[5 * 256 + ((lo >> 16) & 0xff)] ^
+		      tbl[4 * 256 + (lo >> 24)] ^
+		      tbl[3 * 256 + (hi & 0xff)] ^
+		      tbl[2 * 256 + ((hi >> 8) & 0xff)] ^
+		      tbl[1 * 256 + ((hi >> 16) & 0xff)] ^
+		      tbl[0 * 256 + (hi >> 24)];
+	}
+	for (gsize i = 0; i < bufsz; i++)
+		crc = tbl[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+static guint32
+fu_common_crc_step (FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	const FuCrcParams *params = &crc_params[kind];
+	const guint32 *tbl = fu_common_crc_get_table (kind);
+
+	if (fu_common_crc_is_reflected_ieee (params))
+		return fu_common_crc32_step_reflected (tbl, buf, bufsz, crc);
+	if (params->refin) {
+		for (gsize i = 0; i < bufsz; i++)
+			crc = tbl[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+	} else {
+		guint32 mask = fu_common_crc_mask (params);
+		guint shift = params->width - 8;
+		for (gsize i = 0; i < bufsz; i++)
+			crc = ((crc << 8) ^ tbl[((crc >> shift) ^ buf[i]) & 0xff]) & mask;
+	}
+	return crc;
+}
+
+static guint32
+fu_common_crc_init (FuCrcKind kind)
+{
+	const FuCrcParams *params = &crc_params[kind];
+	if (params->refin)
+		return fu_common_crc_reflect (params->init, params->width);
+	return params->init;
+}
+
+static guint32
+fu_common_crc_done (FuCrcKind kind, guint32 crc)
+{
+	const FuCrcParams *params = &crc_params[kind];
+	if (params->refin != params->refout)
+		crc = fu_common_crc_reflect (crc, params->width);
+	return (crc ^ params->xorout) & fu_common_crc_mask (params);
+}
+
+/**
+ * fu_common_crc8_init:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B8_SMBUS
+ *
+ * Gets the initial CRC register value for a streaming checksum, which should
+ * be passed to fu_common_crc8_step().
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint8
+fu_common_crc8_init (FuCrcKind kind)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 8, 0x0);
+	return (guint8) fu_common_crc_init (kind);
+}
+
+/**
+ * fu_common_crc8_step:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B8_SMBUS
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ * @crc: the register value from fu_common_crc8_init() or a previous step
+ *
+ * Adds more data to a streaming checksum.
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint8
+fu_common_crc8_step (FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 8, 0x0);
+	return (guint8) fu_common_crc_step (kind, buf, bufsz, crc);
+}
+
+/**
+ * fu_common_crc8_done:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B8_SMBUS
+ * @crc: the register value from fu_common_crc8_step()
+ *
+ * Finishes a streaming checksum.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint8
+fu_common_crc8_done (FuCrcKind kind, guint8 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 8, 0x0);
+	return (guint8) fu_common_crc_done (kind, crc);
+}
+
+/**
+ * fu_common_crc8:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B8_SMBUS
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ *
+ * Returns the 8 bit cyclic redundancy check value for the given memory buffer.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint8
+fu_common_crc8 (FuCrcKind kind, const guint8 *buf, gsize bufsz)
+{
+	guint8 crc = fu_common_crc8_init (kind);
+	crc = fu_common_crc8_step (kind, buf, bufsz, crc);
+	return fu_common_crc8_done (kind, crc);
+}
+
+/**
+ * fu_common_crc16_init:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B16_USB
+ *
+ * Gets the initial CRC register value for a streaming checksum, which should
+ * be passed to fu_common_crc16_step().
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint16
+fu_common_crc16_init (FuCrcKind kind)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 16, 0x0);
+	return (guint16) fu_common_crc_init (kind);
+}
+
+/**
+ * fu_common_crc16_step:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B16_USB
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ * @crc: the register value from fu_common_crc16_init() or a previous step
+ *
+ * Adds more data to a streaming checksum.
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint16
+fu_common_crc16_step (FuCrcKind kind, const guint8 *buf, gsize bufsz, guint16 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 16, 0x0);
+	return (guint16) fu_common_crc_step (kind, buf, bufsz, crc);
+}
+
+/**
+ * fu_common_crc16_done:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B16_USB
+ * @crc: the register value from fu_common_crc16_step()
+ *
+ * Finishes a streaming checksum.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint16
+fu_common_crc16_done (FuCrcKind kind, guint16 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 16, 0x0);
+	return (guint16) fu_common_crc_done (kind, crc);
+}
+
+/**
+ * fu_common_crc16:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B16_USB
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ *
+ * Returns the 16 bit cyclic redundancy check value for the given memory buffer.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint16
+fu_common_crc16 (FuCrcKind kind, const guint8 *buf, gsize bufsz)
+{
+	guint16 crc = fu_common_crc16_init (kind);
+	crc = fu_common_crc16_step (kind, buf, bufsz, crc);
+	return fu_common_crc16_done (kind, crc);
+}
+
+/**
+ * fu_common_crc32_init:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B32_STANDARD
+ *
+ * Gets the initial CRC register value for a streaming checksum, which should
+ * be passed to fu_common_crc32_step().
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint32
+fu_common_crc32_init (FuCrcKind kind)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 32, 0x0);
+	return fu_common_crc_init (kind);
+}
+
+/**
+ * fu_common_crc32_step:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B32_STANDARD
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ * @crc: the register value from fu_common_crc32_init() or a previous step
+ *
+ * Adds more data to a streaming checksum.
+ *
+ * The reflected IEEE polynomial uses PCLMULQDQ on x86_64 or the ARMv8 CRC32
+ * instructions when available, and eight lookup tables otherwise.
+ *
+ * Returns: register value
+ *
+ * Since: 1.5.0
+ **/
+guint32
+fu_common_crc32_step (FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 32, 0x0);
+	return fu_common_crc_step (kind, buf, bufsz, crc);
+}
+
+/**
+ * fu_common_crc32_done:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B32_STANDARD
+ * @crc: the register value from fu_common_crc32_step()
+ *
+ * Finishes a streaming checksum.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint32
+fu_common_crc32_done (FuCrcKind kind, guint32 crc)
+{
+	g_return_val_if_fail (kind > FU_CRC_KIND_UNKNOWN && kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail (crc_params[kind].width == 32, 0x0);
+	return fu_common_crc_done (kind, crc);
+}
+
+/**
+ * fu_common_crc32:
+ * @kind: A #FuCrcKind, e.g. %FU_CRC_KIND_B32_STANDARD
+ * @buf: memory buffer
+ * @bufsz: sizeof buf
+ *
+ * Returns the 32 bit cyclic redundancy check value for the given memory buffer.
+ *
+ * Returns: CRC value
+ *
+ * Since: 1.5.0
+ **/
+guint32
+fu_common_crc32 (FuCrcKind kind, const guint8 *buf, gsize bufsz)
+{
+	guint32 crc = fu_common_crc32_init (kind);
+	crc = fu_common_crc32_step (kind, buf, bufsz, crc);
+	return fu_common_crc32_done (kind, crc);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib.h>
+
+/**
+ * FuCrcKind:
+ * @FU_CRC_KIND_UNKNOWN:		Unknown
+ * @FU_CRC_KIND_B32_STANDARD:		CRC-32, as used by zlib and Ethernet
+ * @FU_CRC_KIND_B32_JAMCRC:		CRC-32 without the final inversion, as used by DFU
+ * @FU_CRC_KIND_B32_MPEG2:		CRC-32/MPEG-2, as used by the STM32 CRC unit
+ * @FU_CRC_KIND_B16_USB:		CRC-16/USB
+ * @FU_CRC_KIND_B16_UMTS:		CRC-16/UMTS, also known as CRC-16/BUYPASS
+ * @FU_CRC_KIND_B8_SMBUS:		CRC-8/SMBUS
+ * @FU_CRC_KIND_B8_DVB_S2:		CRC-8/DVB-S2
+ * @FU_CRC_KIND_B8_WACOM:		CRC-8 with polynomial 0x31 and a reflected result, as used by Wacom
+ *
+ * The CRC algorithm, defined by width, polynomial, initial value,
+ * reflection and final XOR value.
+ **/
+typedef enum {
+	FU_CRC_KIND_UNKNOWN,
+	FU_CRC_KIND_B32_STANDARD,
+	FU_CRC_KIND_B32_JAMCRC,
+	FU_CRC_KIND_B32_MPEG2,
+	FU_CRC_KIND_B16_USB,
+	FU_CRC_KIND_B16_UMTS,
+	FU_CRC_KIND_B8_SMBUS,
+	FU_CRC_KIND_B8_DVB_S2,
+	FU_CRC_KIND_B8_WACOM,
+	/*< private >*/
+	FU_CRC_KIND_LAST
+} FuCrcKind;
+
+const gchar	*fu_common_crc_kind_to_string	(FuCrcKind	 kind);
+
+guint8		 fu_common_crc8			(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz);
+guint8		 fu_common_crc8_init		(FuCrcKind	 kind);
+guint8		 fu_common_crc8_step		(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz,
+						 guint8		 crc);
+guint8		 fu_common_crc8_done		(FuCrcKind	 kind,
+						 guint8		 crc);
+guint16		 fu_common_crc16		(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz);
+guint16		 fu_common_crc16_init		(FuCrcKind	 kind);
+guint16		 fu_common_crc16_step		(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz,
+						 guint16	 crc);
+guint16		 fu_common_crc16_done		(FuCrcKind	 kind,
+						 guint16	 crc);
+guint32		 fu_common_crc32		(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz);
+guint32		 fu_common_crc32_init		(FuCrcKind	 kind);
+guint32		 fu_common_crc32_step		(FuCrcKind	 kind,
+						 const guint8	*buf,
+						 gsize		 bufsz,
+						 guint32	 crc);
+guint32		 fu_common_crc32_done		(FuCrcKind	 kind,
+						 guint32	 crc);
@@ -0,0 +1,429 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuCommon"
+
+#include <config.h>
+
+#include <string.h>
+
+#include "fu-common.h"
+#include "fu-common-delta.h"
+
+#include "fwupd-error.h"
+
+/*
+ * The delta format is a fixed header followed by a list of operations that
+ * build the target image from start to finish:
+ *
+ *   0x00	magic, "FUDELTA1"
+ *   0x08	source size, uint32le
+ *   0x0c	target size, uint32le
+ *   0x10	source SHA-256 digest
+ *   0x30	target SHA-256 digest
+ *   0x50	operations, terminated by END:
+ *		COPY:	0x01, offset uint32le, length uint32le
+ *		DATA:	0x02, length uint32le, data
+ *		END:	0x00
+ */
+#define FU_COMMON_DELTA_MAGIC		"FUDELTA1"
+#define FU_COMMON_DELTA_DIGEST_SIZE	32
+#define FU_COMMON_DELTA_HEADER_SIZE	0x50
+
+#define FU_COMMON_DELTA_OP_END		0x00
+#define FU_COMMON_DELTA_OP_COPY		0x01
+#define FU_COMMON_DELTA_OP_DATA		0x02
+
+/* source blocks are matched at this granularity */
+#define FU_COMMON_DELTA_BLOCK_SIZE	64
+#define FU_COMMON_DELTA_HASH_MULT	0x01000193u
+
+typedef struct {
+	guint32		 hash;
+	guint32		 idx;		/* block index + 1, or 0 for unused */
+} FuCommonDeltaEntry;
+
+static void
+fu_common_delta_checksum (GBytes *blob, guint8 *digest)
+{
+	gsize digestsz = FU_COMMON_DELTA_DIGEST_SIZE;
+	g_autoptr(GChecksum) csum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_checksum_update (csum,
+			   g_bytes_get_data (blob, NULL),
+			   (gssize) g_bytes_get_size (blob));
+	g_checksum_get_digest (csum, digest, &digestsz);
+}
+
+static gchar *
+fu_common_delta_digest_to_string (const guint8 *digest)
+{
+	GString *str = g_string_new (NULL);
+	for (guint i = 0; i < FU_COMMON_DELTA_DIGEST_SIZE; i++)
+		g_string_append_printf (str, "%02x", digest[i]);
+	return g_string_free (str, FALSE);
+}
+
+static guint32
+fu_common_delta_hash (const guint8 *buf)
+{
+	guint32 hash = 0;
+	for (guint i = 0; i < FU_COMMON_DELTA_BLOCK_SIZE; i++)
+		hash = hash * FU_COMMON_DELTA_HASH_MULT + buf[i];
+	return hash;
+}
+
+static void
+fu_common_delta_table_insert (FuCommonDeltaEntry *table,
+			      guint32 mask,
+			      const guint8 *src,
+			      guint32 idx)
+{
+	const guint8 *block = src + (gsize) idx * FU_COMMON_DELTA_BLOCK_SIZE;
+	guint32 hash = fu_common_delta_hash (block);
+	guint32 slot = hash & mask;
+
+	/* identical blocks such as erased flash only need one entry */
+	while (table[slot].idx != 0) {
+		if (table[slot].hash == hash) {
+			const guint8 *tmp;
+			tmp = src + (gsize) (table[slot].idx - 1) * FU_COMMON_DELTA_BLOCK_SIZE;
+			if (memcmp (tmp, block, FU_COMMON_DELTA_BLOCK_SIZE) == 0)
+				return;
+		}
+		slot = (slot + 1) & mask;
+	}
+	table[slot].hash = hash;
+	table[slot].idx = idx + 1;
+}
+
+/* returns the source offset of a block matching @buf, or G_MAXSIZE */
+static gsize
+fu_common_delta_table_lookup (FuCommonDeltaEntry *table,
+			      guint32 mask,
+			      const guint8 *src,
+			      guint32 hash,
+			      const guint8 *buf)
+{
+	for (guint32 slot = hash & mask; table[slot].idx != 0; slot = (slot + 1) & mask) {
+		gsize offset;
+		if (table[slot].hash != hash)
+			continue;
+		offset = (gsize) (table[slot].idx - 1) * FU_COMMON_DELTA_BLOCK_SIZE;
+		if (memcmp (src + offset, buf, FU_COMMON_DELTA_BLOCK_SIZE) == 0)
+			return offset;
+	}
+	return G_MAXSIZE;
+}
+
+static void
+fu_common_delta_append_data (GByteArray *delta, const guint8 *buf, gsize bufsz)
+{
+	if (bufsz == 0)
+		return;
+	fu_byte_array_append_uint8 (delta, FU_COMMON_DELTA_OP_DATA);
+	fu_byte_array_append_uint32 (delta, (guint32) bufsz, G_LITTLE_ENDIAN);
+	g_byte_array_append (delta, buf, (guint) bufsz);
+}
+
+static void
+fu_common_delta_append_copy (GByteArray *delta, gsize offset, gsize length)
+{
+	fu_byte_array_append_uint8 (delta, FU_COMMON_DELTA_OP_COPY);
+	fu_byte_array_append_uint32 (delta, (guint32) offset, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint32 (delta, (guint32) length, G_LITTLE_ENDIAN);
+}
+
+/**
+ * fu_common_delta_generate:
+ * @source: A #GBytes of the currently installed image
+ * @target: A #GBytes of the new image
+ * @error: A #GError, or %NULL
+ *
+ * Generates a binary delta that can be used to reconstruct @target from
+ * @source using fu_common_delta_apply(). Regions of @target that also appear
+ * anywhere in @source are copied, and everything else is stored verbatim.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ *
+ * Since: 1.5.0
+ **/
+GBytes *
+fu_common_delta_generate (GBytes *source, GBytes *target, GError **error)
+{
+	gsize srcsz = 0;
+	gsize tgtsz = 0;
+	gsize lit = 0;
+	gsize i = 0;
+	gboolean hash_valid = FALSE;
+	guint32 hash = 0;
+	guint32 mask;
+	guint32 mult_out = 1;
+	guint32 nr_blocks;
+	guint32 table_sz = 16;
+	guint8 digest[FU_COMMON_DELTA_DIGEST_SIZE] = { 0x0 };
+	const guint8 *src = g_bytes_get_data (source, &srcsz);
+	const guint8 *tgt = g_bytes_get_data (target, &tgtsz);
+	g_autofree FuCommonDeltaEntry *table = NULL;
+	g_autoptr(GByteArray) delta = g_byte_array_new ();
+
+	g_return_val_if_fail (source != NULL, NULL);
+	g_return_val_if_fail (target != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* offsets and sizes are stored as uint32 */
+	if (srcsz > G_MAXUINT32 || tgtsz > G_MAXUINT32) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "images larger than 4GB are not supported");
+		return NULL;
+	}
+
+	/* header */
+	g_byte_array_append (delta, (const guint8 *) FU_COMMON_DELTA_MAGIC, 8);
+	fu_byte_array_append_uint32 (delta, (guint32) srcsz, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint32 (delta, (guint32) tgtsz, G_LITTLE_ENDIAN);
+	fu_common_delta_checksum (source, digest);
+	g_byte_array_append (delta, digest, sizeof(digest));
+	fu_common_delta_checksum (target, digest);
+	g_byte_array_append (delta, digest, sizeof(digest));
+
+	/* index every aligned block of the source image */
+	nr_blocks = (guint32) (srcsz / FU_COMMON_DELTA_BLOCK_SIZE);
+	while (table_sz < nr_blocks * 2)
+		table_sz <<= 1;
+	mask = table_sz - 1;
+	table = g_new0 (FuCommonDeltaEntry, table_sz);
+	for (guint32 j = 0; j < nr_blocks; j++)
+		fu_common_delta_table_insert (table, mask, src, j);
+	for (guint j = 1; j < FU_COMMON_DELTA_BLOCK_SIZE; j++)
+		mult_out *= FU_COMMON_DELTA_HASH_MULT;
+
+	/* look for each block at every offset of the target using a rolling hash */
+	while (nr_blocks > 0 && i + FU_COMMON_DELTA_BLOCK_SIZE <= tgtsz) {
+		gsize offset;
+		if (!hash_valid) {
+			hash = fu_common_delta_hash (tgt + i);
+			hash_valid = TRUE;
+		}
+		offset = fu_common_delta_table_lookup (table, mask, src, hash, tgt + i);
+		if (offset != G_MAXSIZE) {
+			gsize len = FU_COMMON_DELTA_BLOCK_SIZE;
+
+			/* grow the match in both directions */
+			while (offset + len < srcsz && i + len < tgtsz &&
+			       src[offset + len] == tgt[i + len])
+				len++;
+			while (i > lit && offset > 0 && src[offset - 1] == tgt[i - 1]) {
+				offset--;
+				i--;
+				len++;
+			}
+			fu_common_delta_append_data (delta, tgt + lit, i - lit);
+			fu_common_delta_append_copy (delta, offset, len);
+			i += len;
+			lit = i;
+			hash_valid = FALSE;
+			continue;
+		}
+		if (i + FU_COMMON_DELTA_BLOCK_SIZE < tgtsz) {
+			hash = (hash - tgt[i] * mult_out) * FU_COMMON_DELTA_HASH_MULT +
+				tgt[i + FU_COMMON_DELTA_BLOCK_SIZE];
+		}
+		i++;
+	}
+	fu_common_delta_append_data (delta, tgt + lit, tgtsz - lit);
+	fu_byte_array_append_uint8 (delta, FU_COMMON_DELTA_OP_END);
+	return g_byte_array_free_to_bytes (g_steal_pointer (&delta));
+}
+
+static gboolean
+fu_common_delta_check_magic (const guint8 *buf, gsize bufsz, GError **error)
+{
+	if (bufsz < FU_COMMON_DELTA_HEADER_SIZE ||
+	    memcmp (buf, FU_COMMON_DELTA_MAGIC, 8) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "not a delta image");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_common_delta_parse_header:
+ * @delta: A #GBytes created by fu_common_delta_generate()
+ * @source_checksum: (out) (optional): the SHA-256 of the source image
+ * @target_checksum: (out) (optional): the SHA-256 of the target image
+ * @target_size: (out) (optional): the size of the target image in bytes
+ * @error: A #GError, or %NULL
+ *
+ * Reads the delta header, which allows the caller to find the correct source
+ * image before calling fu_common_delta_apply().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fu_common_delta_parse_header (GBytes *delta,
+			      gchar **source_checksum,
+			      gchar **target_checksum,
+			      gsize *target_size,
+			      GError **error)
+{
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data (delta, &bufsz);
+
+	g_return_val_if_fail (delta != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (!fu_common_delta_check_magic (buf, bufsz, error))
+		return FALSE;
+	if (source_checksum != NULL)
+		*source_checksum = fu_common_delta_digest_to_string (buf + 0x10);
+	if (target_checksum != NULL)
+		*target_checksum = fu_common_delta_digest_to_string (buf + 0x30);
+	if (target_size != NULL)
+		*target_size = fu_common_read_uint32 (buf + 0x0c, G_LITTLE_ENDIAN);
+	return TRUE;
+}
+
+/**
+ * fu_common_delta_apply:
+ * @source: A #GBytes of the currently installed image
+ * @delta: A #GBytes created by fu_common_delta_generate()
+ * @error: A #GError, or %NULL
+ *
+ * Reconstructs the target image from @source. The source image and the
+ * result are both verified against the checksums stored in @delta.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ *
+ * Since: 1.5.0
+ **/
+GBytes *
+fu_common_delta_apply (GBytes *source, GBytes *delta, GError **error)
+{
+	gsize bufsz = 0;
+	gsize srcsz = 0;
+	gsize offset = FU_COMMON_DELTA_HEADER_SIZE;
+	guint32 source_size;
+	guint32 target_size;
+	guint8 digest[FU_COMMON_DELTA_DIGEST_SIZE] = { 0x0 };
+	const guint8 *buf = g_bytes_get_data (delta, &bufsz);
+	const guint8 *src = g_bytes_get_data (source, &srcsz);
+	g_autoptr(GByteArray) target = NULL;
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail (source != NULL, NULL);
+	g_return_val_if_fail (delta != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* check this delta is for the installed image */
+	if (!fu_common_delta_check_magic (buf, bufsz, error))
+		return NULL;
+	source_size = fu_common_read_uint32 (buf + 0x08, G_LITTLE_ENDIAN);
+	target_size = fu_common_read_uint32 (buf + 0x0c, G_LITTLE_ENDIAN);
+	fu_common_delta_checksum (source, digest);
+	if (srcsz != source_size || memcmp (digest, buf + 0x10, sizeof(digest)) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "delta does not apply to the installed image");
+		return NULL;
+	}
+
+	/* run each operation */
+	/* the header is untrusted, so only preallocate what the operations
+	 * could plausibly produce and grow as data is written */
+	target = g_byte_array_sized_new (MIN (target_size, srcsz + bufsz));
+	for (;;) {
+		guint8 op = FU_COMMON_DELTA_OP_END;
+		guint32 len = 0;
+		if (!fu_common_read_uint8_safe (buf, bufsz, offset, &op, error))
+			return NULL;
+		offset += 1;
+		if (op == FU_COMMON_DELTA_OP_END)
+			break;
+		if (op == FU_COMMON_DELTA_OP_COPY) {
+			guint32 src_offset = 0;
+			if (!fu_common_read_uint32_safe (buf, bufsz, offset, &src_offset,
+							 G_LITTLE_ENDIAN, error))
+				return NULL;
+			if (!fu_common_read_uint32_safe (buf, bufsz, offset + 4, &len,
+							 G_LITTLE_ENDIAN, error))
+				return NULL;
+			offset += 8;
+			if (src_offset > srcsz || len > srcsz - src_offset) {
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INVALID_FILE,
+					     "copy of 0x%x bytes from 0x%x outside source",
+					     len, src_offset);
+				return NULL;
+			}
+			if (len > target_size - target->len) {
+				g_set_error_literal (error,
+						     FWUPD_ERROR,
+						     FWUPD_ERROR_INVALID_FILE,
+						     "delta overflows target");
+				return NULL;
+			}
+			g_byte_array_append (target, src + src_offset, len);
+		} else if (op == FU_COMMON_DELTA_OP_DATA) {
+			if (!fu_common_read_uint32_safe (buf, bufsz, offset, &len,
+							 G_LITTLE_ENDIAN, error))
+				return NULL;
+			offset += 4;
+			if (len > bufsz - offset) {
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INVALID_FILE,
+					     "data of 0x%x bytes at 0x%x truncated",
+					     len, (guint) offset);
+				return NULL;
+			}
+			if (len > target_size - target->len) {
+				g_set_error_literal (error,
+						     FWUPD_ERROR,
+						     FWUPD_ERROR_INVALID_FILE,
+						     "delta overflows target");
+				return NULL;
+			}
+			g_byte_array_append (target, buf + offset, len);
+			offset += len;
+		} else {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "unknown delta operation 0x%02x at 0x%x",
+				     (guint) op, (guint) offset - 1);
+			return NULL;
+		}
+	}
+
+	/* only return the image if it is exactly what was signed */
+	if (target->len != target_size) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "target size invalid, expected 0x%x, got 0x%x",
+			     target_size, target->len);
+		return NULL;
+	}
+	blob = g_byte_array_free_to_bytes (g_steal_pointer (&target));
+	fu_common_delta_checksum (blob, digest);
+	if (memcmp (digest, buf + 0x30, sizeof(digest)) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "target checksum invalid");
+		return NULL;
+	}
+	return g_steal_pointer (&blob);
+}
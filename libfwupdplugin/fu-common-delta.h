@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+GBytes		*fu_common_delta_generate	(GBytes		*source,
+						 GBytes		*target,
+						 GError		**error);
+GBytes		*fu_common_delta_apply		(GBytes		*source,
+						 GBytes		*delta,
+						 GError		**error);
+gboolean	 fu_common_delta_parse_header	(GBytes		*delta,
+						 gchar		**source_checksum,
+						 gchar		**target_checksum,
+						 gsize		*target_size,
+						 GError		**error);
@@ -17,6 +17,22 @@
 
 #define FU_COMMON_VERSION_DECODE_BCD(val)	((((val) >> 4) & 0x0f) * 10 + ((val) & 0x0f))
 
+/* each section is encoded as SECTION, the integer as two units, any suffix
+ * characters and then the section terminator; a tilde sorts before
+ * everything and other characters sort by signed value, with the section
+ * terminator ordered as if it was a NUL char -- this matches fu_common_vercmp() */
+#define FU_VERSION_KEY_END			0
+#define FU_VERSION_KEY_SECTION			1
+#define FU_VERSION_KEY_TILDE			2
+#define FU_VERSION_KEY_CHAR(c)			((guint32) ((gint) ((gint8) (c)) + 131))
+
+struct _FuVersionKey {
+	FwupdVersionFormat	 fmt;
+	gchar			*version;
+	guint32			*units;
+	guint			 len;
+};
+
 /**
  * fu_common_version_from_uint64:
  * @val: A raw version number
@@ -551,3 +567,144 @@ fu_common_vercmp (const gchar *version_a, const gchar *version_b)
 	/* we really shouldn't get here */
 	return 0;
 }
+
+static void
+fu_common_version_key_append (GArray *units, guint32 unit)
+{
+	g_array_append_val (units, unit);
+}
+
+/**
+ * fu_common_version_key_new:
+ * @version: (nullable): the version, e.g. `1.2.3`
+ * @fmt: a #FwupdVersionFormat, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Parses a version string into a key that can be compared many times without
+ * being parsed again, for instance when sorting a large number of releases.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ *
+ * Since: 1.5.0
+ **/
+FuVersionKey *
+fu_common_version_key_new (const gchar *version, FwupdVersionFormat fmt)
+{
+	FuVersionKey *self = g_new0 (FuVersionKey, 1);
+	g_autoptr(GArray) units = NULL;
+
+	self->fmt = fmt;
+	self->version = g_strdup (version);
+	if (version == NULL)
+		return self;
+
+	units = g_array_new (FALSE, FALSE, sizeof(guint32));
+	if (fmt == FWUPD_VERSION_FORMAT_PLAIN) {
+		for (guint i = 0; version[i] != '\0'; i++)
+			fu_common_version_key_append (units, (guint8) version[i] + 1);
+	} else {
+		g_auto(GStrv) split = g_strsplit (version, ".", -1);
+		for (guint i = 0; split[i] != NULL; i++) {
+			gchar *endptr = NULL;
+			guint64 val;
+
+			/* flip the sign bit so that negative values sort first */
+			val = (guint64) g_ascii_strtoll (split[i], &endptr, 10);
+			val ^= G_GUINT64_CONSTANT (0x8000000000000000);
+			fu_common_version_key_append (units, FU_VERSION_KEY_SECTION);
+			fu_common_version_key_append (units, (guint32) (val >> 32));
+			fu_common_version_key_append (units, (guint32) val);
+			for (guint j = 0; endptr[j] != '\0'; j++) {
+				if (endptr[j] == '~')
+					fu_common_version_key_append (units, FU_VERSION_KEY_TILDE);
+				else
+					fu_common_version_key_append (units, FU_VERSION_KEY_CHAR (endptr[j]));
+			}
+			fu_common_version_key_append (units, FU_VERSION_KEY_CHAR ('\0'));
+		}
+	}
+	fu_common_version_key_append (units, FU_VERSION_KEY_END);
+	self->len = units->len;
+	self->units = (guint32 *) g_array_free (g_steal_pointer (&units), FALSE);
+	return self;
+}
+
+/**
+ * fu_common_version_key_free:
+ * @self: A #FuVersionKey
+ *
+ * Frees a version key.
+ *
+ * Since: 1.5.0
+ **/
+void
+fu_common_version_key_free (FuVersionKey *self)
+{
+	g_return_if_fail (self != NULL);
+	g_free (self->version);
+	g_free (self->units);
+	g_free (self);
+}
+
+/**
+ * fu_common_version_key_matches:
+ * @self: A #FuVersionKey
+ * @version: (nullable): the version, e.g. `1.2.3`
+ * @fmt: a #FwupdVersionFormat, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Checks if the key was created for this version and format, which allows
+ * callers to cache a key and only parse the version again when it changes.
+ *
+ * Returns: %TRUE if the key can be used
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fu_common_version_key_matches (const FuVersionKey *self,
+				const gchar *version,
+				FwupdVersionFormat fmt)
+{
+	g_return_val_if_fail (self != NULL, FALSE);
+	if ((self->fmt == FWUPD_VERSION_FORMAT_PLAIN) != (fmt == FWUPD_VERSION_FORMAT_PLAIN))
+		return FALSE;
+	return g_strcmp0 (self->version, version) == 0;
+}
+
+/**
+ * fu_common_version_key_compare:
+ * @self: A #FuVersionKey
+ * @other: A #FuVersionKey
+ *
+ * Compares two version keys, returning the same result as
+ * fu_common_vercmp_full() would for the original version strings.
+ *
+ * Returns: -1 if a < b, +1 if a > b, 0 if they are equal, and %G_MAXINT on error
+ *
+ * Since: 1.5.0
+ **/
+gint
+fu_common_version_key_compare (const FuVersionKey *self, const FuVersionKey *other)
+{
+	g_return_val_if_fail (self != NULL, G_MAXINT);
+	g_return_val_if_fail (other != NULL, G_MAXINT);
+
+	/* created with different formats */
+	if ((self->fmt == FWUPD_VERSION_FORMAT_PLAIN) !=
+	    (other->fmt == FWUPD_VERSION_FORMAT_PLAIN))
+		return fu_common_vercmp_full (self->version, other->version, self->fmt);
+
+	/* no version */
+	if (self->units == NULL || other->units == NULL) {
+		if (self->fmt == FWUPD_VERSION_FORMAT_PLAIN)
+			return g_strcmp0 (self->version, other->version);
+		return G_MAXINT;
+	}
+
+	/* both are terminated by FU_VERSION_KEY_END */
+	for (guint i = 0; i < self->len && i < other->len; i++) {
+		if (self->units[i] < other->units[i])
+			return -1;
+		if (self->units[i] > other->units[i])
+			return 1;
+	}
+	return 0;
+}
@@ -30,3 +30,19 @@ FwupdVersionFormat	 fu_common_version_guess_format	(const gchar	*version);
 gboolean	 fu_common_version_verify_format	(const gchar	*version,
 							 FwupdVersionFormat fmt,
 							 GError		**error);
+
+typedef struct _FuVersionKey FuVersionKey;
+
+FuVersionKey	*fu_common_version_key_new	(const gchar	*version,
+							 FwupdVersionFormat fmt);
+void		 fu_common_version_key_free	(FuVersionKey	*self);
+gint		 fu_common_version_key_compare	(const FuVersionKey *self,
+							 const FuVersionKey *other);
+gboolean	 fu_common_version_key_matches	(const FuVersionKey *self,
+							 const gchar	*version,
+							 FwupdVersionFormat fmt);
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuVersionKey, fu_common_version_key_free)
+#pragma clang diagnostic pop
@@ -6,10 +6,16 @@
 
 #define G_LOG_DOMAIN				"FuCommon"
 
+/* for F_GET_SEALS */
+#define _GNU_SOURCE
+
 #include <config.h>
 
 #ifdef HAVE_GIO_UNIX
 #include <gio/gunixinputstream.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <glib/gstdio.h>
 
@@ -218,6 +224,50 @@ fu_common_get_contents_bytes (const gchar *filename, GError **error)
 	return g_bytes_new_take (data, len);
 }
 
+#ifdef HAVE_GIO_UNIX
+/* the contents of a sealed memfd cannot be changed by anyone after we have
+ * mapped it, so it is safe to use the data without copying it; any other fd
+ * may be modified by whoever else holds it open */
+static gboolean
+fu_common_fd_is_immutable (gint fd)
+{
+#ifdef HAVE_MEMFD_CREATE
+	gint seals = fcntl (fd, F_GET_SEALS);
+	if (seals >= 0 &&
+	    (seals & (F_SEAL_WRITE | F_SEAL_SHRINK)) == (F_SEAL_WRITE | F_SEAL_SHRINK))
+		return TRUE;
+#endif
+	return FALSE;
+}
+
+static GBytes *
+fu_common_get_contents_fd_mapped (gint fd, struct stat *st, gsize count, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GMappedFile) mapped = NULL;
+
+	if ((guint64) st->st_size > count) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "file is too large (%" G_GUINT64_FORMAT " bytes, maximum %" G_GSIZE_FORMAT ")",
+			     (guint64) st->st_size, count);
+		return NULL;
+	}
+	mapped = g_mapped_file_new_from_fd (fd, FALSE, &error_local);
+	if (mapped == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     error_local->message);
+		return NULL;
+	}
+	g_debug ("mapped %" G_GSIZE_FORMAT " bytes from fd %i",
+		 g_mapped_file_get_length (mapped), fd);
+	return g_mapped_file_get_bytes (mapped);
+}
+#endif
+
 /**
  * fu_common_get_contents_fd:
  * @fd: A file descriptor
@@ -226,6 +276,10 @@ fu_common_get_contents_bytes (const gchar *filename, GError **error)
  *
  * Reads a blob from a specific file descriptor.
  *
+ * If the file descriptor is a memfd sealed with `F_SEAL_WRITE` and
+ * `F_SEAL_SHRINK` then the contents are mapped read-only rather than being
+ * copied.
+ *
  * Note: this will close the fd when done
  *
  * Returns: (transfer full): a #GBytes, or %NULL
@@ -236,6 +290,7 @@ GBytes *
 fu_common_get_contents_fd (gint fd, gsize count, GError **error)
 {
 #ifdef HAVE_GIO_UNIX
+	struct stat st;
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GInputStream) stream = NULL;
@@ -249,9 +304,17 @@ fu_common_get_contents_fd (gint fd, gsize count, GError **error)
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
 				     "A maximum read size must be specified");
+		close (fd);
 		return NULL;
 	}
 
+	/* zero-copy, the mapping is kept alive after the fd is closed */
+	if (fu_common_fd_is_immutable (fd) && fstat (fd, &st) == 0) {
+		blob = fu_common_get_contents_fd_mapped (fd, &st, count, error);
+		close (fd);
+		return g_steal_pointer (&blob);
+	}
+
 	/* read the entire fd to a data blob */
 	stream = g_unix_input_stream_new (fd, TRUE);
 	blob = g_input_stream_read_bytes (stream, count, NULL, &error_local);
@@ -1485,13 +1548,42 @@ fu_common_bytes_align (GBytes *bytes, gsize blksz, gchar padval)
 gboolean
 fu_common_bytes_is_empty (GBytes *bytes)
 {
+	gsize blksz;
 	gsize sz = 0;
 	const guint8 *buf = g_bytes_get_data (bytes, &sz);
-	for (gsize i = 0; i < sz; i++) {
+
+	if (sz == 0)
+		return TRUE;
+
+	/* check the first cacheline byte-by-byte; the rest of the buffer is
+	 * then empty only if it is equal to itself shifted by that amount,
+	 * which lets memcmp() use the widest loads the CPU supports */
+	blksz = MIN (sz, 64);
+	for (gsize i = 0; i < blksz; i++) {
 		if (buf[i] != 0xff)
 			return FALSE;
 	}
-	return TRUE;
+	return memcmp (buf, buf + blksz, sz - blksz) == 0;
+}
+
+/* only called when the buffers are known to differ */
+static gsize
+fu_common_bytes_find_mismatch (const guint8 *buf1, const guint8 *buf2, gsize bufsz)
+{
+	const gsize blksz = 0x1000;
+	gsize offset = 0;
+
+	/* skip whole blocks that match */
+	while (bufsz - offset > blksz) {
+		if (memcmp (buf1 + offset, buf2 + offset, blksz) != 0)
+			break;
+		offset += blksz;
+	}
+	for (; offset < bufsz; offset++) {
+		if (buf1[offset] != buf2[offset])
+			return offset;
+	}
+	return bufsz;
 }
 
 /**
@@ -1528,15 +1620,14 @@ fu_common_bytes_compare_raw (const guint8 *buf1, gsize bufsz1,
 	}
 
 	/* check matches */
-	for (guint i = 0x0; i < bufsz1; i++) {
-		if (buf1[i] != buf2[i]) {
-			g_set_error (error,
+	if (memcmp (buf1, buf2, bufsz1) != 0) {
+		gsize i = fu_common_bytes_find_mismatch (buf1, buf2, bufsz1);
+		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_INVALID_DATA,
 			     "got 0x%02x, expected 0x%02x @ 0x%04x",
-			     buf1[i], buf2[i], i);
-			return FALSE;
-		}
+			     buf1[i], buf2[i], (guint) i);
+		return FALSE;
 	}
 
 	/* success */
@@ -1604,6 +1695,54 @@ fu_common_bytes_pad (GBytes *bytes, gsize sz)
 	return g_bytes_ref (bytes);
 }
 
+/**
+ * fu_common_bytes_new_offset:
+ * @bytes: a #GBytes
+ * @offset: where subsection starts at
+ * @length: length of subsection
+ * @error: A #GError or %NULL
+ *
+ * Creates a #GBytes which is a subsection of another #GBytes, without copying
+ * the data. The new #GBytes keeps a reference to @bytes.
+ *
+ * Unlike g_bytes_new_from_bytes() the range is checked, so this is safe to
+ * use with offsets and lengths read from untrusted firmware.
+ *
+ * Return value: (transfer full): a #GBytes, or %NULL if the range is invalid
+ *
+ * Since: 1.5.0
+ **/
+GBytes *
+fu_common_bytes_new_offset (GBytes *bytes,
+			    gsize offset,
+			    gsize length,
+			    GError **error)
+{
+	gsize bufsz;
+
+	g_return_val_if_fail (bytes != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* sanity check */
+	bufsz = g_bytes_get_size (bytes);
+	if (offset > bufsz || length > bufsz - offset) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "cannot create bytes @0x%02x for 0x%02x "
+			     "as buffer only 0x%04x bytes in size",
+			     (guint) offset,
+			     (guint) length,
+			     (guint) bufsz);
+		return NULL;
+	}
+
+	/* the entire buffer */
+	if (offset == 0 && length == bufsz)
+		return g_bytes_ref (bytes);
+	return g_bytes_new_from_bytes (bytes, offset, length);
+}
+
 /**
  * fu_common_realpath:
  * @filename: a filename
@@ -61,6 +61,7 @@ typedef struct {
 	GPtrArray			*possible_plugins;
 	GPtrArray			*retry_recs;	/* of FuDeviceRetryRecovery */
 	guint				 retry_delay;
+	FuVersionKey			*version_key;
 } FuDevicePrivate;
 
 typedef struct {
@@ -1232,8 +1233,12 @@ fu_device_has_guid (FuDevice *self, const gchar *guid)
 	g_return_val_if_fail (guid != NULL, FALSE);
 
 	/* make valid */
+	if (guid[0] == '\0')
+		return FALSE;
 	if (!fwupd_guid_is_valid (guid)) {
-		g_autofree gchar *tmp = fwupd_guid_hash_string (guid);
+		gchar tmp[FWUPD_GUID_STRING_SIZE];
+		fwupd_guid_hash_data_to_buf ((const guint8 *) guid, strlen (guid),
+					     FWUPD_GUID_FLAG_NONE, tmp);
 		return fwupd_device_has_guid (FWUPD_DEVICE (self), tmp);
 	}
 
@@ -1686,6 +1691,38 @@ fu_device_set_version (FuDevice *self, const gchar *version)
 	}
 }
 
+/**
+ * fu_device_get_version_key:
+ * @self: A #FuDevice
+ *
+ * Gets the device version as a pre-parsed key, which is faster than
+ * fu_common_vercmp_full() when comparing against many releases. The key is
+ * created again if the version or version format has changed.
+ *
+ * Returns: a #FuVersionKey
+ *
+ * Since: 1.5.0
+ **/
+const FuVersionKey *
+fu_device_get_version_key (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	const gchar *version;
+	FwupdVersionFormat fmt;
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+
+	version = fu_device_get_version (self);
+	fmt = fu_device_get_version_format (self);
+	if (priv->version_key == NULL ||
+	    !fu_common_version_key_matches (priv->version_key, version, fmt)) {
+		if (priv->version_key != NULL)
+			fu_common_version_key_free (priv->version_key);
+		priv->version_key = fu_common_version_key_new (version, fmt);
+	}
+	return priv->version_key;
+}
+
 /**
  * fu_device_set_version_lowest:
  * @self: A #FuDevice
@@ -2867,7 +2904,11 @@ fu_device_convert_instance_ids (FuDevice *self)
 		return;
 	for (guint i = 0; i < instance_ids->len; i++) {
 		const gchar *instance_id = g_ptr_array_index (instance_ids, i);
-		g_autofree gchar *guid = fwupd_guid_hash_string (instance_id);
+		gchar guid[FWUPD_GUID_STRING_SIZE];
+		if (instance_id[0] == '\0')
+			continue;
+		fwupd_guid_hash_data_to_buf ((const guint8 *) instance_id, strlen (instance_id),
+					     FWUPD_GUID_FLAG_NONE, guid);
 		fwupd_device_add_guid (FWUPD_DEVICE (self), guid);
 	}
 
@@ -3034,7 +3075,11 @@ fu_device_incorporate (FuDevice *self, FuDevice *donor)
 	/* call the set_quirk_kv() vfunc for the superclassed object */
 	for (guint i = 0; i < instance_ids->len; i++) {
 		const gchar *instance_id = g_ptr_array_index (instance_ids, i);
-		g_autofree gchar *guid = fwupd_guid_hash_string (instance_id);
+		gchar guid[FWUPD_GUID_STRING_SIZE];
+		if (instance_id[0] == '\0')
+			continue;
+		fwupd_guid_hash_data_to_buf ((const guint8 *) instance_id, strlen (instance_id),
+					     FWUPD_GUID_FLAG_NONE, guid);
 		fu_device_add_guid_quirks (self, guid);
 	}
 }
@@ -3169,6 +3214,8 @@ fu_device_finalize (GObject *object)
 	g_free (priv->physical_id);
 	g_free (priv->logical_id);
 	g_free (priv->proxy_guid);
+	if (priv->version_key != NULL)
+		fu_common_version_key_free (priv->version_key);
 
 	G_OBJECT_CLASS (fu_device_parent_class)->finalize (object);
 }
@@ -212,6 +212,7 @@ void		 fu_device_set_version			(FuDevice	*self,
 							 const gchar	*version);
 void		 fu_device_set_version_lowest		(FuDevice	*self,
 							 const gchar	*version);
+const FuVersionKey *fu_device_get_version_key		(FuDevice	*self);
 void		 fu_device_set_version_bootloader	(FuDevice	*self,
 							 const gchar	*version);
 const gchar	*fu_device_get_physical_id		(FuDevice	*self);
@@ -10,8 +10,21 @@
 
 #include <string.h>
 
+#include "fwupd-error.h"
+
 #include "fu-firmware-common.h"
 
+/* the value of each hex digit plus one, so that zero means invalid */
+static const guint8 fu_firmware_hex_nibble[256] = {
+	['0'] = 0x01, ['1'] = 0x02, ['2'] = 0x03, ['3'] = 0x04,
+	['4'] = 0x05, ['5'] = 0x06, ['6'] = 0x07, ['7'] = 0x08,
+	['8'] = 0x09, ['9'] = 0x0a,
+	['A'] = 0x0b, ['B'] = 0x0c, ['C'] = 0x0d, ['D'] = 0x0e,
+	['E'] = 0x0f, ['F'] = 0x10,
+	['a'] = 0x0b, ['b'] = 0x0c, ['c'] = 0x0d, ['d'] = 0x0e,
+	['e'] = 0x0f, ['f'] = 0x10,
+};
+
 /**
  * fu_firmware_strparse_uint4:
  * @data: a string
@@ -121,3 +134,51 @@ fu_firmware_strparse_uint32 (const gchar *data)
 	buffer[8] = '\0';
 	return (guint32) g_ascii_strtoull (buffer, NULL, 16);
 }
+
+/**
+ * fu_firmware_strparse_uint8_safe:
+ * @data: a buffer of ASCII hex digits, not necessarily NUL terminated
+ * @datasz: size of @data
+ * @offset: offset into @data to parse from
+ * @value: (out) (nullable): the parsed value
+ * @error: A #GError, or %NULL
+ *
+ * Parses a base 16 number from two characters in a buffer using a lookup
+ * table, failing if the buffer is too small or a character is not a hex digit.
+ *
+ * Return value: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fu_firmware_strparse_uint8_safe (const gchar *data,
+				 gsize datasz,
+				 gsize offset,
+				 guint8 *value,
+				 GError **error)
+{
+	guint8 hi;
+	guint8 lo;
+
+	if (offset + 2 > datasz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "cannot parse hex byte at offset 0x%x of 0x%x",
+			     (guint) offset, (guint) datasz);
+		return FALSE;
+	}
+	hi = fu_firmware_hex_nibble[(guint8) data[offset]];
+	lo = fu_firmware_hex_nibble[(guint8) data[offset + 1]];
+	if (hi == 0 || lo == 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid hex digit at offset 0x%x",
+			     (guint) offset);
+		return FALSE;
+	}
+	if (value != NULL)
+		*value = (guint8) (((hi - 1) << 4) | (lo - 1));
+	return TRUE;
+}
@@ -13,3 +13,8 @@ guint8		 fu_firmware_strparse_uint8		(const gchar	*data);
 guint16		 fu_firmware_strparse_uint16		(const gchar	*data);
 guint32		 fu_firmware_strparse_uint24		(const gchar	*data);
 guint32		 fu_firmware_strparse_uint32		(const gchar	*data);
+gboolean	 fu_firmware_strparse_uint8_safe	(const gchar	*data,
+							 gsize		 datasz,
+							 gsize		 offset,
+							 guint8		*value,
+							 GError		**error);
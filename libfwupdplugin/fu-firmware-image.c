@@ -24,6 +24,9 @@ typedef struct {
 	guint64			 addr;
 	guint64			 idx;
 	gchar			*version;
+	FuFirmwareImageLoadFunc	 load_func;
+	gpointer		 load_user_data;
+	GDestroyNotify		 load_user_data_destroy;
 } FuFirmwareImagePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FuFirmwareImage, fu_firmware_image, G_TYPE_OBJECT)
@@ -169,6 +172,17 @@ fu_firmware_image_get_idx (FuFirmwareImage *self)
 	return priv->idx;
 }
 
+static void
+fu_firmware_image_clear_load_func (FuFirmwareImage *self)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	if (priv->load_user_data_destroy != NULL)
+		priv->load_user_data_destroy (priv->load_user_data);
+	priv->load_func = NULL;
+	priv->load_user_data = NULL;
+	priv->load_user_data_destroy = NULL;
+}
+
 /**
  * fu_firmware_image_set_bytes:
  * @self: a #FuPlugin
@@ -186,6 +200,58 @@ fu_firmware_image_set_bytes (FuFirmwareImage *self, GBytes *bytes)
 	g_return_if_fail (bytes != NULL);
 	g_return_if_fail (priv->bytes == NULL);
 	priv->bytes = g_bytes_ref (bytes);
+	fu_firmware_image_clear_load_func (self);
+}
+
+/**
+ * fu_firmware_image_set_load_func:
+ * @self: a #FuFirmwareImage
+ * @func: (scope notified): a #FuFirmwareImageLoadFunc
+ * @user_data: user data to pass to @func
+ * @user_data_destroy: (nullable): a function to free @user_data
+ *
+ * Sets a function that provides the contents of the image the first time they
+ * are required, for instance by fu_firmware_get_image_by_id_bytes().
+ *
+ * This allows a parser to add every image in a large container cheaply, only
+ * decoding the images that are actually used. The function is called at most
+ * once and @user_data is freed afterwards.
+ *
+ * Since: 1.5.0
+ **/
+void
+fu_firmware_image_set_load_func (FuFirmwareImage *self,
+				 FuFirmwareImageLoadFunc func,
+				 gpointer user_data,
+				 GDestroyNotify user_data_destroy)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (self));
+	g_return_if_fail (func != NULL);
+	g_return_if_fail (priv->bytes == NULL);
+	fu_firmware_image_clear_load_func (self);
+	priv->load_func = func;
+	priv->load_user_data = user_data;
+	priv->load_user_data_destroy = user_data_destroy;
+}
+
+static gboolean
+fu_firmware_image_ensure_bytes (FuFirmwareImage *self, GError **error)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	GBytes *bytes;
+
+	/* already set, or nothing to load */
+	if (priv->bytes != NULL || priv->load_func == NULL)
+		return TRUE;
+	bytes = priv->load_func (self, priv->load_user_data, error);
+	if (bytes == NULL) {
+		g_prefix_error (error, "failed to load image %s: ", priv->id);
+		return FALSE;
+	}
+	priv->bytes = bytes;
+	fu_firmware_image_clear_load_func (self);
+	return TRUE;
 }
 
 /**
@@ -196,7 +262,8 @@ fu_firmware_image_set_bytes (FuFirmwareImage *self, GBytes *bytes)
  * Writes the image, which will try to call a superclassed ->write() function.
  *
  * By default (and in most cases) this just provides the value set by the
- * fu_firmware_image_set_bytes() function.
+ * fu_firmware_image_set_bytes() function, or loaded by the function set with
+ * fu_firmware_image_set_load_func().
  *
  * Returns: (transfer full): a #GBytes of the bytes, or %NULL if the bytes is not set
  *
@@ -216,6 +283,8 @@ fu_firmware_image_write (FuFirmwareImage *self, GError **error)
 		return klass->write (self, error);
 
 	/* fall back to what was set manually */
+	if (!fu_firmware_image_ensure_bytes (self, error))
+		return NULL;
 	if (priv->bytes == NULL) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -264,6 +333,15 @@ fu_firmware_image_write_chunk (FuFirmwareImage *self,
 	}
 
 	/* offset into data */
+	if (!fu_firmware_image_ensure_bytes (self, error))
+		return NULL;
+	if (priv->bytes == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "no bytes found in firmware bytes %s", priv->id);
+		return NULL;
+	}
 	offset = address - priv->addr;
 	if (offset > g_bytes_get_size (priv->bytes)) {
 		g_set_error (error,
@@ -341,6 +419,7 @@ fu_firmware_image_finalize (GObject *object)
 	g_free (priv->version);
 	if (priv->bytes != NULL)
 		g_bytes_unref (priv->bytes);
+	fu_firmware_image_clear_load_func (self);
 	G_OBJECT_CLASS (fu_firmware_image_parent_class)->finalize (object);
 }
 
@@ -28,6 +28,20 @@ struct _FuFirmwareImageClass
 	gpointer		 padding[28];
 };
 
+/**
+ * FuFirmwareImageLoadFunc:
+ * @self: a #FuFirmwareImage
+ * @user_data: user data
+ * @error: a #GError, or %NULL
+ *
+ * Provides the contents of an image when first required.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ **/
+typedef GBytes	*(*FuFirmwareImageLoadFunc)	(FuFirmwareImage	*self,
+						 gpointer		 user_data,
+						 GError			**error);
+
 #define FU_FIRMWARE_IMAGE_ID_PAYLOAD		"payload"
 #define FU_FIRMWARE_IMAGE_ID_SIGNATURE		"signature"
 #define FU_FIRMWARE_IMAGE_ID_HEADER		"header"
@@ -49,6 +63,10 @@ void		 fu_firmware_image_set_idx	(FuFirmwareImage	*self,
 						 guint64		 idx);
 void		 fu_firmware_image_set_bytes	(FuFirmwareImage	*self,
 						 GBytes			*bytes);
+void		 fu_firmware_image_set_load_func (FuFirmwareImage	*self,
+						 FuFirmwareImageLoadFunc func,
+						 gpointer		 user_data,
+						 GDestroyNotify		 user_data_destroy);
 GBytes		*fu_firmware_image_write	(FuFirmwareImage	*self,
 						 GError			**error);
 GBytes		*fu_firmware_image_write_chunk	(FuFirmwareImage	*self,
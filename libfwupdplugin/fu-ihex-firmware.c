@@ -26,6 +26,7 @@
 struct _FuIhexFirmware {
 	FuFirmware		 parent_instance;
 	GPtrArray		*records;
+	GBytes			*fw;		/* not yet split into records */
 };
 
 G_DEFINE_TYPE (FuIhexFirmware, fu_ihex_firmware, FU_TYPE_FIRMWARE)
@@ -38,6 +39,59 @@ G_DEFINE_TYPE (FuIhexFirmware, fu_ihex_firmware, FU_TYPE_FIRMWARE)
 #define	DFU_INHX32_RECORD_TYPE_START_LINEAR	0x05
 #define	DFU_INHX32_RECORD_TYPE_SIGNATURE	0xfd
 
+typedef struct {
+	FwupdInstallFlags	 flags;
+	gboolean		 got_eof;
+	guint32			 abs_addr;
+	guint32			 addr_last;
+	guint32			 img_addr;
+	guint32			 seg_addr;
+	GByteArray		*buf;
+	GByteArray		*buf_signature;
+} FuIhexFirmwareParseHelper;
+
+static void
+fu_ihex_firmware_record_free (FuIhexFirmwareRecord *rcd)
+{
+	g_string_free (rcd->buf, TRUE);
+	g_free (rcd);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuIhexFirmwareRecord, fu_ihex_firmware_record_free)
+
+static FuIhexFirmwareRecord *
+fu_ihex_firmware_record_new (guint ln, const gchar *buf)
+{
+	FuIhexFirmwareRecord *rcd = g_new0 (FuIhexFirmwareRecord, 1);
+	rcd->ln = ln;
+	rcd->buf = g_string_new (buf);
+	return rcd;
+}
+
+static void
+fu_ihex_firmware_ensure_records (FuIhexFirmware *self)
+{
+	gsize sz = 0;
+	const gchar *data;
+	g_auto(GStrv) lines = NULL;
+
+	if (self->fw == NULL)
+		return;
+	data = g_bytes_get_data (self->fw, &sz);
+	if (sz > 0) {
+		lines = fu_common_strnsplit (data, sz, "\n", -1);
+		for (guint ln = 0; lines[ln] != NULL; ln++) {
+			g_autoptr(FuIhexFirmwareRecord) rcd = NULL;
+			g_strdelimit (lines[ln], "\r\x1a", '\0');
+			if (lines[ln][0] == '\0')
+				continue;
+			rcd = fu_ihex_firmware_record_new (ln + 1, lines[ln]);
+			g_ptr_array_add (self->records, g_steal_pointer (&rcd));
+		}
+	}
+	g_clear_pointer (&self->fw, g_bytes_unref);
+}
+
 /**
  * fu_ihex_firmware_get_records:
  * @self: A #FuIhexFirmware
@@ -55,25 +109,10 @@ GPtrArray *
 fu_ihex_firmware_get_records (FuIhexFirmware *self)
 {
 	g_return_val_if_fail (FU_IS_IHEX_FIRMWARE (self), NULL);
-	return self->records;
-}
-
-static void
-fu_ihex_firmware_record_free (FuIhexFirmwareRecord *rcd)
-{
-	g_string_free (rcd->buf, TRUE);
-	g_free (rcd);
-}
-
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuIhexFirmwareRecord, fu_ihex_firmware_record_free)
 
-static FuIhexFirmwareRecord *
-fu_ihex_firmware_record_new (guint ln, const gchar *buf)
-{
-	FuIhexFirmwareRecord *rcd = g_new0 (FuIhexFirmwareRecord, 1);
-	rcd->ln = ln;
-	rcd->buf = g_string_new (buf);
-	return rcd;
+	/* only split into lines when actually required */
+	fu_ihex_firmware_ensure_records (self);
+	return self->records;
 }
 
 static const gchar *
@@ -101,215 +140,312 @@ fu_ihex_firmware_tokenize (FuFirmware *firmware, GBytes *fw,
 			   FwupdInstallFlags flags, GError **error)
 {
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE (firmware);
-	gsize sz = 0;
-	const gchar *data = g_bytes_get_data (fw, &sz);
-	g_auto(GStrv) lines = fu_common_strnsplit (data, sz, "\n", -1);
 
-	for (guint ln = 0; lines[ln] != NULL; ln++) {
-		g_autoptr(FuIhexFirmwareRecord) rcd = NULL;
-		g_strdelimit (lines[ln], "\r\x1a", '\0');
-		if (lines[ln][0] == '\0')
-			continue;
-		rcd = fu_ihex_firmware_record_new (ln + 1, lines[ln]);
-		g_ptr_array_add (self->records, g_steal_pointer (&rcd));
-	}
+	/* the parser works on the raw buffer, so defer the per-line
+	 * allocations until fu_ihex_firmware_get_records() is called */
+	g_ptr_array_set_size (self->records, 0);
+	g_clear_pointer (&self->fw, g_bytes_unref);
+	self->fw = g_bytes_ref (fw);
 	return TRUE;
 }
 
+/* gets the next line without copying, where the line is also truncated at any
+ * carriage return or DOS EOF marker */
 static gboolean
-fu_ihex_firmware_parse (FuFirmware *firmware,
-			GBytes *fw,
-			guint64 addr_start,
-			guint64 addr_end,
-			FwupdInstallFlags flags,
-			GError **error)
+fu_ihex_firmware_next_line (const gchar *data,
+			    gsize datasz,
+			    gsize *offset,
+			    const gchar **line,
+			    gsize *linesz)
 {
-	FuIhexFirmware *self = FU_IHEX_FIRMWARE (firmware);
-	gboolean got_eof = FALSE;
-	guint32 abs_addr = 0x0;
-	guint32 addr_last = 0x0;
-	guint32 img_addr = G_MAXUINT32;
-	guint32 seg_addr = 0x0;
-	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (NULL);
-	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) buf = g_byte_array_new ();
-	g_autoptr(GByteArray) buf_signature = g_byte_array_new ();
+	const gchar *nl;
+	gsize sz;
 
-	/* parse records */
-	for (guint k = 0; k < self->records->len; k++) {
-		FuIhexFirmwareRecord *rcd = g_ptr_array_index (self->records, k);
-		const gchar *line = rcd->buf->str;
-		guint32 addr;
-		guint8 byte_cnt;
-		guint8 record_type;
-		guint line_end;
-
-		/* ignore comments */
-		if (g_str_has_prefix (line, ";"))
-			continue;
+	if (*offset >= datasz)
+		return FALSE;
+	*line = data + *offset;
+	nl = memchr (*line, '\n', datasz - *offset);
+	sz = nl != NULL ? (gsize) (nl - *line) : datasz - *offset;
+	*offset += sz + 1;
+	for (gsize i = 0; i < sz; i++) {
+		if ((*line)[i] == '\r' || (*line)[i] == '\x1a') {
+			sz = i;
+			break;
+		}
+	}
+	*linesz = sz;
+	return TRUE;
+}
 
-		/* ignore blank lines */
-		if (rcd->buf->len == 0)
+/* the number of data bytes in the file, ignoring any holes to be filled */
+static gsize
+fu_ihex_firmware_get_data_size (const gchar *data, gsize datasz)
+{
+	const gchar *line = NULL;
+	gsize linesz = 0;
+	gsize offset = 0;
+	gsize total = 0;
+
+	while (fu_ihex_firmware_next_line (data, datasz, &offset, &line, &linesz)) {
+		guint8 byte_cnt = 0;
+		guint8 record_type = 0;
+		if (linesz < 11 || line[0] != ':')
+			continue;
+		if (!fu_firmware_strparse_uint8_safe (line, linesz, 1, &byte_cnt, NULL))
+			continue;
+		if (!fu_firmware_strparse_uint8_safe (line, linesz, 7, &record_type, NULL))
 			continue;
+		if (record_type == DFU_INHX32_RECORD_TYPE_DATA)
+			total += byte_cnt;
+	}
+	return total;
+}
 
-		/* check starting token */
-		if (line[0] != ':') {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid starting token on line %u: %s",
-				     rcd->ln, line);
+static gboolean
+fu_ihex_firmware_parse_line (FuIhexFirmwareParseHelper *helper,
+			     const gchar *line,
+			     gsize linesz,
+			     guint ln,
+			     GError **error)
+{
+	guint8 rec[5 + G_MAXUINT8] = { 0x0 };	/* count, addr, type, data, csum */
+	guint8 byte_cnt = 0;
+	guint8 record_type;
+	guint32 addr;
+	guint line_end;
+	guint rec_len;
+	const guint8 *rec_data = rec + 4;
+
+	/* ignore comments and blank lines */
+	if (linesz == 0 || line[0] == ';')
+		return TRUE;
+
+	/* check starting token */
+	if (line[0] != ':') {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid starting token on line %u: %.*s",
+			     ln, (gint) linesz, line);
+		return FALSE;
+	}
+
+	/* check there's enough data for the smallest possible record */
+	if (linesz < 11) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "line %u is incomplete, length %u",
+			     ln, (guint) linesz);
+		return FALSE;
+	}
+
+	/* position of checksum */
+	if (!fu_firmware_strparse_uint8_safe (line, linesz, 1, &byte_cnt, error)) {
+		g_prefix_error (error, "line %u: ", ln);
+		return FALSE;
+	}
+	line_end = 9 + byte_cnt * 2;
+	if (line_end > (guint) linesz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "line %u malformed, length: %u",
+			     ln, line_end);
+		return FALSE;
+	}
+
+	/* decode the whole record at once, including the checksum if required */
+	rec_len = 4 + byte_cnt;
+	if ((helper->flags & FWUPD_INSTALL_FLAG_FORCE) == 0)
+		rec_len++;
+	for (guint i = 0; i < rec_len; i++) {
+		if (!fu_firmware_strparse_uint8_safe (line, linesz, 1 + (i * 2),
+						      &rec[i], error)) {
+			g_prefix_error (error, "line %u: ", ln);
 			return FALSE;
 		}
+	}
 
-		/* check there's enough data for the smallest possible record */
-		if (rcd->buf->len < 11) {
+	/* verify checksum */
+	if ((helper->flags & FWUPD_INSTALL_FLAG_FORCE) == 0) {
+		guint8 checksum = 0;
+		for (guint i = 0; i < rec_len; i++)
+			checksum += rec[i];
+		if (checksum != 0)  {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "line %u is incomplete, length %u",
-				     rcd->ln, (guint) rcd->buf->len);
+				     "line %u has invalid checksum (0x%02x)",
+				     ln, (guint) checksum);
 			return FALSE;
 		}
+	}
+
+	/* length, 16-bit address, type */
+	addr = ((guint32) rec[1] << 8) | rec[2];
+	record_type = rec[3];
+	addr += helper->seg_addr;
+	addr += helper->abs_addr;
+
+	/* the addresses are only valid if the record has enough data */
+	if ((record_type == DFU_INHX32_RECORD_TYPE_EXTENDED_LINEAR ||
+	     record_type == DFU_INHX32_RECORD_TYPE_EXTENDED_SEGMENT) && byte_cnt < 2) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "line %u too short for %s",
+			     ln, fu_ihex_firmware_record_type_to_string (record_type));
+		return FALSE;
+	}
+	if ((record_type == DFU_INHX32_RECORD_TYPE_START_LINEAR ||
+	     record_type == DFU_INHX32_RECORD_TYPE_START_SEGMENT) && byte_cnt < 4) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "line %u too short for %s",
+			     ln, fu_ihex_firmware_record_type_to_string (record_type));
+		return FALSE;
+	}
+
+	/* process different record types */
+	switch (record_type) {
+	case DFU_INHX32_RECORD_TYPE_DATA:
+		/* base address for element */
+		if (helper->img_addr == G_MAXUINT32)
+			helper->img_addr = addr;
 
-		/* length, 16-bit address, type */
-		byte_cnt = fu_firmware_strparse_uint8 (line + 1);
-		addr = fu_firmware_strparse_uint16 (line + 3);
-		record_type = fu_firmware_strparse_uint8 (line + 7);
-		g_debug ("%s:", fu_ihex_firmware_record_type_to_string (record_type));
-		g_debug ("  addr_start:\t0x%04x", addr);
-		g_debug ("  length:\t0x%02x", byte_cnt);
-		addr += seg_addr;
-		addr += abs_addr;
-		g_debug ("  addr:\t0x%08x", addr);
-
-		/* position of checksum */
-		line_end = 9 + byte_cnt * 2;
-		if (line_end > (guint) rcd->buf->len) {
+		/* does not make sense */
+		if (addr < helper->addr_last) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "line %u malformed, length: %u",
-				     rcd->ln, line_end);
+				     "invalid address 0x%x, last was 0x%x on line %u",
+				     (guint) addr,
+				     (guint) helper->addr_last,
+				     ln);
 			return FALSE;
 		}
+		if (byte_cnt == 0)
+			break;
 
-		/* verify checksum */
-		if ((flags & FWUPD_INSTALL_FLAG_FORCE) == 0) {
-			guint8 checksum = 0;
-			for (guint i = 1; i < line_end + 2; i += 2) {
-				guint8 data_tmp = fu_firmware_strparse_uint8 (line + i);
-				checksum += data_tmp;
-			}
-			if (checksum != 0)  {
+		/* any holes in the hex record */
+		if (helper->addr_last > 0) {
+			guint32 len_hole = addr - helper->addr_last;
+			if (len_hole > 0x100000) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
-					     "line %u has invalid checksum (0x%02x)",
-					     rcd->ln, checksum);
+					     "hole of 0x%x bytes too large to fill on line %u",
+					     (guint) len_hole,
+					     ln);
 				return FALSE;
 			}
+			if (len_hole > 1) {
+				g_debug ("filling address 0x%08x to 0x%08x on line %u",
+					 helper->addr_last + 1,
+					 helper->addr_last + len_hole - 1,
+					 ln);
+				/* although 0xff might be clearer,
+				 * we can't write 0xffff to pic14 */
+				for (guint j = 1; j < len_hole; j++)
+					fu_byte_array_append_uint8 (helper->buf, 0x00);
+			}
 		}
 
-		/* process different record types */
-		switch (record_type) {
-		case DFU_INHX32_RECORD_TYPE_DATA:
-			/* base address for element */
-			if (img_addr == G_MAXUINT32)
-				img_addr = addr;
-
-			/* does not make sense */
-			if (addr < addr_last) {
-				g_set_error (error,
+		/* write into buf */
+		g_byte_array_append (helper->buf, rec_data, byte_cnt);
+		helper->addr_last = addr + byte_cnt - 1;
+		break;
+	case DFU_INHX32_RECORD_TYPE_EOF:
+		if (helper->got_eof) {
+			g_set_error_literal (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
-					     "invalid address 0x%x, last was 0x%x on line %u",
-					     (guint) addr,
-					     (guint) addr_last,
-					     rcd->ln);
-				return FALSE;
-			}
-
-			/* parse bytes from line */
-			g_debug ("writing data 0x%08x", (guint32) addr);
-			for (guint i = 9; i < line_end; i += 2) {
-				/* any holes in the hex record */
-				guint32 len_hole = addr - addr_last;
-				guint8 data_tmp;
-				if (addr_last > 0 && len_hole > 0x100000) {
-					g_set_error (error,
-						     FWUPD_ERROR,
-						     FWUPD_ERROR_INVALID_FILE,
-						     "hole of 0x%x bytes too large to fill on line %u",
-						     (guint) len_hole,
-						     rcd->ln);
-					return FALSE;
-				}
-				if (addr_last > 0x0 && len_hole > 1) {
-					g_debug ("filling address 0x%08x to 0x%08x on line %u",
-						 addr_last + 1, addr_last + len_hole - 1, rcd->ln);
-					for (guint j = 1; j < len_hole; j++) {
-						/* although 0xff might be clearer,
-						 * we can't write 0xffff to pic14 */
-						fu_byte_array_append_uint8 (buf, 0x00);
-					}
-				}
-				/* write into buf */
-				data_tmp = fu_firmware_strparse_uint8 (line + i);
-				fu_byte_array_append_uint8 (buf, (gchar) data_tmp);
-				addr_last = addr++;
-			}
-			break;
-		case DFU_INHX32_RECORD_TYPE_EOF:
-			if (got_eof) {
-				g_set_error_literal (error,
-						     FWUPD_ERROR,
-						     FWUPD_ERROR_INVALID_FILE,
-						     "duplicate EOF, perhaps "
-						     "corrupt file");
-				return FALSE;
-			}
-			got_eof = TRUE;
-			break;
-		case DFU_INHX32_RECORD_TYPE_EXTENDED_LINEAR:
-			abs_addr = fu_firmware_strparse_uint16 (line + 9) << 16;
-			g_debug ("  abs_addr:\t0x%02x on line %u", abs_addr, rcd->ln);
-			break;
-		case DFU_INHX32_RECORD_TYPE_START_LINEAR:
-			abs_addr = fu_firmware_strparse_uint32 (line + 9);
-			g_debug ("  abs_addr:\t0x%08x on line %u", abs_addr, rcd->ln);
-			break;
-		case DFU_INHX32_RECORD_TYPE_EXTENDED_SEGMENT:
-			/* segment base address, so ~1Mb addressable */
-			seg_addr = fu_firmware_strparse_uint16 (line + 9) * 16;
-			g_debug ("  seg_addr:\t0x%08x on line %u", seg_addr, rcd->ln);
-			break;
-		case DFU_INHX32_RECORD_TYPE_START_SEGMENT:
-			/* initial content of the CS:IP registers */
-			seg_addr = fu_firmware_strparse_uint32 (line + 9);
-			g_debug ("  seg_addr:\t0x%02x on line %u", seg_addr, rcd->ln);
-			break;
-		case DFU_INHX32_RECORD_TYPE_SIGNATURE:
-			for (guint i = 9; i < line_end; i += 2) {
-				guint8 tmp_c = fu_firmware_strparse_uint8 (line + i);
-				fu_byte_array_append_uint8 (buf_signature, tmp_c);
-			}
-			break;
-		default:
-			/* vendors sneak in nonstandard sections past the EOF */
-			if (got_eof)
-				break;
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid ihex record type %i on line %u",
-				     record_type, rcd->ln);
+					     "duplicate EOF, perhaps "
+					     "corrupt file");
 			return FALSE;
 		}
+		helper->got_eof = TRUE;
+		break;
+	case DFU_INHX32_RECORD_TYPE_EXTENDED_LINEAR:
+		helper->abs_addr = (((guint32) rec_data[0] << 8) | rec_data[1]) << 16;
+		g_debug ("  abs_addr:\t0x%02x on line %u", helper->abs_addr, ln);
+		break;
+	case DFU_INHX32_RECORD_TYPE_START_LINEAR:
+		helper->abs_addr = fu_common_read_uint32 (rec_data, G_BIG_ENDIAN);
+		g_debug ("  abs_addr:\t0x%08x on line %u", helper->abs_addr, ln);
+		break;
+	case DFU_INHX32_RECORD_TYPE_EXTENDED_SEGMENT:
+		/* segment base address, so ~1Mb addressable */
+		helper->seg_addr = (((guint32) rec_data[0] << 8) | rec_data[1]) * 16;
+		g_debug ("  seg_addr:\t0x%08x on line %u", helper->seg_addr, ln);
+		break;
+	case DFU_INHX32_RECORD_TYPE_START_SEGMENT:
+		/* initial content of the CS:IP registers */
+		helper->seg_addr = fu_common_read_uint32 (rec_data, G_BIG_ENDIAN);
+		g_debug ("  seg_addr:\t0x%02x on line %u", helper->seg_addr, ln);
+		break;
+	case DFU_INHX32_RECORD_TYPE_SIGNATURE:
+		g_byte_array_append (helper->buf_signature, rec_data, byte_cnt);
+		break;
+	default:
+		/* vendors sneak in nonstandard sections past the EOF */
+		if (helper->got_eof)
+			break;
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid ihex record type %u on line %u",
+			     (guint) record_type, ln);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_ihex_firmware_parse (FuFirmware *firmware,
+			GBytes *fw,
+			guint64 addr_start,
+			guint64 addr_end,
+			FwupdInstallFlags flags,
+			GError **error)
+{
+	const gchar *data;
+	const gchar *line = NULL;
+	const gchar *nul;
+	gsize datasz = 0;
+	gsize linesz = 0;
+	gsize offset = 0;
+	FuIhexFirmwareParseHelper helper = {
+		.flags = flags,
+		.img_addr = G_MAXUINT32,
+	};
+	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (NULL);
+	g_autoptr(GBytes) img_bytes = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GByteArray) buf_signature = g_byte_array_new ();
+
+	/* like the tokenizer, nothing after an embedded NUL is used */
+	data = g_bytes_get_data (fw, &datasz);
+	nul = datasz > 0 ? memchr (data, '\0', datasz) : NULL;
+	if (nul != NULL)
+		datasz = (gsize) (nul - data);
+
+	/* size the image from a pre-scan of the data records, so the buffer is
+	 * only reallocated if there are holes to fill */
+	buf = g_byte_array_sized_new (fu_ihex_firmware_get_data_size (data, datasz));
+	helper.buf = buf;
+	helper.buf_signature = buf_signature;
+
+	/* parse records in a single pass over the raw buffer */
+	for (guint ln = 1; fu_ihex_firmware_next_line (data, datasz, &offset, &line, &linesz); ln++) {
+		if (!fu_ihex_firmware_parse_line (&helper, line, linesz, ln, error))
+			return FALSE;
 	}
 
 	/* no EOF */
-	if (!got_eof) {
+	if (!helper.got_eof) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
@@ -318,10 +454,10 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 	}
 
 	/* add single image */
-	img_bytes = g_bytes_new (buf->data, buf->len);
+	img_bytes = g_byte_array_free_to_bytes (g_steal_pointer (&buf));
 	fu_firmware_image_set_bytes (img, img_bytes);
-	if (img_addr != G_MAXUINT32)
-		fu_firmware_image_set_addr (img, img_addr);
+	if (helper.img_addr != G_MAXUINT32)
+		fu_firmware_image_set_addr (img, helper.img_addr);
 	fu_firmware_add_image (firmware, img);
 
 	/* add optional signature */
@@ -425,6 +561,8 @@ fu_ihex_firmware_finalize (GObject *object)
 {
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE (object);
 	g_ptr_array_unref (self->records);
+	if (self->fw != NULL)
+		g_bytes_unref (self->fw);
 	G_OBJECT_CLASS (fu_ihex_firmware_parent_class)->finalize (object);
 }
 
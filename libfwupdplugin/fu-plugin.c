@@ -17,6 +17,7 @@
 #include <valgrind.h>
 #endif /* HAVE_VALGRIND */
 
+#include "fu-common-checksum.h"
 #include "fu-device-private.h"
 #include "fu-plugin-private.h"
 #include "fu-mutex.h"
@@ -1033,10 +1034,11 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 	g_autoptr(FuDeviceLocker) locker = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
 	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GPtrArray) hashes = NULL;
 	GChecksumType checksum_types[] = {
 		G_CHECKSUM_SHA1,
 		G_CHECKSUM_SHA256,
-		0 };
+	};
 	locker = fu_device_locker_new (device, error);
 	if (locker == NULL)
 		return FALSE;
@@ -1058,11 +1060,10 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 		g_prefix_error (error, "failed to write firmware: ");
 		return FALSE;
 	}
-	for (guint i = 0; checksum_types[i] != 0; i++) {
-		g_autofree gchar *hash = NULL;
-		hash = g_compute_checksum_for_bytes (checksum_types[i], fw);
-		fu_device_add_checksum (device, hash);
-	}
+	hashes = fu_common_checksums_for_bytes (fw, checksum_types,
+						G_N_ELEMENTS (checksum_types));
+	for (guint i = 0; i < hashes->len; i++)
+		fu_device_add_checksum (device, g_ptr_array_index (hashes, i));
 	return fu_device_attach (device, error);
 }
 
@@ -1648,7 +1649,11 @@ fu_plugin_check_supported_device (FuPlugin *self, FuDevice *device)
 	GPtrArray *instance_ids = fu_device_get_instance_ids (device);
 	for (guint i = 0; i < instance_ids->len; i++) {
 		const gchar *instance_id = g_ptr_array_index (instance_ids, i);
-		g_autofree gchar *guid = fwupd_guid_hash_string (instance_id);
+		gchar guid[FWUPD_GUID_STRING_SIZE];
+		if (instance_id[0] == '\0')
+			continue;
+		fwupd_guid_hash_data_to_buf ((const guint8 *) instance_id, strlen (instance_id),
+					     FWUPD_GUID_FLAG_NONE, guid);
 		if (fu_plugin_check_supported (self, guid))
 			return TRUE;
 	}
@@ -393,6 +393,22 @@ fu_quirks_load (FuQuirks *self, FuQuirksLoadFlags load_flags, GError **error)
 	return fu_quirks_check_silo (self, error);
 }
 
+/**
+ * fu_quirks_unload:
+ * @self: A #FuQuirks
+ *
+ * Drops the compiled quirk database to save memory. It is loaded again
+ * automatically the next time a quirk is looked up.
+ *
+ * Since: 1.5.0
+ **/
+void
+fu_quirks_unload (FuQuirks *self)
+{
+	g_return_if_fail (FU_IS_QUIRKS (self));
+	g_clear_object (&self->silo);
+}
+
 static void
 fu_quirks_class_init (FuQuirksClass *klass)
 {
@@ -35,6 +35,7 @@ FuQuirks	*fu_quirks_new				(void);
 gboolean	 fu_quirks_load				(FuQuirks	*self,
 							 FuQuirksLoadFlags load_flags,
 							 GError		**error);
+void		 fu_quirks_unload			(FuQuirks	*self);
 const gchar	*fu_quirks_lookup_by_id			(FuQuirks	*self,
 							 const gchar	*group,
 							 const gchar	*key);
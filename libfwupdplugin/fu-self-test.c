@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: LGPL-2.1+
  */
 
+/* for memfd_create() */
+#define _GNU_SOURCE
+
 #include "config.h"
 
 #include <xmlb.h>
@@ -11,7 +14,15 @@
 #include <fwupdplugin.h>
 #include <libgcab.h>
 #include <glib/gstdio.h>
+#ifdef HAVE_GIO_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 
+#include "fu-cabinet.h"
 #include "fu-device-private.h"
 #include "fu-plugin-private.h"
 #include "fu-smbios-private.h"
@@ -265,6 +276,54 @@ fu_smbios3_func (void)
 	g_assert_cmpstr (str, ==, "Dell Inc.");
 }
 
+static void
+fu_smbios_truncated_func (void)
+{
+	gboolean ret;
+	const guint8 buf_hdr[] = { 0x00, 0x10 };
+	const guint8 buf_len[] = { 0x00, 0x04, 0x01, 0x00 };
+	const guint8 buf_end[] = { 0x00, 0x04, 0x01, 0x00, 0x00 };
+	const guint8 buf_pad[] = { 0x01, 0x04, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	const guint8 buf_pad_short[] = { 0x00 };
+	g_autoptr(FuSmbios) smbios1 = fu_smbios_new ();
+	g_autoptr(FuSmbios) smbios2 = fu_smbios_new ();
+	g_autoptr(FuSmbios) smbios3 = fu_smbios_new ();
+	g_autoptr(FuSmbios) smbios4 = fu_smbios_new ();
+	g_autoptr(FuSmbios) smbios5 = fu_smbios_new ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* structure header is incomplete */
+	ret = fu_smbios_setup_from_data (smbios1, buf_hdr, sizeof(buf_hdr), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+	g_clear_error (&error);
+
+	/* structure is longer than the buffer */
+	ret = fu_smbios_setup_from_data (smbios2, buf_len, sizeof(buf_len), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+	g_clear_error (&error);
+
+	/* string table is cut short */
+	ret = fu_smbios_setup_from_data (smbios3, buf_end, sizeof(buf_end), &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	/* table padded with fewer zeros than a structure header */
+	ret = fu_smbios_setup_from_data (smbios4, buf_pad, sizeof(buf_pad), &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	blob = fu_smbios_get_data (smbios4, 0x01, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob);
+
+	/* a single zero byte is not read past */
+	ret = fu_smbios_setup_from_data (smbios5, buf_pad_short, sizeof(buf_pad_short), &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+}
+
 static void
 fu_hwids_func (void)
 {
@@ -455,6 +514,26 @@ fu_plugin_quirks_device_func (void)
 	g_assert (fu_device_has_flag (device_tmp, FWUPD_DEVICE_FLAG_UPDATABLE));
 }
 
+static void
+fu_device_instance_id_empty_func (void)
+{
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuDevice) donor = fu_device_new ();
+
+	/* an empty instance ID never becomes a GUID */
+	fu_device_add_instance_id (device, "");
+	fu_device_add_instance_id (device, "USB\\VID_0BDA&PID_1100");
+	fu_device_convert_instance_ids (device);
+	g_assert_cmpint (fu_device_get_guids(device)->len, ==, 1);
+	g_assert_true (fu_device_has_guid (device, "USB\\VID_0BDA&PID_1100"));
+	g_assert_false (fu_device_has_guid (device, ""));
+
+	/* or is used to match quirks */
+	fu_device_add_instance_id (donor, "");
+	fu_device_incorporate (device, donor);
+	g_assert_cmpint (fu_device_get_guids(device)->len, ==, 1);
+}
+
 static void fu_common_kernel_lockdown_func (void)
 {
 	gboolean ret;
@@ -696,14 +775,151 @@ _build_cab (GCabCompression compression, ...)
 	return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (op));
 }
 
+static void
+fu_common_delta_func (void)
+{
+	gsize delta_sz;
+	gsize target_size = 0;
+	g_autofree gchar *source_checksum = NULL;
+	g_autofree gchar *target_checksum = NULL;
+	g_autoptr(GByteArray) src = g_byte_array_new ();
+	g_autoptr(GByteArray) dst = g_byte_array_new ();
+	g_autoptr(GBytes) blob_delta = NULL;
+	g_autoptr(GBytes) blob_delta_bad = NULL;
+	g_autoptr(GBytes) blob_dst = NULL;
+	g_autoptr(GBytes) blob_out = NULL;
+	g_autoptr(GBytes) blob_out_bad = NULL;
+	g_autoptr(GBytes) blob_src = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GRand) rand = g_rand_new_with_seed (0xdead);
+
+	/* the new image has a changed byte, some inserted data and a
+	 * region moved to a different offset */
+	for (guint i = 0; i < 0x4000; i++)
+		fu_byte_array_append_uint8 (src, g_rand_int_range (rand, 0x00, 0x100));
+	g_byte_array_append (dst, src->data + 0x2000, 0x1000);
+	g_byte_array_append (dst, src->data, 0x2000);
+	dst->data[0x1800] ^= 0xff;
+	g_byte_array_append (dst, (const guint8 *) "hello world", 11);
+	g_byte_array_append (dst, src->data + 0x3000, 0x1000);
+	blob_src = g_bytes_new (src->data, src->len);
+	blob_dst = g_bytes_new (dst->data, dst->len);
+
+	/* generate */
+	blob_delta = fu_common_delta_generate (blob_src, blob_dst, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_delta);
+	delta_sz = g_bytes_get_size (blob_delta);
+	g_debug ("delta is %" G_GSIZE_FORMAT " bytes", delta_sz);
+	g_assert_cmpint (delta_sz, <, 0x200);
+	g_assert_true (fu_common_delta_parse_header (blob_delta,
+						     &source_checksum,
+						     &target_checksum,
+						     &target_size,
+						     &error));
+	g_assert_no_error (error);
+	g_assert_cmpint (target_size, ==, dst->len);
+	g_assert_cmpint (strlen (source_checksum), ==, 64);
+	g_assert_cmpstr (source_checksum, !=, target_checksum);
+
+	/* apply */
+	blob_out = fu_common_delta_apply (blob_src, blob_delta, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_out);
+	g_assert_true (g_bytes_equal (blob_out, blob_dst));
+
+	/* wrong installed image */
+	blob_out_bad = fu_common_delta_apply (blob_dst, blob_delta, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null (blob_out_bad);
+	g_clear_error (&error);
+
+	/* truncated */
+	blob_delta_bad = g_bytes_new_from_bytes (blob_delta, 0, delta_sz - 5);
+	blob_out_bad = fu_common_delta_apply (blob_src, blob_delta_bad, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_null (blob_out_bad);
+}
+
+static void
+fu_common_store_cab_delta_func (void)
+{
+	GBytes *blob_tmp;
+	gboolean ret;
+	const gchar *xml =
+	"<component type=\"firmware\">\n"
+	"  <id>com.acme.example.firmware</id>\n"
+	"  <releases>\n"
+	"    <release version=\"1.2.3\">\n"
+	"      <size type=\"installed\">5</size>\n"
+	"      <checksum filename=\"firmware.bin\" target=\"content\"/>\n"
+	"    </release>\n"
+	"  </releases>\n"
+	"</component>";
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_delta = NULL;
+	g_autoptr(GBytes) blob_new = g_bytes_new_static ("world", 5);
+	g_autoptr(GBytes) blob_old = g_bytes_new_static ("hello", 5);
+	g_autoptr(GBytes) blob_xml = g_bytes_new_static (xml, strlen (xml));
+	g_autoptr(GCabCabinet) cabinet = gcab_cabinet_new ();
+	g_autoptr(GCabFile) cabfile_delta = NULL;
+	g_autoptr(GCabFile) cabfile_xml = NULL;
+	g_autoptr(GCabFolder) cabfolder = gcab_folder_new (GCAB_COMPRESSION_NONE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOutputStream) op = g_memory_output_stream_new_resizable ();
+	g_autoptr(XbNode) rel = NULL;
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* create an archive with just the delta */
+	blob_delta = fu_common_delta_generate (blob_old, blob_new, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_delta);
+	ret = gcab_cabinet_add_folder (cabinet, cabfolder, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	cabfile_xml = gcab_file_new_with_bytes ("acme.metainfo.xml", blob_xml);
+	ret = gcab_folder_add_file (cabfolder, cabfile_xml, FALSE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	cabfile_delta = gcab_file_new_with_bytes ("firmware.bin.delta", blob_delta);
+	ret = gcab_folder_add_file (cabfolder, cabfile_delta, FALSE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = gcab_cabinet_write_simple (cabinet, op, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_output_stream_close (op, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	blob = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (op));
+
+	/* the installed size is checked against the reconstructed image */
+	silo = fu_common_cab_build_silo (blob, 10240, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo);
+	rel = xb_silo_query_first (silo, "components/component/releases/release", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rel);
+	ret = fu_cabinet_load_release (rel, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_null (xb_node_get_data (rel, "fwupd::FirmwareBlob"));
+	blob_tmp = xb_node_get_data (rel, "fwupd::FirmwareDelta");
+	g_assert_nonnull (blob_tmp);
+	g_assert_true (g_bytes_equal (blob_tmp, blob_delta));
+}
+
 static void
 fu_common_store_cab_func (void)
 {
 	GBytes *blob_tmp;
+	gboolean ret;
+	g_autofree gchar *checksum_sha256 = NULL;
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(XbNode) component = NULL;
 	g_autoptr(XbNode) csum = NULL;
+	g_autoptr(XbNode) csum_sha256 = NULL;
 	g_autoptr(XbNode) rel = NULL;
 	g_autoptr(XbNode) req = NULL;
 	g_autoptr(XbSilo) silo = NULL;
@@ -746,6 +962,14 @@ fu_common_store_cab_func (void)
 	csum = xb_node_query_first (rel, "checksum[@target='content']", &error);
 	g_assert_nonnull (csum);
 	g_assert_cmpstr (xb_node_get_text (csum), ==, "7c211433f02071597741e6ff5a8ea34789abbf43");
+	csum_sha256 = xb_node_query_first (rel, "checksum[@target='container'][@type='sha256']", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (csum_sha256);
+	checksum_sha256 = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+	g_assert_cmpstr (xb_node_get_text (csum_sha256), ==, checksum_sha256);
+	ret = fu_cabinet_load_release (rel, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
 	blob_tmp = xb_node_get_data (rel, "fwupd::FirmwareBlob");
 	g_assert_nonnull (blob_tmp);
 	req = xb_node_query_first (component, "requires/id", &error);
@@ -757,6 +981,7 @@ static void
 fu_common_store_cab_unsigned_func (void)
 {
 	GBytes *blob_tmp;
+	gboolean ret;
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(XbNode) component = NULL;
@@ -789,6 +1014,9 @@ fu_common_store_cab_unsigned_func (void)
 	g_assert_cmpstr (xb_node_get_attr (rel, "version"), ==, "1.2.3");
 	csum = xb_node_query_first (rel, "checksum[@target='content']", &error);
 	g_assert_null (csum);
+	ret = fu_cabinet_load_release (rel, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
 	blob_tmp = xb_node_get_data (rel, "fwupd::FirmwareBlob");
 	g_assert_nonnull (blob_tmp);
 }
@@ -797,6 +1025,7 @@ static void
 fu_common_store_cab_folder_func (void)
 {
 	GBytes *blob_tmp;
+	gboolean ret;
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(XbNode) component = NULL;
@@ -826,10 +1055,93 @@ fu_common_store_cab_folder_func (void)
 	g_assert_no_error (error);
 	g_assert_nonnull (rel);
 	g_assert_cmpstr (xb_node_get_attr (rel, "version"), ==, "1.2.3");
+	ret = fu_cabinet_load_release (rel, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
 	blob_tmp = xb_node_get_data (rel, "fwupd::FirmwareBlob");
 	g_assert_nonnull (blob_tmp);
 }
 
+static void
+fu_common_store_cab_multiple_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuCabinet) cabinet = fu_cabinet_new ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) rel1 = NULL;
+	g_autoptr(XbNode) rel2 = NULL;
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* one archive for two variants of the device */
+	blob = _build_cab (GCAB_COMPRESSION_MSZIP,
+			   "acme.metainfo.xml",
+	"<component type=\"firmware\">\n"
+	"  <id>com.acme.example.firmware</id>\n"
+	"  <releases>\n"
+	"    <release version=\"1.2.3\">\n"
+	"      <checksum filename=\"firmware1.bin\" target=\"content\" type=\"sha1\">7c211433f02071597741e6ff5a8ea34789abbf43</checksum>\n"
+	"    </release>\n"
+	"  </releases>\n"
+	"</component>",
+			   "acme2.metainfo.xml",
+	"<component type=\"firmware\">\n"
+	"  <id>com.acme.example2.firmware</id>\n"
+	"  <releases>\n"
+	"    <release version=\"4.5.6\">\n"
+	"      <size type=\"installed\">5</size>\n"
+	"      <checksum filename=\"firmware2.bin\" target=\"content\" type=\"sha1\">deadbeef</checksum>\n"
+	"    </release>\n"
+	"  </releases>\n"
+	"</component>",
+			   "firmware1.bin", "world",
+			   "firmware2.bin", "hello",
+			   NULL);
+	ret = fu_cabinet_parse (cabinet, blob, FU_CABINET_PARSE_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	silo = fu_cabinet_get_silo (cabinet);
+	g_assert_nonnull (silo);
+	rel1 = xb_silo_query_first (silo, "components/component/id[text()='com.acme.example.firmware']/../releases/release", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rel1);
+	rel2 = xb_silo_query_first (silo, "components/component/id[text()='com.acme.example2.firmware']/../releases/release", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rel2);
+
+	/* nothing is decompressed until the release is used */
+	g_assert_null (xb_node_get_data (rel1, "fwupd::FirmwareBlob"));
+	g_assert_null (xb_node_get_data (rel2, "fwupd::FirmwareBlob"));
+	ret = fu_cabinet_load_release (rel1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_nonnull (xb_node_get_data (rel1, "fwupd::FirmwareBlob"));
+	g_assert_null (xb_node_get_data (rel2, "fwupd::FirmwareBlob"));
+
+	/* loading again is a no-op */
+	ret = fu_cabinet_load_release (rel1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* the other payload is only verified when used */
+	ret = fu_cabinet_load_release (rel2, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false (ret);
+	g_clear_error (&error);
+
+	/* any file can be decompressed on demand */
+	blob_tmp = fu_cabinet_get_file_by_name (cabinet, "firmware2.bin", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_tmp);
+	g_assert_cmpint (g_bytes_get_size (blob_tmp), ==, 5);
+	g_assert_cmpint (memcmp (g_bytes_get_data (blob_tmp, NULL), "hello", 5), ==, 0);
+	g_clear_pointer (&blob_tmp, g_bytes_unref);
+	blob_tmp = fu_cabinet_get_file_by_name (cabinet, "firmware3.bin", &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_tmp);
+}
+
 static void
 fu_common_store_cab_error_no_metadata_func (void)
 {
@@ -920,6 +1232,8 @@ fu_common_store_cab_error_size_func (void)
 static void
 fu_common_store_cab_error_wrong_checksum_func (void)
 {
+	gboolean ret;
+	g_autoptr(XbNode) rel = NULL;
 	g_autoptr(XbSilo) silo = NULL;
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
@@ -937,8 +1251,17 @@ fu_common_store_cab_error_wrong_checksum_func (void)
 			   "firmware.bin", "world",
 			   NULL);
 	silo = fu_common_cab_build_silo (blob, 10240, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo);
+
+	/* the payload is only verified when it is used */
+	rel = xb_silo_query_first (silo, "components/component/releases/release", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rel);
+	ret = fu_cabinet_load_release (rel, &error);
 	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
-	g_assert_null (silo);
+	g_assert_false (ret);
+	g_assert_null (xb_node_get_data (rel, "fwupd::FirmwareBlob"));
 }
 
 static gboolean
@@ -1108,6 +1431,388 @@ fu_chunk_func (void)
 					   "#05: page:02 addr:0004 len:02 ZZ\n");
 }
 
+/* the byte-at-a-time implementation from before fu_chunk_iter_next() */
+static GPtrArray *
+fu_chunk_array_new_reference (const guint8 *data,
+			      guint32 data_sz,
+			      guint32 addr_start,
+			      guint32 page_sz,
+			      guint32 packet_sz)
+{
+	GPtrArray *segments = g_ptr_array_new_with_free_func (g_free);
+	guint32 page_old = G_MAXUINT32;
+	guint32 idx;
+	guint32 last_flush = 0;
+
+	for (idx = 1; idx < data_sz; idx++) {
+		guint32 page = 0;
+		if (page_sz > 0)
+			page = (addr_start + idx) / page_sz;
+		if (page_old == G_MAXUINT32) {
+			page_old = page;
+		} else if (page != page_old) {
+			guint32 address_offset = addr_start + last_flush;
+			if (page_sz > 0)
+				address_offset %= page_sz;
+			g_ptr_array_add (segments,
+					 fu_chunk_new (segments->len, page_old, address_offset,
+						       data + last_flush, idx - last_flush));
+			last_flush = idx;
+			page_old = page;
+			continue;
+		}
+		if (packet_sz > 0 && idx - last_flush >= packet_sz) {
+			guint32 address_offset = addr_start + last_flush;
+			if (page_sz > 0)
+				address_offset %= page_sz;
+			g_ptr_array_add (segments,
+					 fu_chunk_new (segments->len, page, address_offset,
+						       data + last_flush, idx - last_flush));
+			last_flush = idx;
+		}
+	}
+	if (last_flush != idx) {
+		guint32 address_offset = addr_start + last_flush;
+		guint32 page = 0;
+		if (page_sz > 0) {
+			address_offset %= page_sz;
+			page = (addr_start + (idx - 1)) / page_sz;
+		}
+		g_ptr_array_add (segments,
+				 fu_chunk_new (segments->len, page, address_offset,
+					       data + last_flush, data_sz - last_flush));
+	}
+	return segments;
+}
+
+static void
+fu_chunk_assert_equal (FuChunk *chk1, FuChunk *chk2)
+{
+	g_assert_cmpint (chk1->idx, ==, chk2->idx);
+	g_assert_cmpint (chk1->page, ==, chk2->page);
+	g_assert_cmpint (chk1->address, ==, chk2->address);
+	g_assert (chk1->data == chk2->data);
+	g_assert_cmpint (chk1->data_sz, ==, chk2->data_sz);
+}
+
+static void
+fu_chunk_reference_check (const guint8 *buf,
+			  guint32 data_sz,
+			  guint32 addr_start,
+			  guint32 page_sz,
+			  guint32 packet_sz)
+{
+	FuChunk chk;
+	FuChunkIter iter;
+	guint i = 0;
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GPtrArray) chunks_ref = NULL;
+
+	chunks = fu_chunk_array_new (buf, data_sz, addr_start, page_sz, packet_sz);
+
+	/* the iterator returns exactly the same packets */
+	fu_chunk_iter_init (&iter, buf, data_sz, addr_start, page_sz, packet_sz);
+	while (fu_chunk_iter_next (&iter, &chk))
+		fu_chunk_assert_equal (&chk, g_ptr_array_index (chunks, i++));
+	g_assert_cmpint (i, ==, chunks->len);
+
+	/* the old code put the first byte on the wrong page when it was the
+	 * last byte of a page, so there is nothing to compare against */
+	if (page_sz > 0 && data_sz > 1 && (addr_start + 1) % page_sz == 0)
+		return;
+	chunks_ref = fu_chunk_array_new_reference (buf, data_sz, addr_start,
+						   page_sz, packet_sz);
+	g_assert_cmpint (chunks->len, ==, chunks_ref->len);
+	for (i = 0; i < chunks_ref->len; i++) {
+		fu_chunk_assert_equal (g_ptr_array_index (chunks, i),
+				       g_ptr_array_index (chunks_ref, i));
+	}
+}
+
+static void
+fu_chunk_reference_func (void)
+{
+	guint8 buf[64] = { 0x0 };
+	g_autofree gchar *str = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+
+	for (guint32 data_sz = 1; data_sz < sizeof(buf); data_sz++) {
+		for (guint32 addr_start = 0; addr_start < 20; addr_start++) {
+			for (guint32 page_sz = 0; page_sz <= 16; page_sz++) {
+				for (guint32 packet_sz = 0; packet_sz <= 8; packet_sz++) {
+					fu_chunk_reference_check (buf, data_sz, addr_start,
+								  page_sz, packet_sz);
+				}
+			}
+		}
+	}
+
+	/* a packet never crosses a page boundary */
+	chunks = fu_chunk_array_new ((const guint8 *) "123456", 6, 0x3, 4, 0);
+	str = fu_chunk_array_to_string (chunks);
+	g_assert_cmpstr (str, ==, "#00: page:00 addr:0003 len:01 1\n"
+				  "#01: page:01 addr:0000 len:04 2345\n"
+				  "#02: page:02 addr:0000 len:01 6\n");
+}
+
+static void
+fu_chunk_benchmark_func (void)
+{
+	const guint32 bufsz = 16 * 1024 * 1024;
+	FuChunk chk;
+	FuChunkIter iter;
+	guint32 total = 0;
+	g_autofree guint8 *buf = g_malloc0 (bufsz);
+	g_autoptr(GPtrArray) chunks_ref = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* a large SPI image sent in HID-sized reports */
+	chunks_ref = fu_chunk_array_new_reference (buf, bufsz, 0x0, 0x1000, 60);
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "byte-at-a-time chunking into %u packets",
+				 chunks_ref->len);
+
+	g_timer_reset (timer);
+	chunks = fu_chunk_array_new (buf, bufsz, 0x0, 0x1000, 60);
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "arithmetic chunking into %u packets",
+				 chunks->len);
+
+	g_timer_reset (timer);
+	fu_chunk_iter_init (&iter, buf, bufsz, 0x0, 0x1000, 60);
+	while (fu_chunk_iter_next (&iter, &chk))
+		total += chk.data_sz;
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "iterated over %u bytes", total);
+	g_assert_cmpint (total, ==, bufsz);
+}
+
+static void
+fu_common_bytes_func (void)
+{
+	gboolean ret;
+	guint8 buf1[0x3000];
+	guint8 buf2[0x3000];
+	g_autoptr(GBytes) blob_align = NULL;
+	g_autoptr(GBytes) blob_pad = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* empty, with a programmed byte in every position of short buffers */
+	memset (buf1, 0xff, sizeof(buf1));
+	for (gsize sz = 0; sz < 200; sz++) {
+		g_autoptr(GBytes) blob_tmp = g_bytes_new (buf1, sz);
+		g_assert_true (fu_common_bytes_is_empty (blob_tmp));
+		for (gsize i = 0; i < sz; i++) {
+			g_autoptr(GBytes) blob_prog = NULL;
+			buf1[i] = 0xfe;
+			blob_prog = g_bytes_new (buf1, sz);
+			g_assert_false (fu_common_bytes_is_empty (blob_prog));
+			buf1[i] = 0xff;
+		}
+	}
+
+	/* first mismatch is reported, in any block */
+	for (guint i = 0; i < sizeof(buf1); i++)
+		buf1[i] = buf2[i] = (guint8) i;
+	ret = fu_common_bytes_compare_raw (buf1, sizeof(buf1), buf2, sizeof(buf2), &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	buf1[0x2fff] = 0x00;
+	buf1[0x2222] = 0x00;
+	ret = fu_common_bytes_compare_raw (buf1, sizeof(buf1), buf2, sizeof(buf2), &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_cmpstr (error->message, ==, "got 0x00, expected 0x22 @ 0x2222");
+	g_assert_false (ret);
+	g_clear_error (&error);
+	buf1[0x1001] = 0x00;
+	ret = fu_common_bytes_compare_raw (buf1, sizeof(buf1), buf2, sizeof(buf2), &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_cmpstr (error->message, ==, "got 0x00, expected 0x01 @ 0x1001");
+	g_assert_false (ret);
+	g_clear_error (&error);
+
+	/* already aligned or padded, so not copied */
+	blob = g_bytes_new (buf1, 0x1000);
+	blob_align = fu_common_bytes_align (blob, 0x400, 0xff);
+	g_assert_true (blob_align == blob);
+	blob_pad = fu_common_bytes_pad (blob, 0x1000);
+	g_assert_true (blob_pad == blob);
+}
+
+static void
+fu_common_bytes_benchmark_func (void)
+{
+	for (gsize sz = 64 * 1024; sz <= 64 * 1024 * 1024; sz *= 8) {
+		g_autofree guint8 *buf1 = g_malloc (sz);
+		g_autofree guint8 *buf2 = g_malloc (sz);
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GTimer) timer = NULL;
+
+		/* worst case: the entire buffer has to be checked */
+		memset (buf1, 0xff, sz);
+		memset (buf2, 0xff, sz);
+		blob = g_bytes_new_static (buf1, sz);
+		timer = g_timer_new ();
+		for (guint i = 0; i < 10; i++)
+			g_assert_true (fu_common_bytes_is_empty (blob));
+		g_test_minimized_result (g_timer_elapsed (timer, NULL),
+					 "checked 0x%x bytes were empty 10 times", (guint) sz);
+		g_timer_reset (timer);
+		for (guint i = 0; i < 10; i++)
+			g_assert_true (fu_common_bytes_compare_raw (buf1, sz, buf2, sz, NULL));
+		g_test_minimized_result (g_timer_elapsed (timer, NULL),
+					 "compared 0x%x bytes 10 times", (guint) sz);
+	}
+}
+
+/* the byte-at-a-time loop that plugins used to carry */
+static guint32
+fu_test_crc32_bytewise (const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	for (gsize i = 0; i < bufsz; i++) {
+		crc ^= buf[i];
+		for (guint j = 0; j < 8; j++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+	}
+	return crc;
+}
+
+static void
+fu_common_crc_func (void)
+{
+	const guint8 *check = (const guint8 *) "123456789";
+	guint8 buf[0x1000];
+	guint32 crc;
+
+	/* check values from the CRC catalogue */
+	g_assert_cmpint (fu_common_crc32 (FU_CRC_KIND_B32_STANDARD, check, 9), ==, 0xcbf43926);
+	g_assert_cmpint (fu_common_crc32 (FU_CRC_KIND_B32_JAMCRC, check, 9), ==, 0x340bc6d9);
+	g_assert_cmpint (fu_common_crc32 (FU_CRC_KIND_B32_MPEG2, check, 9), ==, 0x0376e6e7);
+	g_assert_cmpint (fu_common_crc16 (FU_CRC_KIND_B16_USB, check, 9), ==, 0xb4c8);
+	g_assert_cmpint (fu_common_crc16 (FU_CRC_KIND_B16_UMTS, check, 9), ==, 0xfee8);
+	g_assert_cmpint (fu_common_crc8 (FU_CRC_KIND_B8_SMBUS, check, 9), ==, 0xf4);
+	g_assert_cmpint (fu_common_crc8 (FU_CRC_KIND_B8_DVB_S2, check, 9), ==, 0xbc);
+	g_assert_cmpint (fu_common_crc8 (FU_CRC_KIND_B8_WACOM, check, 9), ==, 0x45);
+	g_assert_cmpstr (fu_common_crc_kind_to_string (FU_CRC_KIND_B16_USB), ==, "b16-usb");
+
+	/* streaming */
+	crc = fu_common_crc32_init (FU_CRC_KIND_B32_STANDARD);
+	crc = fu_common_crc32_step (FU_CRC_KIND_B32_STANDARD, check, 4, crc);
+	crc = fu_common_crc32_step (FU_CRC_KIND_B32_STANDARD, check + 4, 5, crc);
+	g_assert_cmpint (fu_common_crc32_done (FU_CRC_KIND_B32_STANDARD, crc), ==, 0xcbf43926);
+
+	/* every length and alignment of the accelerated paths */
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8) (i * 131 + 7);
+	for (gsize off = 0; off < 8; off++) {
+		for (gsize sz = 0; sz < 300; sz++) {
+			crc = fu_common_crc32_step (FU_CRC_KIND_B32_JAMCRC, buf + off, sz, 0x12345678);
+			g_assert_cmpint (crc, ==, fu_test_crc32_bytewise (buf + off, sz, 0x12345678));
+		}
+	}
+	crc = fu_common_crc32_step (FU_CRC_KIND_B32_JAMCRC, buf, sizeof(buf), 0xffffffff);
+	g_assert_cmpint (crc, ==, fu_test_crc32_bytewise (buf, sizeof(buf), 0xffffffff));
+}
+
+static void
+fu_common_crc_benchmark_func (void)
+{
+	gsize sz = 16 * 1024 * 1024;
+	guint32 crc1;
+	guint32 crc2;
+	g_autofree guint8 *buf = g_malloc (sz);
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	for (gsize i = 0; i < sz; i++)
+		buf[i] = (guint8) i;
+	crc1 = fu_test_crc32_bytewise (buf, sz, 0xffffffff) ^ 0xffffffff;
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "bytewise CRC-32 of 0x%x bytes", (guint) sz);
+	g_timer_reset (timer);
+	crc2 = fu_common_crc32 (FU_CRC_KIND_B32_STANDARD, buf, sz);
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "fu_common_crc32() of 0x%x bytes", (guint) sz);
+	g_assert_cmpint (crc1, ==, crc2);
+	g_timer_reset (timer);
+	for (guint i = 0; i < 4; i++)
+		fu_common_crc16 (FU_CRC_KIND_B16_USB, buf, sz / 4);
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "fu_common_crc16() of 0x%x bytes", (guint) sz);
+}
+
+static void
+fu_common_checksums_func (void)
+{
+	GChecksumType kinds[] = {
+		G_CHECKSUM_SHA1,
+		G_CHECKSUM_SHA256,
+		G_CHECKSUM_SHA512,
+	};
+
+	/* spans the single-pass and threaded paths */
+	for (gsize sz = 0; sz <= 0x800000; sz = sz * 4 + 0x3ff) {
+		g_autofree guint8 *buf = g_malloc0 (sz + 1);
+		g_autofree gchar *tree1 = NULL;
+		g_autofree gchar *tree2 = NULL;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GPtrArray) checksums = NULL;
+
+		for (gsize i = 0; i < sz; i++)
+			buf[i] = (guint8) (i * 7);
+		blob = g_bytes_new_static (buf, sz);
+		checksums = fu_common_checksums_for_bytes (blob, kinds, G_N_ELEMENTS (kinds));
+		g_assert_cmpint (checksums->len, ==, G_N_ELEMENTS (kinds));
+		for (guint i = 0; i < G_N_ELEMENTS (kinds); i++) {
+			g_autofree gchar *tmp = g_compute_checksum_for_bytes (kinds[i], blob);
+			g_assert_cmpstr (g_ptr_array_index (checksums, i), ==, tmp);
+		}
+
+		/* tree mode is stable, but depends on the size */
+		tree1 = fu_common_checksum_tree_for_bytes (blob, G_CHECKSUM_SHA256);
+		tree2 = fu_common_checksum_tree_for_bytes (blob, G_CHECKSUM_SHA256);
+		g_assert_cmpstr (tree1, ==, tree2);
+		g_assert_cmpstr (tree1, !=, g_ptr_array_index (checksums, 1));
+		if (sz > 0) {
+			g_autofree gchar *tree3 = NULL;
+			g_autoptr(GBytes) blob_short = g_bytes_new_static (buf, sz + 1);
+			tree3 = fu_common_checksum_tree_for_bytes (blob_short, G_CHECKSUM_SHA256);
+			g_assert_cmpstr (tree1, !=, tree3);
+		}
+	}
+}
+
+static void
+fu_common_checksums_benchmark_func (void)
+{
+	gsize sz = 64 * 1024 * 1024;
+	GChecksumType kinds[] = {
+		G_CHECKSUM_SHA1,
+		G_CHECKSUM_SHA256,
+	};
+	g_autofree guint8 *buf = g_malloc0 (sz);
+	g_autofree gchar *tree = NULL;
+	g_autoptr(GBytes) blob = g_bytes_new_static (buf, sz);
+	g_autoptr(GPtrArray) checksums = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	for (guint i = 0; i < G_N_ELEMENTS (kinds); i++) {
+		g_autofree gchar *tmp = g_compute_checksum_for_bytes (kinds[i], blob);
+		g_assert_nonnull (tmp);
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "SHA1 then SHA256 of 0x%x bytes", (guint) sz);
+	g_timer_reset (timer);
+	checksums = fu_common_checksums_for_bytes (blob, kinds, G_N_ELEMENTS (kinds));
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "SHA1 and SHA256 of 0x%x bytes together", (guint) sz);
+	g_timer_reset (timer);
+	tree = fu_common_checksum_tree_for_bytes (blob, G_CHECKSUM_SHA256);
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "SHA256 tree of 0x%x bytes", (guint) sz);
+}
+
 static void
 fu_common_strstrip_func (void)
 {
@@ -1129,6 +1834,68 @@ fu_common_strstrip_func (void)
 	}
 }
 
+static void
+fu_common_get_contents_fd_func (void)
+{
+#ifdef HAVE_GIO_UNIX
+	gboolean ret;
+	gint fd;
+	gint fd_tmp;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fd = g_file_open_tmp ("fwupd-self-test-XXXXXX", &fn, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (fd, >, 0);
+	ret = g_file_set_contents (fn, "hello world", -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* anyone with the file open can change it, so it must be copied */
+	blob = fu_common_get_contents_fd (fd, 1024, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob);
+	g_assert_cmpint (g_bytes_get_size (blob), ==, 11);
+	fd_tmp = g_open (fn, O_WRONLY, 0);
+	g_assert_cmpint (fd_tmp, >=, 0);
+	g_assert_cmpint (pwrite (fd_tmp, "HELLO", 5, 0), ==, 5);
+	close (fd_tmp);
+	g_assert_cmpint (memcmp (g_bytes_get_data (blob, NULL), "hello world", 11), ==, 0);
+	g_unlink (fn);
+#else
+	g_test_skip ("no <glib-unix.h> support");
+#endif
+}
+
+static void
+fu_common_get_contents_fd_sealed_func (void)
+{
+#ifdef HAVE_MEMFD_CREATE
+	gint fd;
+	guintptr addr;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fd = memfd_create ("fwupd-self-test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	g_assert_cmpint (fd, >, 0);
+	g_assert_cmpint (write (fd, "hello world", 11), ==, 11);
+	g_assert_cmpint (fcntl (fd, F_ADD_SEALS,
+				F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL), ==, 0);
+
+	/* nobody can change the contents, so it is mapped rather than copied */
+	blob = fu_common_get_contents_fd (fd, 1024, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob);
+	g_assert_cmpint (g_bytes_get_size (blob), ==, 11);
+	g_assert_cmpint (memcmp (g_bytes_get_data (blob, NULL), "hello world", 11), ==, 0);
+	addr = (guintptr) g_bytes_get_data (blob, NULL);
+	g_assert_cmpint (addr % (guintptr) sysconf (_SC_PAGESIZE), ==, 0);
+#else
+	g_test_skip ("no memfd_create() support");
+#endif
+}
+
 static void
 fu_common_version_func (void)
 {
@@ -1234,6 +2001,98 @@ fu_common_version_func (void)
 	}
 }
 
+static void
+fu_common_version_key_func (void)
+{
+	const gchar *versions[] = {
+		"1.2.3", "1.2.3~rc1", "1.2.3~rc2", "1.2.3a", "1.2.3b", "1.2",
+		"1.2.0", "1.2.3.4", "1.02.3", "001.002.003", "", "alpha", "beta",
+		"1..2", "-1.2", "1.2a.3", "1.2b.3", "10", "9", "1.2.3-rc1", "~",
+		NULL };
+	FwupdVersionFormat fmts[] = {
+		FWUPD_VERSION_FORMAT_TRIPLET,
+		FWUPD_VERSION_FORMAT_PLAIN,
+		FWUPD_VERSION_FORMAT_LAST };
+	const FuVersionKey *key_dev;
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuVersionKey) key_new = NULL;
+	g_autoptr(FuVersionKey) key_null = fu_common_version_key_new (NULL, FWUPD_VERSION_FORMAT_TRIPLET);
+
+	/* same result as parsing the strings each time */
+	for (guint k = 0; fmts[k] != FWUPD_VERSION_FORMAT_LAST; k++) {
+		for (guint i = 0; versions[i] != NULL; i++) {
+			g_autoptr(FuVersionKey) key1 = fu_common_version_key_new (versions[i], fmts[k]);
+			for (guint j = 0; versions[j] != NULL; j++) {
+				g_autoptr(FuVersionKey) key2 = fu_common_version_key_new (versions[j], fmts[k]);
+				gint rc1 = fu_common_vercmp_full (versions[i], versions[j], fmts[k]);
+				gint rc2 = fu_common_version_key_compare (key1, key2);
+				if (CLAMP (rc1, -1, 1) != CLAMP (rc2, -1, 1)) {
+					g_error ("%s vs %s: expected %i, got %i",
+						 versions[i], versions[j], rc1, rc2);
+				}
+			}
+		}
+	}
+	g_assert_cmpint (fu_common_version_key_compare (key_null, key_null), ==, G_MAXINT);
+
+	/* cached on the device until the version changes */
+	fu_device_set_version_format (device, FWUPD_VERSION_FORMAT_TRIPLET);
+	fu_device_set_version (device, "1.2.3");
+	key_dev = fu_device_get_version_key (device);
+	g_assert_true (fu_common_version_key_matches (key_dev, "1.2.3", FWUPD_VERSION_FORMAT_TRIPLET));
+	g_assert_true (fu_device_get_version_key (device) == key_dev);
+	fu_device_set_version (device, "1.2.4");
+	key_dev = fu_device_get_version_key (device);
+	g_assert_true (fu_common_version_key_matches (key_dev, "1.2.4", FWUPD_VERSION_FORMAT_TRIPLET));
+	key_new = fu_common_version_key_new ("1.2.10", FWUPD_VERSION_FORMAT_TRIPLET);
+	g_assert_cmpint (fu_common_version_key_compare (key_dev, key_new), <, 0);
+}
+
+static void
+fu_common_version_key_benchmark_func (void)
+{
+	const guint iterations = 100;
+	g_autoptr(GPtrArray) versions = g_ptr_array_new_with_free_func (g_free);
+	g_autoptr(GPtrArray) keys = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_common_version_key_free);
+	g_autoptr(GRand) rand = g_rand_new_with_seed (0);
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* about as many releases as the largest LVFS component */
+	for (guint i = 0; i < 2000; i++) {
+		g_ptr_array_add (versions, g_strdup_printf ("%u.%u.%u.%u",
+							    g_rand_int_range (rand, 0, 10),
+							    g_rand_int_range (rand, 0, 100),
+							    g_rand_int_range (rand, 0, 1000),
+							    g_rand_int_range (rand, 0, 10000)));
+	}
+
+	/* compare strings */
+	for (guint j = 0; j < iterations; j++) {
+		for (guint i = 1; i < versions->len; i++) {
+			fu_common_vercmp_full (g_ptr_array_index (versions, i - 1),
+					       g_ptr_array_index (versions, i),
+					       FWUPD_VERSION_FORMAT_QUAD);
+		}
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "compared %u version strings", iterations * versions->len);
+
+	/* compare keys, including the one-time parse */
+	g_timer_reset (timer);
+	for (guint i = 0; i < versions->len; i++) {
+		g_ptr_array_add (keys, fu_common_version_key_new (g_ptr_array_index (versions, i),
+							   FWUPD_VERSION_FORMAT_QUAD));
+	}
+	for (guint j = 0; j < iterations; j++) {
+		for (guint i = 1; i < keys->len; i++) {
+			fu_common_version_key_compare (g_ptr_array_index (keys, i - 1),
+						g_ptr_array_index (keys, i));
+		}
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+				 "compared %u version keys", iterations * keys->len);
+}
+
 static void
 fu_common_vercmp_func (void)
 {
@@ -1429,6 +2288,106 @@ fu_firmware_ihex_offset_func (void)
 	g_assert_cmpint (g_bytes_get_size (data_verify), ==, 0x4);
 }
 
+static void
+fu_firmware_ihex_invalid_func (void)
+{
+	gboolean ret;
+	GPtrArray *records;
+	FuIhexFirmwareRecord *rcd;
+	g_autoptr(FuFirmware) firmware1 = fu_ihex_firmware_new ();
+	g_autoptr(FuFirmware) firmware2 = fu_ihex_firmware_new ();
+	g_autoptr(FuFirmware) firmware3 = fu_ihex_firmware_new ();
+	g_autoptr(GBytes) data_bad = NULL;
+	g_autoptr(GBytes) data_crlf = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* a non-hex digit is not silently parsed as zero */
+	data_bad = g_bytes_new_static (":0200000480G07A\n:00000001FF\n", 29);
+	ret = fu_firmware_parse (firmware1, data_bad, FWUPD_INSTALL_FLAG_FORCE, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+	g_clear_error (&error);
+
+	/* DOS line endings, comments and blank lines */
+	data_crlf = g_bytes_new_static ("; comment\r\n"
+					":04000000666F6F00B8\r\n"
+					"\r\n"
+					":00000001FF\r\n", 47);
+	ret = fu_firmware_parse (firmware2, data_crlf, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	/* records are still available when only tokenizing */
+	ret = fu_firmware_tokenize (firmware3, data_crlf, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	records = fu_ihex_firmware_get_records (FU_IHEX_FIRMWARE (firmware3));
+	g_assert_cmpint (records->len, ==, 3);
+	rcd = g_ptr_array_index (records, 1);
+	g_assert_cmpint (rcd->ln, ==, 2);
+	g_assert_cmpstr (rcd->buf->str, ==, ":04000000666F6F00B8");
+}
+
+static void
+fu_firmware_ihex_benchmark_func (void)
+{
+	const guint iterations = 10;
+	gboolean ret;
+	g_autofree gchar *filename_hex = NULL;
+	g_autoptr(FuFirmware) firmware = fu_ihex_firmware_new ();
+	g_autoptr(FuFirmwareImage) img = NULL;
+	g_autoptr(GByteArray) buf = g_byte_array_new ();
+	g_autoptr(GBytes) data_bin = NULL;
+	g_autoptr(GBytes) data_file = NULL;
+	g_autoptr(GBytes) data_fw = NULL;
+	g_autoptr(GBytes) data_hex = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* the same file as in the fuzzing corpus */
+	filename_hex = g_build_filename (TESTDATADIR_SRC, "firmware.hex", NULL);
+	data_file = fu_common_get_contents_bytes (filename_hex, &error);
+	g_assert_no_error (error);
+	g_assert (data_file != NULL);
+	ret = fu_firmware_parse (firmware, data_file, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	data_fw = fu_firmware_get_image_default_bytes (firmware, &error);
+	g_assert_no_error (error);
+	g_assert (data_fw != NULL);
+
+	/* repeat the payload to make a ~4MB image, which is ~11MB as hex */
+	while (buf->len < 4 * 1024 * 1024) {
+		g_byte_array_append (buf,
+				     g_bytes_get_data (data_fw, NULL),
+				     g_bytes_get_size (data_fw));
+	}
+	data_bin = g_bytes_new (buf->data, buf->len);
+	img = fu_firmware_image_new (data_bin);
+	g_clear_object (&firmware);
+	firmware = fu_ihex_firmware_new ();
+	fu_firmware_add_image (firmware, img);
+	data_hex = fu_firmware_write (firmware, &error);
+	g_assert_no_error (error);
+	g_assert (data_hex != NULL);
+
+	/* parse it back */
+	g_timer_reset (timer);
+	for (guint i = 0; i < iterations; i++) {
+		g_autoptr(FuFirmware) firmware_tmp = fu_ihex_firmware_new ();
+		g_autoptr(GBytes) data_tmp = NULL;
+		ret = fu_firmware_parse (firmware_tmp, data_hex, FWUPD_INSTALL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert (ret);
+		data_tmp = fu_firmware_get_image_default_bytes (firmware_tmp, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (g_bytes_get_size (data_tmp), ==, buf->len);
+	}
+	g_test_minimized_result (g_timer_elapsed (timer, NULL) / iterations,
+				 "parsed %u bytes of ihex",
+				 (guint) g_bytes_get_size (data_hex));
+}
+
 static void
 fu_firmware_srec_func (void)
 {
@@ -1483,6 +2442,7 @@ fu_firmware_srec_tokenization_func (void)
 	data_srec = g_bytes_new_static (buf, strlen (buf));
 	g_assert_no_error (error);
 	g_assert (data_srec != NULL);
+	fu_srec_firmware_set_keep_records (FU_SREC_FIRMWARE (firmware), TRUE);
 	ret = fu_firmware_tokenize (firmware, data_srec, FWUPD_INSTALL_FLAG_NONE, &error);
 	g_assert_no_error (error);
 	g_assert (ret);
@@ -1499,6 +2459,97 @@ fu_firmware_srec_tokenization_func (void)
 	g_assert_cmpint (rcd->buf->data[0], ==, 0x50);
 }
 
+static void
+fu_firmware_srec_append_record (GString *str, guint8 kind, guint32 addr,
+				const guint8 *data, gsize datasz)
+{
+	guint8 csum = datasz + 5;
+	g_string_append_printf (str, "S%u%02X%08X", (guint) kind, (guint) datasz + 5, addr);
+	for (guint i = 0; i < 4; i++)
+		csum += (addr >> (i * 8)) & 0xff;
+	for (gsize i = 0; i < datasz; i++) {
+		g_string_append_printf (str, "%02X", data[i]);
+		csum += data[i];
+	}
+	g_string_append_printf (str, "%02X\n", (guint) (csum ^ 0xff));
+}
+
+static GBytes *
+fu_firmware_srec_build (gsize imgsz)
+{
+	guint8 buf[32] = { 0x0 };
+	gsize len;
+	GString *str = g_string_new ("S0030000FC\n");
+	for (gsize i = 0; i < imgsz; i += sizeof(buf)) {
+		for (guint j = 0; j < sizeof(buf); j++)
+			buf[j] = (guint8) (i + j);
+		fu_firmware_srec_append_record (str, 3, 0x8000 + i, buf, sizeof(buf));
+	}
+	fu_firmware_srec_append_record (str, 7, 0x8000, NULL, 0);
+	len = str->len;
+	return g_bytes_new_take (g_string_free (str, FALSE), len);
+}
+
+static void
+fu_firmware_srec_stream_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware1 = fu_srec_firmware_new ();
+	g_autoptr(FuFirmware) firmware2 = fu_srec_firmware_new ();
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) data_srec = fu_firmware_srec_build (0x1000);
+	g_autoptr(GError) error = NULL;
+
+	/* parsed directly into the image */
+	ret = fu_firmware_parse (firmware1, data_srec, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (fu_srec_firmware_get_records (FU_SREC_FIRMWARE (firmware1))->len, ==, 0);
+	blob1 = fu_firmware_get_image_default_bytes (firmware1, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob1);
+	g_assert_cmpint (g_bytes_get_size (blob1), ==, 0x1000);
+
+	/* using the records gives the same image */
+	fu_srec_firmware_set_keep_records (FU_SREC_FIRMWARE (firmware2), TRUE);
+	ret = fu_firmware_parse (firmware2, data_srec, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (fu_srec_firmware_get_records (FU_SREC_FIRMWARE (firmware2))->len, ==, 0x1000 / 32 + 2);
+	blob2 = fu_firmware_get_image_default_bytes (firmware2, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob2);
+	ret = fu_common_bytes_compare (blob1, blob2, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+}
+
+static void
+fu_firmware_srec_benchmark_func (void)
+{
+	const guint iterations = 10;
+	g_autoptr(GBytes) data_srec = fu_firmware_srec_build (4 * 1024 * 1024);
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	for (guint k = 0; k < 2; k++) {
+		g_timer_reset (timer);
+		for (guint i = 0; i < iterations; i++) {
+			gboolean ret;
+			g_autoptr(FuFirmware) firmware = fu_srec_firmware_new ();
+			g_autoptr(GError) error = NULL;
+			fu_srec_firmware_set_keep_records (FU_SREC_FIRMWARE (firmware), k == 0);
+			ret = fu_firmware_parse (firmware, data_srec, FWUPD_INSTALL_FLAG_NONE, &error);
+			g_assert_no_error (error);
+			g_assert_true (ret);
+		}
+		g_test_minimized_result (g_timer_elapsed (timer, NULL) / iterations,
+					 "parsed %u bytes of srec %s",
+					 (guint) g_bytes_get_size (data_srec),
+					 k == 0 ? "using records" : "directly");
+	}
+}
+
 static void
 fu_firmware_dfu_func (void)
 {
@@ -1594,6 +2645,96 @@ fu_firmware_func (void)
 				  "  Address:               0x400\n");
 }
 
+static GBytes *
+fu_firmware_lazy_load_cb (FuFirmwareImage *img, gpointer user_data, GError **error)
+{
+	guint *cnt = (guint *) user_data;
+	(*cnt)++;
+	if (fu_firmware_image_get_idx (img) == 0xbad) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "corrupt");
+		return NULL;
+	}
+	return g_bytes_new_static ("hello", 5);
+}
+
+static void
+fu_firmware_lazy_func (void)
+{
+	guint cnt_primary = 0;
+	guint cnt_secondary = 0;
+	guint cnt_bad = 0;
+	const guint8 *buf;
+	gsize bufsz = 0;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new ();
+	g_autoptr(FuFirmwareImage) img1 = fu_firmware_image_new (NULL);
+	g_autoptr(FuFirmwareImage) img2 = fu_firmware_image_new (NULL);
+	g_autoptr(FuFirmwareImage) img3 = fu_firmware_image_new (NULL);
+	g_autoptr(GBytes) blob = g_bytes_new_static ("0123456789", 10);
+	g_autoptr(GBytes) blob_bad = NULL;
+	g_autoptr(GBytes) blob_chunk = NULL;
+	g_autoptr(GBytes) blob_slice = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* slices share the parent data */
+	blob_slice = fu_common_bytes_new_offset (blob, 2, 3, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_slice);
+	buf = g_bytes_get_data (blob_slice, &bufsz);
+	g_assert_cmpint (bufsz, ==, 3);
+	g_assert (buf == (const guint8 *) g_bytes_get_data (blob, NULL) + 2);
+	blob_bad = fu_common_bytes_new_offset (blob, 8, 3, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_bad);
+	g_clear_error (&error);
+	blob_bad = fu_common_bytes_new_offset (blob, G_MAXSIZE, 2, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_bad);
+	g_clear_error (&error);
+
+	/* add three images that are only loaded when required */
+	fu_firmware_image_set_id (img1, "primary");
+	fu_firmware_image_set_load_func (img1, fu_firmware_lazy_load_cb, &cnt_primary, NULL);
+	fu_firmware_add_image (firmware, img1);
+	fu_firmware_image_set_id (img2, "secondary");
+	fu_firmware_image_set_addr (img2, 0x100);
+	fu_firmware_image_set_load_func (img2, fu_firmware_lazy_load_cb, &cnt_secondary, NULL);
+	fu_firmware_add_image (firmware, img2);
+	fu_firmware_image_set_id (img3, "bad");
+	fu_firmware_image_set_idx (img3, 0xbad);
+	fu_firmware_image_set_load_func (img3, fu_firmware_lazy_load_cb, &cnt_bad, NULL);
+	fu_firmware_add_image (firmware, img3);
+
+	/* only loaded once */
+	blob1 = fu_firmware_get_image_by_id_bytes (firmware, "primary", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob1);
+	g_assert_cmpint (g_bytes_get_size (blob1), ==, 5);
+	g_clear_pointer (&blob1, g_bytes_unref);
+	blob1 = fu_firmware_get_image_by_id_bytes (firmware, "primary", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob1);
+	g_assert_cmpint (cnt_primary, ==, 1);
+	g_assert_cmpint (cnt_secondary, ==, 0);
+
+	/* chunks load the image too */
+	blob_chunk = fu_firmware_image_write_chunk (img2, 0x101, 2, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_chunk);
+	g_assert_cmpint (g_bytes_get_size (blob_chunk), ==, 2);
+	g_assert_cmpint (cnt_secondary, ==, 1);
+
+	/* errors are returned when the image is required */
+	blob2 = fu_firmware_get_image_by_id_bytes (firmware, "bad", &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob2);
+	g_assert_cmpint (cnt_bad, ==, 1);
+}
+
 static void
 fu_efivar_func (void)
 {
@@ -1762,15 +2903,35 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/plugin{quirks-performance}", fu_plugin_quirks_performance_func);
 	g_test_add_func ("/fwupd/plugin{quirks-device}", fu_plugin_quirks_device_func);
 	g_test_add_func ("/fwupd/chunk", fu_chunk_func);
+	g_test_add_func ("/fwupd/chunk{reference}", fu_chunk_reference_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/chunk{benchmark}", fu_chunk_benchmark_func);
 	g_test_add_func ("/fwupd/common{string-append-kv}", fu_common_string_append_kv_func);
 	g_test_add_func ("/fwupd/common{version-guess-format}", fu_common_version_guess_format_func);
 	g_test_add_func ("/fwupd/common{version}", fu_common_version_func);
 	g_test_add_func ("/fwupd/common{vercmp}", fu_common_vercmp_func);
+	g_test_add_func ("/fwupd/common{version-key}", fu_common_version_key_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/common{version-key-benchmark}", fu_common_version_key_benchmark_func);
+	g_test_add_func ("/fwupd/common{bytes}", fu_common_bytes_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/common{bytes-benchmark}", fu_common_bytes_benchmark_func);
+	g_test_add_func ("/fwupd/common{crc}", fu_common_crc_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/common{crc-benchmark}", fu_common_crc_benchmark_func);
+	g_test_add_func ("/fwupd/common{checksums}", fu_common_checksums_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/common{checksums-benchmark}", fu_common_checksums_benchmark_func);
 	g_test_add_func ("/fwupd/common{strstrip}", fu_common_strstrip_func);
+	g_test_add_func ("/fwupd/common{get-contents-fd}", fu_common_get_contents_fd_func);
+	g_test_add_func ("/fwupd/common{get-contents-fd-sealed}", fu_common_get_contents_fd_sealed_func);
 	g_test_add_func ("/fwupd/common{endian}", fu_common_endian_func);
+	g_test_add_func ("/fwupd/common{delta}", fu_common_delta_func);
 	g_test_add_func ("/fwupd/common{cab-success}", fu_common_store_cab_func);
 	g_test_add_func ("/fwupd/common{cab-success-unsigned}", fu_common_store_cab_unsigned_func);
 	g_test_add_func ("/fwupd/common{cab-success-folder}", fu_common_store_cab_folder_func);
+	g_test_add_func ("/fwupd/common{cab-success-delta}", fu_common_store_cab_delta_func);
+	g_test_add_func ("/fwupd/common{cab-success-multiple}", fu_common_store_cab_multiple_func);
 	g_test_add_func ("/fwupd/common{cab-error-no-metadata}", fu_common_store_cab_error_no_metadata_func);
 	g_test_add_func ("/fwupd/common{cab-error-wrong-size}", fu_common_store_cab_error_wrong_size_func);
 	g_test_add_func ("/fwupd/common{cab-error-wrong-checksum}", fu_common_store_cab_error_wrong_checksum_func);
@@ -1784,18 +2945,27 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/hwids", fu_hwids_func);
 	g_test_add_func ("/fwupd/smbios", fu_smbios_func);
 	g_test_add_func ("/fwupd/smbios3", fu_smbios3_func);
+	g_test_add_func ("/fwupd/smbios{truncated}", fu_smbios_truncated_func);
 	g_test_add_func ("/fwupd/firmware", fu_firmware_func);
+	g_test_add_func ("/fwupd/firmware{lazy}", fu_firmware_lazy_func);
 	g_test_add_func ("/fwupd/firmware{ihex}", fu_firmware_ihex_func);
 	g_test_add_func ("/fwupd/firmware{ihex-offset}", fu_firmware_ihex_offset_func);
 	g_test_add_func ("/fwupd/firmware{ihex-signed}", fu_firmware_ihex_signed_func);
+	g_test_add_func ("/fwupd/firmware{ihex-invalid}", fu_firmware_ihex_invalid_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/firmware{ihex-benchmark}", fu_firmware_ihex_benchmark_func);
 	g_test_add_func ("/fwupd/firmware{srec-tokenization}", fu_firmware_srec_tokenization_func);
 	g_test_add_func ("/fwupd/firmware{srec}", fu_firmware_srec_func);
+	g_test_add_func ("/fwupd/firmware{srec-stream}", fu_firmware_srec_stream_func);
+	if (g_test_perf ())
+		g_test_add_func ("/fwupd/firmware{srec-benchmark}", fu_firmware_srec_benchmark_func);
 	g_test_add_func ("/fwupd/firmware{dfu}", fu_firmware_dfu_func);
 	g_test_add_func ("/fwupd/archive{invalid}", fu_archive_invalid_func);
 	g_test_add_func ("/fwupd/archive{cab}", fu_archive_cab_func);
 	g_test_add_func ("/fwupd/device{flags}", fu_device_flags_func);
 	g_test_add_func ("/fwupd/device{parent}", fu_device_parent_func);
 	g_test_add_func ("/fwupd/device{incorporate}", fu_device_incorporate_func);
+	g_test_add_func ("/fwupd/device{instance-id-empty}", fu_device_instance_id_empty_func);
 	if (g_test_slow ())
 		g_test_add_func ("/fwupd/device{poll}", fu_device_poll_func);
 	g_test_add_func ("/fwupd/device-locker{success}", fu_device_locker_func);
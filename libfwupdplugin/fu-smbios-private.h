@@ -18,3 +18,7 @@ gboolean	 fu_smbios_setup_from_path	(FuSmbios	*self,
 gboolean	 fu_smbios_setup_from_file	(FuSmbios	*self,
 						 const gchar	*filename,
 						 GError		**error);
+gboolean	 fu_smbios_setup_from_data	(FuSmbios	*self,
+						 const guint8	*buf,
+						 gsize		 sz,
+						 GError		**error);
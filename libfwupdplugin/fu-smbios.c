@@ -70,18 +70,46 @@ typedef struct {
 
 G_DEFINE_TYPE (FuSmbios, fu_smbios, G_TYPE_OBJECT)
 
-static gboolean
+/**
+ * fu_smbios_setup_from_data:
+ * @self: A #FuSmbios
+ * @buf: A buffer of SMBIOS structures
+ * @sz: size of @buf
+ * @error: A #GError or %NULL
+ *
+ * Reads all the SMBIOS values from a DMI buffer.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
 fu_smbios_setup_from_data (FuSmbios *self, const guint8 *buf, gsize sz, GError **error)
 {
+	g_return_val_if_fail (FU_IS_SMBIOS (self), FALSE);
+	g_return_val_if_fail (buf != NULL || sz == 0, FALSE);
+
 	/* go through each structure */
 	for (gsize i = 0; i < sz; i++) {
 		FuSmbiosStructure *str = (FuSmbiosStructure *) &buf[i];
 		FuSmbiosItem *item;
 
-		/* invalid */
+		/* some firmware pads the table with zeros */
+		if (sz - i < sizeof (FuSmbiosStructure)) {
+			for (gsize j = i; j < sz; j++) {
+				if (buf[j] != 0x00) {
+					g_set_error_literal (error,
+							     FWUPD_ERROR,
+							     FWUPD_ERROR_INVALID_FILE,
+							     "structure header larger than available data");
+					return FALSE;
+				}
+			}
+			break;
+		}
 		if (str->len == 0x00)
 			break;
-		if (str->len >= sz) {
+		if (str->len >= sz - i) {
 			g_set_error_literal (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
@@ -99,7 +127,7 @@ fu_smbios_setup_from_data (FuSmbios *self, const guint8 *buf, gsize sz, GError *
 
 		/* jump to the end of the struct */
 		i += str->len;
-		if (buf[i] == '\0' && buf[i+1] == '\0') {
+		if (i + 1 < sz && buf[i] == '\0' && buf[i+1] == '\0') {
 			i++;
 			continue;
 		}
@@ -26,10 +26,30 @@
 struct _FuSrecFirmware {
 	FuFirmware		 parent_instance;
 	GPtrArray		*records;
+	gboolean		 keep_records;
 };
 
 G_DEFINE_TYPE (FuSrecFirmware, fu_srec_firmware, FU_TYPE_FIRMWARE)
 
+/* a record decoded from a single line, pointing into a stack buffer */
+typedef struct {
+	guint			 ln;
+	FuFirmareSrecRecordKind	 kind;
+	guint32			 addr;
+	const guint8		*data;
+	gsize			 datasz;
+} FuSrecFirmwareLine;
+
+typedef struct {
+	gboolean		 got_hdr;
+	guint16			 data_cnt;
+	guint32			 addr32_last;
+	guint32			 img_address;
+	guint64			 addr_start;
+	FuFirmwareImage		*img;
+	GByteArray		*outbuf;
+} FuSrecFirmwareParseHelper;
+
 /**
  * fu_srec_firmware_get_records:
  * @self: A #FuSrecFirmware
@@ -39,6 +59,9 @@ G_DEFINE_TYPE (FuSrecFirmware, fu_srec_firmware, FU_TYPE_FIRMWARE)
  * This might be useful if the plugin is expecting the SREC file to be a list
  * of operations, rather than a simple linear image with filled holes.
  *
+ * The records are only created if fu_srec_firmware_set_keep_records() was
+ * called before the firmware was tokenized.
+ *
  * Returns: (transfer none) (element-type FuSrecFirmwareRecord): records
  *
  * Since: 1.3.2
@@ -50,6 +73,26 @@ fu_srec_firmware_get_records (FuSrecFirmware *self)
 	return self->records;
 }
 
+/**
+ * fu_srec_firmware_set_keep_records:
+ * @self: A #FuSrecFirmware
+ * @keep_records: %TRUE to keep the tokenized records
+ *
+ * Sets if the records should be kept when the firmware is tokenized, for
+ * plugins that use fu_srec_firmware_get_records().
+ *
+ * By default the file is parsed directly into the image without storing any
+ * records, which uses much less memory for large files.
+ *
+ * Since: 1.5.0
+ **/
+void
+fu_srec_firmware_set_keep_records (FuSrecFirmware *self, gboolean keep_records)
+{
+	g_return_if_fail (FU_IS_SREC_FIRMWARE (self));
+	self->keep_records = keep_records;
+}
+
 static void
 fu_srec_firmware_record_free (FuSrecFirmwareRecord *rcd)
 {
@@ -80,167 +123,358 @@ fu_srec_firmware_record_new (guint ln, FuFirmareSrecRecordKind kind, guint32 add
 	return rcd;
 }
 
+/* gets the next line without copying, truncated at any carriage return */
+static gboolean
+fu_srec_firmware_next_line (const gchar *data,
+			    gsize datasz,
+			    gsize *offset,
+			    const gchar **line,
+			    gsize *linesz)
+{
+	const gchar *nl;
+	const gchar *cr;
+	gsize sz;
+
+	if (*offset >= datasz)
+		return FALSE;
+	*line = data + *offset;
+	nl = memchr (*line, '\n', datasz - *offset);
+	sz = nl != NULL ? (gsize) (nl - *line) : datasz - *offset;
+	*offset += sz + 1;
+	cr = memchr (*line, '\r', sz);
+	if (cr != NULL)
+		sz = (gsize) (cr - *line);
+	*linesz = sz;
+	return TRUE;
+}
+
+/* decodes and verifies one line, where @buf holds the decoded bytes */
+static gboolean
+fu_srec_firmware_decode_line (const gchar *line,
+			      gsize linesz,
+			      guint ln,
+			      FwupdInstallFlags flags,
+			      guint8 *buf,
+			      FuSrecFirmwareLine *rec,
+			      gboolean *got_eof,
+			      GError **error)
+{
+	guint8 addrsz = 0;		/* bytes */
+	guint8 rec_count = 0;		/* words */
+	guint rec_len;
+
+	/* check starting token */
+	if (line[0] != 'S') {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid starting token, got '%c' at line %u",
+			     line[0], ln);
+		return FALSE;
+	}
+
+	/* check there's enough data for the smallest possible record */
+	if (linesz < 10) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "record incomplete at line %u, length %u",
+			     ln, (guint) linesz);
+		return FALSE;
+	}
+
+	/* kind, count, address, (data), checksum, linefeed */
+	rec->ln = ln;
+	rec->kind = line[1] - '0';
+	if (!fu_firmware_strparse_uint8_safe (line, linesz, 2, &rec_count, error)) {
+		g_prefix_error (error, "line %u: ", ln);
+		return FALSE;
+	}
+	if ((gsize) rec_count * 2 != linesz - 4) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "count incomplete at line %u, "
+			     "length %u, expected %u",
+			     ln, (guint) linesz - 4, (guint) rec_count * 2);
+		return FALSE;
+	}
+
+	/* decode the count, address and data, and the checksum if required */
+	rec_len = rec_count;
+	if ((flags & FWUPD_INSTALL_FLAG_FORCE) == 0)
+		rec_len++;
+	for (guint i = 0; i < rec_len; i++) {
+		if (!fu_firmware_strparse_uint8_safe (line, linesz, 2 + (i * 2),
+						      &buf[i], error)) {
+			g_prefix_error (error, "line %u: ", ln);
+			return FALSE;
+		}
+	}
+
+	/* checksum check */
+	if ((flags & FWUPD_INSTALL_FLAG_FORCE) == 0) {
+		guint8 rec_csum = 0;
+		guint8 rec_csum_expected = buf[rec_count];
+		for (guint i = 0; i < rec_count; i++)
+			rec_csum += buf[i];
+		rec_csum ^= 0xff;
+		if (rec_csum != rec_csum_expected) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "checksum incorrect line %u, "
+				     "expected %02x, got %02x",
+				     ln, (guint) rec_csum_expected, (guint) rec_csum);
+			return FALSE;
+		}
+	}
+
+	/* set each command settings */
+	switch (rec->kind) {
+	case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
+		addrsz = 2;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
+		addrsz = 2;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
+		addrsz = 3;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
+		addrsz = 4;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
+		addrsz = 2;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
+		addrsz = 3;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
+		addrsz = 4;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
+		addrsz = 3;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
+		addrsz = 2;
+		*got_eof = TRUE;
+		break;
+	default:
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid srec record type S%c at line %u",
+			     line[1], ln);
+		return FALSE;
+	}
+	if (rec_count < addrsz + 1) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "count too small for address at line %u",
+			     ln);
+		return FALSE;
+	}
+
+	/* parse address */
+	rec->addr = 0;
+	for (guint i = 0; i < addrsz; i++)
+		rec->addr = (rec->addr << 8) | buf[1 + i];
+
+	/* data */
+	rec->data = buf + 1 + addrsz;
+	rec->datasz = 0;
+	if (rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
+	    rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
+	    rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32)
+		rec->datasz = rec_count - addrsz - 1;
+	return TRUE;
+}
+
 static gboolean
 fu_srec_firmware_tokenize (FuFirmware *firmware, GBytes *fw,
 			   FwupdInstallFlags flags, GError **error)
 {
 	FuSrecFirmware *self = FU_SREC_FIRMWARE (firmware);
 	const gchar *data;
+	const gchar *line = NULL;
+	const gchar *nul;
 	gboolean got_eof = FALSE;
+	gsize linesz = 0;
+	gsize offset = 0;
 	gsize sz = 0;
-	g_auto(GStrv) lines = NULL;
 
-	/* parse records */
+	/* the file is parsed directly into the image in ->parse() */
+	g_ptr_array_set_size (self->records, 0);
+	if (!self->keep_records)
+		return TRUE;
+
+	/* nothing after an embedded NUL is used */
 	data = g_bytes_get_data (fw, &sz);
-	lines = fu_common_strnsplit (data, sz, "\n", -1);
-	for (guint ln = 0; lines[ln] != NULL; ln++) {
+	nul = sz > 0 ? memchr (data, '\0', sz) : NULL;
+	if (nul != NULL)
+		sz = (gsize) (nul - data);
+
+	/* parse records */
+	for (guint ln = 1; fu_srec_firmware_next_line (data, sz, &offset, &line, &linesz); ln++) {
+		FuSrecFirmwareLine rec = { 0x0 };
 		FuSrecFirmwareRecord *rcd;
-		const gchar *line = lines[ln];
-		gsize linesz;
-		guint32 rec_addr32;
-		guint8 addrsz = 0;		/* bytes */
-		guint8 rec_count;		/* words */
-		guint8 rec_kind;
+		guint8 buf[G_MAXUINT8 + 1] = { 0x0 };
 
 		/* ignore blank lines */
-		g_strdelimit (lines[ln], "\r", '\0');
-		linesz = strlen (line);
 		if (linesz == 0)
 			continue;
+		if (!fu_srec_firmware_decode_line (line, linesz, ln, flags,
+						   buf, &rec, &got_eof, error))
+			return FALSE;
+		rcd = fu_srec_firmware_record_new (ln, rec.kind, rec.addr);
+		g_byte_array_append (rcd->buf, rec.data, rec.datasz);
+		g_ptr_array_add (self->records, rcd);
+	}
+
+	/* no EOF */
+	if (!got_eof) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "no EOF, perhaps truncated file");
+		return FALSE;
+	}
+	return TRUE;
+}
 
-		/* check starting token */
-		if (line[0] != 'S') {
+static gboolean
+fu_srec_firmware_parse_record (FuSrecFirmwareParseHelper *helper,
+			       const FuSrecFirmwareLine *rec,
+			       GError **error)
+{
+	/* header */
+	if (rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER) {
+		g_autoptr(GString) modname = g_string_new (NULL);
+
+		/* check for duplicate */
+		if (helper->got_hdr) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid starting token, got '%c' at line %u",
-				     line[0], ln + 1);
+				     "duplicate header record at line %u",
+				     rec->ln);
 			return FALSE;
 		}
 
-		/* check there's enough data for the smallest possible record */
-		if (linesz < 10) {
+		/* could be anything, lets assume text */
+		for (gsize i = 0; i < rec->datasz; i++) {
+			gchar tmp = rec->data[i];
+			if (!g_ascii_isgraph (tmp))
+				break;
+			g_string_append_c (modname, tmp);
+		}
+		if (modname->len != 0)
+			fu_firmware_image_set_id (helper->img, modname->str);
+		helper->got_hdr = TRUE;
+		return TRUE;
+	}
+
+	/* verify we got all records */
+	if (rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16) {
+		if (rec->addr != helper->data_cnt) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "record incomplete at line %u, length %u",
-				     ln + 1, (guint) linesz);
+				     "count record was not valid, got 0x%02x expected 0x%02x at line %u",
+				     (guint) rec->addr, (guint) helper->data_cnt, rec->ln);
 			return FALSE;
 		}
+		return TRUE;
+	}
 
-		/* kind, count, address, (data), checksum, linefeed */
-		rec_kind = line[1] - '0';
-		rec_count = fu_firmware_strparse_uint8 (line + 2);
-		if (rec_count * 2 != linesz - 4) {
+	/* data */
+	if (rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
+	    rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
+	    rec->kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32) {
+		/* invalid */
+		if (!helper->got_hdr) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "count incomplete at line %u, "
-				     "length %u, expected %u",
-				     ln + 1, (guint) linesz - 4, (guint) rec_count * 2);
+				     "missing header record at line %u",
+				     rec->ln);
 			return FALSE;
 		}
 
-		/* checksum check */
-		if ((flags & FWUPD_INSTALL_FLAG_FORCE) == 0) {
-			guint8 rec_csum = 0;
-			guint8 rec_csum_expected;
-			for (guint8 i = 0; i < rec_count; i++)
-				rec_csum += fu_firmware_strparse_uint8 (line + (i * 2) + 2);
-			rec_csum ^= 0xff;
-			rec_csum_expected = fu_firmware_strparse_uint8 (line + (rec_count * 2) + 2);
-			if (rec_csum != rec_csum_expected) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "checksum incorrect line %u, "
-					     "expected %02x, got %02x",
-					     ln + 1, rec_csum_expected, rec_csum);
-				return FALSE;
-			}
-		}
-
-		/* set each command settings */
-		switch (rec_kind) {
-		case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
-			addrsz = 2;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
-			addrsz = 2;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
-			addrsz = 3;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
-			addrsz = 4;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
-			addrsz = 2;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
-			addrsz = 3;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
-			addrsz = 4;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
-			addrsz = 3;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
-			addrsz = 2;
-			got_eof = TRUE;
-			break;
-		default:
+		/* does not make sense */
+		if (rec->addr < helper->addr32_last) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid srec record type S%c at line %u",
-				     line[1], ln + 1);
+				     "invalid address 0x%x, last was 0x%x at line %u",
+				     (guint) rec->addr,
+				     (guint) helper->addr32_last,
+				     rec->ln);
 			return FALSE;
 		}
-
-		/* parse address */
-		switch (addrsz) {
-		case 2:
-			rec_addr32 = fu_firmware_strparse_uint16 (line + 4);
-			break;
-		case 3:
-			rec_addr32 = fu_firmware_strparse_uint24 (line + 4);
-			break;
-		case 4:
-			rec_addr32 = fu_firmware_strparse_uint32 (line + 4);
-			break;
-		default:
-			g_assert_not_reached ();
-		}
-
-		g_debug ("line %03u S%u addr:0x%04x datalen:0x%02x",
-			 ln + 1, rec_kind, rec_addr32,
-			 (guint) rec_count - addrsz - 1);
-
-		/* data */
-		rcd = fu_srec_firmware_record_new (ln + 1, rec_kind, rec_addr32);
-		if (rec_kind == 1 || rec_kind == 2 || rec_kind == 3) {
-			for (guint8 i = 4 + (addrsz * 2); i <= rec_count * 2; i += 2) {
-				guint8 tmp = fu_firmware_strparse_uint8 (line + i);
-				fu_byte_array_append_uint8 (rcd->buf, tmp);
+		if (rec->addr < helper->addr_start) {
+			g_debug ("ignoring data at 0x%x as before start address 0x%x at line %u",
+				 (guint) rec->addr, (guint) helper->addr_start, rec->ln);
+		} else {
+			guint32 len_hole = rec->addr - helper->addr32_last;
+
+			/* fill any holes, but only up to 1Mb to avoid a DoS */
+			if (helper->addr32_last > 0 && len_hole > 0x100000) {
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INVALID_FILE,
+					     "hole of 0x%x bytes too large to fill at line %u",
+					     (guint) len_hole, rec->ln);
+				return FALSE;
+			}
+			if (helper->addr32_last > 0x0 && len_hole > 1) {
+				g_debug ("filling address 0x%08x to 0x%08x at line %u",
+					 helper->addr32_last + 1,
+					 helper->addr32_last + len_hole - 1,
+					 rec->ln);
+				for (guint i = 0; i < len_hole; i++)
+					fu_byte_array_append_uint8 (helper->outbuf, 0xff);
 			}
+
+			/* add data */
+			g_byte_array_append (helper->outbuf, rec->data, rec->datasz);
+			if (helper->img_address == 0x0)
+				helper->img_address = rec->addr;
+			helper->addr32_last = rec->addr + rec->datasz;
 		}
-		g_ptr_array_add (self->records, rcd);
+		helper->data_cnt++;
 	}
+	return TRUE;
+}
 
-	/* no EOF */
-	if (!got_eof) {
-		g_set_error_literal (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "no EOF, perhaps truncated file");
-		return FALSE;
+/* the number of data bytes in the file, ignoring any holes to be filled */
+static gsize
+fu_srec_firmware_get_data_size (const gchar *data, gsize datasz)
+{
+	const gchar *line = NULL;
+	gsize linesz = 0;
+	gsize offset = 0;
+	gsize total = 0;
+
+	while (fu_srec_firmware_next_line (data, datasz, &offset, &line, &linesz)) {
+		guint8 rec_count = 0;
+		if (linesz < 10 || line[0] != 'S')
+			continue;
+		if (!fu_firmware_strparse_uint8_safe (line, linesz, 2, &rec_count, NULL))
+			continue;
+		if (line[1] == '1' && rec_count >= 3)
+			total += rec_count - 3;
+		else if (line[1] == '2' && rec_count >= 4)
+			total += rec_count - 4;
+		else if (line[1] == '3' && rec_count >= 5)
+			total += rec_count - 5;
 	}
-	return TRUE;
+	return total;
 }
 
 static gboolean
@@ -252,119 +486,78 @@ fu_srec_firmware_parse (FuFirmware *firmware,
 			GError **error)
 {
 	FuSrecFirmware *self = FU_SREC_FIRMWARE (firmware);
-	gboolean got_hdr = FALSE;
-	guint16 data_cnt = 0;
-	guint32 addr32_last = 0;
-	guint32 img_address = 0;
 	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (NULL);
 	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) outbuf = g_byte_array_new ();
-
-	/* parse records */
-	for (guint j = 0; j < self->records->len; j++) {
-		FuSrecFirmwareRecord *rcd = g_ptr_array_index (self->records, j);
-
-		/* header */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER) {
-			g_autoptr(GString) modname = g_string_new (NULL);
-
-			/* check for duplicate */
-			if (got_hdr) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "duplicate header record at line %u",
-					     rcd->ln);
+	g_autoptr(GByteArray) outbuf = NULL;
+	FuSrecFirmwareParseHelper helper = {
+		.addr_start = addr_start,
+		.img = img,
+	};
+
+	/* assemble the image from the kept records */
+	if (self->keep_records) {
+		outbuf = g_byte_array_new ();
+		helper.outbuf = outbuf;
+		for (guint j = 0; j < self->records->len; j++) {
+			FuSrecFirmwareRecord *rcd = g_ptr_array_index (self->records, j);
+			FuSrecFirmwareLine rec = {
+				.ln = rcd->ln,
+				.kind = rcd->kind,
+				.addr = rcd->addr,
+				.data = rcd->buf->data,
+				.datasz = rcd->buf->len,
+			};
+			if (!fu_srec_firmware_parse_record (&helper, &rec, error))
 				return FALSE;
-			}
-
-			/* could be anything, lets assume text */
-			for (guint8 i = 0; i < rcd->buf->len; i++) {
-				gchar tmp = rcd->buf->data[i];
-				if (!g_ascii_isgraph (tmp))
-					break;
-				g_string_append_c (modname, tmp);
-			}
-			if (modname->len != 0)
-				fu_firmware_image_set_id (img, modname->str);
-			got_hdr = TRUE;
-			continue;
 		}
 
-		/* verify we got all records */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16) {
-			if (rcd->addr != data_cnt) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "count record was not valid, got 0x%02x expected 0x%02x at line %u",
-					     (guint) rcd->addr, (guint) data_cnt, rcd->ln);
+	/* or decode each line straight into the image */
+	} else {
+		const gchar *data;
+		const gchar *line = NULL;
+		const gchar *nul;
+		gboolean got_eof = FALSE;
+		gsize linesz = 0;
+		gsize offset = 0;
+		gsize sz = 0;
+
+		/* nothing after an embedded NUL is used */
+		data = g_bytes_get_data (fw, &sz);
+		nul = sz > 0 ? memchr (data, '\0', sz) : NULL;
+		if (nul != NULL)
+			sz = (gsize) (nul - data);
+
+		/* size the image from a pre-scan so the data is never reallocated */
+		outbuf = g_byte_array_sized_new (fu_srec_firmware_get_data_size (data, sz));
+		helper.outbuf = outbuf;
+		for (guint ln = 1; fu_srec_firmware_next_line (data, sz, &offset, &line, &linesz); ln++) {
+			FuSrecFirmwareLine rec = { 0x0 };
+			guint8 buf[G_MAXUINT8 + 1] = { 0x0 };
+
+			/* ignore blank lines */
+			if (linesz == 0)
+				continue;
+			if (!fu_srec_firmware_decode_line (line, linesz, ln, flags,
+							   buf, &rec, &got_eof, error))
 				return FALSE;
-			}
-			continue;
-		}
-
-		/* data */
-		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 ||
-		    rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 ||
-		    rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32) {
-			/* invalid */
-			if (!got_hdr) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "missing header record at line %u",
-					     rcd->ln);
+			if (!fu_srec_firmware_parse_record (&helper, &rec, error))
 				return FALSE;
-			}
+		}
 
-			/* does not make sense */
-			if (rcd->addr < addr32_last) {
-				g_set_error (error,
+		/* no EOF */
+		if (!got_eof) {
+			g_set_error_literal (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
-					     "invalid address 0x%x, last was 0x%x at line %u",
-					     (guint) rcd->addr,
-					     (guint) addr32_last,
-					     rcd->ln);
-				return FALSE;
-			}
-			if (rcd->addr < addr_start) {
-				g_debug ("ignoring data at 0x%x as before start address 0x%x at line %u",
-					 (guint) rcd->addr, (guint) addr_start, rcd->ln);
-			} else {
-				guint32 len_hole = rcd->addr - addr32_last;
-
-				/* fill any holes, but only up to 1Mb to avoid a DoS */
-				if (addr32_last > 0 && len_hole > 0x100000) {
-					g_set_error (error,
-						     FWUPD_ERROR,
-						     FWUPD_ERROR_INVALID_FILE,
-						     "hole of 0x%x bytes too large to fill at line %u",
-						     (guint) len_hole, rcd->ln);
-					return FALSE;
-				}
-				if (addr32_last > 0x0 && len_hole > 1) {
-					g_debug ("filling address 0x%08x to 0x%08x at line %u",
-						 addr32_last + 1, addr32_last + len_hole - 1, rcd->ln);
-					for (guint i = 0; i < len_hole; i++)
-						fu_byte_array_append_uint8 (outbuf, 0xff);
-				}
-
-				/* add data */
-				g_byte_array_append (outbuf, rcd->buf->data, rcd->buf->len);
-				if (img_address == 0x0)
-					img_address = rcd->addr;
-				addr32_last = rcd->addr + rcd->buf->len;
-			}
-			data_cnt++;
+					     "no EOF, perhaps truncated file");
+			return FALSE;
 		}
 	}
 
 	/* add single image */
-	img_bytes = g_bytes_new (outbuf->data, outbuf->len);
+	img_bytes = g_byte_array_free_to_bytes (g_steal_pointer (&outbuf));
 	fu_firmware_image_set_bytes (img, img_bytes);
-	fu_firmware_image_set_addr (img, img_address);
+	fu_firmware_image_set_addr (img, helper.img_address);
 	fu_firmware_add_image (firmware, img);
 	return TRUE;
 }
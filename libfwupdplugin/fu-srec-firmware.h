@@ -34,6 +34,8 @@ typedef struct {
 
 FuFirmware		*fu_srec_firmware_new		(void);
 GPtrArray		*fu_srec_firmware_get_records	(FuSrecFirmware	*self);
+void			 fu_srec_firmware_set_keep_records (FuSrecFirmware *self,
+							 gboolean	 keep_records);
 FuSrecFirmwareRecord	*fu_srec_firmware_record_new	(guint		 ln,
 							 FuFirmareSrecRecordKind kind,
 							 guint32	 addr);
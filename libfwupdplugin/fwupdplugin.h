@@ -17,6 +17,9 @@
 #include <libfwupdplugin/fu-chunk.h>
 #include <libfwupdplugin/fu-common.h>
 #include <libfwupdplugin/fu-common-cab.h>
+#include <libfwupdplugin/fu-common-checksum.h>
+#include <libfwupdplugin/fu-common-crc.h>
+#include <libfwupdplugin/fu-common-delta.h>
 #include <libfwupdplugin/fu-common-guid.h>
 #include <libfwupdplugin/fu-common-version.h>
 #include <libfwupdplugin/fu-device.h>
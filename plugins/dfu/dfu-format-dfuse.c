@@ -24,8 +24,9 @@ typedef struct __attribute__((packed)) {
 
 /**
  * dfu_element_from_dfuse: (skip)
- * @data: data buffer
- * @length: length of @data we can access
+ * @bytes: data buffer
+ * @offset: offset into @bytes
+ * @length: length of @bytes we can access from @offset
  * @consumed: (out): the number of bytes we consued
  * @error: a #GError, or %NULL
  *
@@ -34,13 +35,14 @@ typedef struct __attribute__((packed)) {
  * Returns: a #DfuElement, or %NULL for error
  **/
 static DfuElement *
-dfu_element_from_dfuse (const guint8 *data,
+dfu_element_from_dfuse (GBytes *bytes,
+			gsize offset,
 			guint32 length,
 			guint32 *consumed,
 			GError **error)
 {
 	DfuElement *element = NULL;
-	DfuSeElementPrefix *el = (DfuSeElementPrefix *) data;
+	DfuSeElementPrefix *el;
 	guint32 size;
 	g_autoptr(GBytes) contents = NULL;
 
@@ -57,6 +59,7 @@ dfu_element_from_dfuse (const guint8 *data,
 	}
 
 	/* check size */
+	el = (DfuSeElementPrefix *) ((const guint8 *) g_bytes_get_data (bytes, NULL) + offset);
 	size = GUINT32_FROM_LE (el->size);
 	if (size + sizeof(DfuSeElementPrefix) > length) {
 		g_set_error (error,
@@ -68,10 +71,14 @@ dfu_element_from_dfuse (const guint8 *data,
 		return NULL;
 	}
 
-	/* create new element */
+	/* create new element, referencing the data rather than copying it */
+	contents = fu_common_bytes_new_offset (bytes,
+					       offset + sizeof(DfuSeElementPrefix),
+					       size, error);
+	if (contents == NULL)
+		return NULL;
 	element = dfu_element_new ();
 	dfu_element_set_address (element, GUINT32_FROM_LE (el->address));
-	contents = g_bytes_new (data + sizeof(DfuSeElementPrefix), size);
 	dfu_element_set_contents (element, contents);
 
 	/* return size */
@@ -119,8 +126,9 @@ typedef struct __attribute__((packed)) {
 
 /**
  * dfu_image_from_dfuse: (skip)
- * @data: data buffer
- * @length: length of @data we can access
+ * @bytes: data buffer
+ * @offset: offset into @bytes
+ * @length: length of @bytes we can access from @offset
  * @consumed: (out): the number of bytes we consued
  * @error: a #GError, or %NULL
  *
@@ -129,14 +137,15 @@ typedef struct __attribute__((packed)) {
  * Returns: a #DfuImage, or %NULL for error
  **/
 static DfuImage *
-dfu_image_from_dfuse (const guint8 *data,
+dfu_image_from_dfuse (GBytes *bytes,
+		      gsize offset,
 		      guint32 length,
 		      guint32 *consumed,
 		      GError **error)
 {
 	DfuSeImagePrefix *im;
 	guint32 elements;
-	guint32 offset = sizeof(DfuSeImagePrefix);
+	guint32 offset_el = sizeof(DfuSeImagePrefix);
 	g_autoptr(DfuImage) image = NULL;
 
 	g_assert_cmpint(sizeof(DfuSeImagePrefix), ==, 274);
@@ -152,7 +161,7 @@ dfu_image_from_dfuse (const guint8 *data,
 	}
 
 	/* verify image signature */
-	im = (DfuSeImagePrefix *) data;
+	im = (DfuSeImagePrefix *) ((const guint8 *) g_bytes_get_data (bytes, NULL) + offset);
 	if (memcmp (im->sig, "Target", 6) != 0) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
@@ -168,23 +177,23 @@ dfu_image_from_dfuse (const guint8 *data,
 		dfu_image_set_name (image, im->target_name);
 
 	/* parse elements */
-	length -= offset;
+	length -= offset_el;
 	elements = GUINT32_FROM_LE (im->elements);
 	for (guint j = 0; j < elements; j++) {
 		guint32 consumed_local;
 		g_autoptr(DfuElement) element = NULL;
-		element = dfu_element_from_dfuse (data + offset, length,
+		element = dfu_element_from_dfuse (bytes, offset + offset_el, length,
 						  &consumed_local, error);
 		if (element == NULL)
 			return NULL;
 		dfu_image_add_element (image, element);
-		offset += consumed_local;
+		offset_el += consumed_local;
 		length -= consumed_local;
 	}
 
 	/* return size */
 	if (consumed != NULL)
-		*consumed = offset;
+		*consumed = offset_el;
 
 	return g_object_ref (image);
 }
@@ -380,7 +389,7 @@ dfu_firmware_from_dfuse (DfuFirmware *firmware,
 	for (guint i = 0; i < prefix->targets; i++) {
 		guint consumed;
 		g_autoptr(DfuImage) image = NULL;
-		image = dfu_image_from_dfuse (data + offset, (guint32) len,
+		image = dfu_image_from_dfuse (bytes, offset, (guint32) len,
 					      &consumed, error);
 		if (image == NULL)
 			return FALSE;
@@ -8,33 +8,21 @@
 
 #include <string.h>
 
-#include "fu-nitrokey-common.h"
+#include "fu-common-crc.h"
 
-static guint32
-fu_nitrokey_perform_crc32_mutate (guint32 crc, guint32 data)
-{
-	crc = crc ^ data;
-	for (guint i = 0; i < 32; i++) {
-		if (crc & 0x80000000) {
-			/* polynomial used in STM32 */
-			crc = (crc << 1) ^ 0x04C11DB7;
-		} else {
-			crc = (crc << 1);
-		}
-	}
-	return crc;
-}
+#include "fu-nitrokey-common.h"
 
+/* the STM32 CRC unit consumes 32 bit words MSB-first */
 guint32
 fu_nitrokey_perform_crc32 (const guint8 *data, gsize size)
 {
-	guint32 crc = 0xffffffff;
+	gsize words = (size + 3) / 4;
 	g_autofree guint32 *data_aligned = NULL;
 	data_aligned = g_new0 (guint32, (size / 4) + 1);
 	memcpy (data_aligned, data, size);
-	for (gsize idx = 0; idx * 4 < size; idx++) {
-		guint32 data_aligned_le = GUINT32_FROM_LE (data_aligned[idx]);
-		crc = fu_nitrokey_perform_crc32_mutate (crc, data_aligned_le);
-	}
-	return crc;
+	for (gsize idx = 0; idx < words; idx++)
+		data_aligned[idx] = GUINT32_TO_BE (GUINT32_FROM_LE (data_aligned[idx]));
+	return fu_common_crc32 (FU_CRC_KIND_B32_MPEG2,
+				(const guint8 *) data_aligned,
+				words * 4);
 }
@@ -311,7 +311,7 @@ fu_nvme_device_write_firmware (FuDevice *device,
 			       GError **error)
 {
 	FuNvmeDevice *self = FU_NVME_DEVICE (device);
-	g_autoptr(GBytes) fw2 = NULL;
+	gboolean force_align;
 	g_autoptr(GBytes) fw = NULL;
 	g_autoptr(GPtrArray) chunks = NULL;
 	guint64 block_size = self->write_block_size > 0 ?
@@ -324,14 +324,10 @@ fu_nvme_device_write_firmware (FuDevice *device,
 
 	/* some vendors provide firmware files whose sizes are not multiples
 	 * of blksz *and* the device won't accept blocks of different sizes */
-	if (fu_device_has_custom_flag (device, "force-align")) {
-		fw2 = fu_common_bytes_align (fw, block_size, 0xff);
-	} else {
-		fw2 = g_bytes_ref (fw);
-	}
+	force_align = fu_device_has_custom_flag (device, "force-align");
 
 	/* build packets */
-	chunks = fu_chunk_array_new_from_bytes (fw2,
+	chunks = fu_chunk_array_new_from_bytes (fw,
 						0x00,		/* start_addr */
 						0x00,		/* page_sz */
 						block_size);	/* block size */
@@ -340,10 +336,18 @@ fu_nvme_device_write_firmware (FuDevice *device,
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
 	for (guint i = 0; i < chunks->len; i++) {
 		FuChunk *chk = g_ptr_array_index (chunks, i);
+		g_autoptr(GBytes) blob = g_bytes_new_static (chk->data, chk->data_sz);
+
+		/* only the last block can be short, so pad just that one
+		 * rather than copying the entire image */
+		if (force_align && chk->data_sz < block_size) {
+			g_autoptr(GBytes) blob_tmp = g_steal_pointer (&blob);
+			blob = fu_common_bytes_pad (blob_tmp, block_size);
+		}
 		if (!fu_nvme_device_fw_download (self,
 						 chk->address,
-						 chk->data,
-						 chk->data_sz,
+						 g_bytes_get_data (blob, NULL),
+						 (guint32) g_bytes_get_size (blob),
 						 error)) {
 			g_prefix_error (error, "failed to write chunk %u: ", i);
 			return FALSE;
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include "fu-rom.h"
+
+int		 LLVMFuzzerTestOneInput		(const guint8	*data,
+						 gsize		 size);
+
+int
+LLVMFuzzerTestOneInput (const guint8 *data, gsize size)
+{
+	g_autoptr(FuRom) rom = fu_rom_new ();
+	g_autofree guint8 *buf = g_memdup (data, size);
+
+	fu_rom_load_data (rom, buf, size, FU_ROM_LOAD_FLAG_BLANK_PPID, NULL, NULL);
+	return 0;
+}
@@ -279,6 +279,8 @@ fu_synaptics_cxaudio_firmware_parse (FuFirmware *firmware,
 static void
 fu_synaptics_cxaudio_firmware_init (FuSynapticsCxaudioFirmware *self)
 {
+	/* the EEPROM shadow and patch records are used directly */
+	fu_srec_firmware_set_keep_records (FU_SREC_FIRMWARE (self), TRUE);
 }
 
 static void
@@ -97,9 +97,11 @@ fu_synaprom_firmware_parse (FuFirmware *firmware,
 			return FALSE;
 		}
 
-		/* move pointer to data */
+		/* move pointer to data, which is referenced rather than copied */
 		buf += sizeof(header);
-		bytes = g_bytes_new (buf, hdrsz);
+		bytes = fu_common_bytes_new_offset (fw, offset - hdrsz, hdrsz, error);
+		if (bytes == NULL)
+			return FALSE;
 		g_debug ("adding 0x%04x (%s) with size 0x%04x",
 			 tag,
 			 fu_synaprom_firmware_tag_to_string (tag),
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include "fu-tpm-eventlog-parser.h"
+
+int		 LLVMFuzzerTestOneInput		(const guint8	*data,
+						 gsize		 size);
+
+int
+LLVMFuzzerTestOneInput (const guint8 *data, gsize size)
+{
+	g_autoptr(GPtrArray) items = NULL;
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	items = fu_tpm_eventlog_parser_new (data, size,
+					    FU_TPM_EVENTLOG_PARSER_FLAG_ALL_PCRS |
+					    FU_TPM_EVENTLOG_PARSER_FLAG_ALL_ALGS,
+					    NULL);
+	if (items == NULL)
+		return 0;
+	for (guint i = 0; i < items->len; i++) {
+		FuTpmEventlogItem *item = g_ptr_array_index (items, i);
+		fu_tpm_eventlog_item_to_string (item, 0, str);
+	}
+	return 0;
+}
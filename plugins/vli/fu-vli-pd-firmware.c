@@ -7,6 +7,8 @@
 
 #include "config.h"
 
+#include "fu-common-crc.h"
+
 #include "fu-vli-pd-common.h"
 #include "fu-vli-pd-firmware.h"
 
@@ -136,7 +138,7 @@ fu_vli_pd_firmware_parse (FuFirmware *firmware,
 			g_prefix_error (error, "failed to read file CRC: ");
 			return FALSE;
 		}
-		crc_actual = fu_vli_common_crc16 (buf, bufsz - 2);
+		crc_actual = fu_common_crc16 (FU_CRC_KIND_B16_USB, buf, bufsz - 2);
 		if (crc_actual != crc_file) {
 			g_set_error (error,
 				     FWUPD_ERROR,
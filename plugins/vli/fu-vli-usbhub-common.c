@@ -7,12 +7,15 @@
 
 #include "config.h"
 
+#include "fu-common-crc.h"
+
 #include "fu-vli-usbhub-common.h"
 
 guint8
 fu_vli_usbhub_header_crc8 (FuVliUsbhubHeader *hdr)
 {
-	return fu_vli_common_crc8 ((const guint8 *) hdr, sizeof(*hdr) - 1);
+	return fu_common_crc8 (FU_CRC_KIND_B8_SMBUS,
+			       (const guint8 *) hdr, sizeof(*hdr) - 1);
 }
 
 void
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuAuthCache"
+
+#include "config.h"
+
+#include "fu-auth-cache.h"
+
+/* polkit keeps auth_admin_keep results for the same length of time */
+#define FU_AUTH_CACHE_MAX_AGE			(5 * 60 * G_USEC_PER_SEC)
+
+static void fu_auth_cache_finalize	 (GObject *obj);
+
+struct _FuAuthCache
+{
+	GObject			 parent_instance;
+	GHashTable		*items;		/* sender:action_id : FuAuthCacheItem */
+	gint64			 max_age;	/* us */
+};
+
+typedef struct {
+	gchar			*sender;
+	gint64			 expiry;	/* us, monotonic */
+} FuAuthCacheItem;
+
+G_DEFINE_TYPE (FuAuthCache, fu_auth_cache, G_TYPE_OBJECT)
+
+static void
+fu_auth_cache_item_free (FuAuthCacheItem *item)
+{
+	g_free (item->sender);
+	g_free (item);
+}
+
+static gboolean
+fu_auth_cache_item_is_expired_cb (gpointer key, gpointer value, gpointer user_data)
+{
+	FuAuthCacheItem *item = (FuAuthCacheItem *) value;
+	gint64 now = *((gint64 *) user_data);
+	return now >= item->expiry;
+}
+
+/**
+ * fu_auth_cache_set_max_age:
+ * @self: A #FuAuthCache
+ * @max_age: time in µs
+ *
+ * Sets how long an authorization is remembered for.
+ **/
+void
+fu_auth_cache_set_max_age (FuAuthCache *self, gint64 max_age)
+{
+	g_return_if_fail (FU_IS_AUTH_CACHE (self));
+	self->max_age = max_age;
+}
+
+/**
+ * fu_auth_cache_add:
+ * @self: A #FuAuthCache
+ * @sender: A D-Bus unique name, e.g. `:1.23`
+ * @action_id: A polkit action ID
+ *
+ * Remembers that @sender was authorized for @action_id. Any expired
+ * authorizations are also forgotten.
+ **/
+void
+fu_auth_cache_add (FuAuthCache *self, const gchar *sender, const gchar *action_id)
+{
+	FuAuthCacheItem *item;
+	gint64 now = g_get_monotonic_time ();
+
+	g_return_if_fail (FU_IS_AUTH_CACHE (self));
+	g_return_if_fail (sender != NULL);
+	g_return_if_fail (action_id != NULL);
+
+	g_hash_table_foreach_remove (self->items, fu_auth_cache_item_is_expired_cb, &now);
+	item = g_new0 (FuAuthCacheItem, 1);
+	item->sender = g_strdup (sender);
+	item->expiry = now + self->max_age;
+	g_hash_table_insert (self->items,
+			     g_strdup_printf ("%s:%s", sender, action_id),
+			     item);
+}
+
+/**
+ * fu_auth_cache_lookup:
+ * @self: A #FuAuthCache
+ * @sender: A D-Bus unique name, e.g. `:1.23`
+ * @action_id: A polkit action ID
+ *
+ * Finds out if @sender was recently authorized for @action_id.
+ *
+ * Returns: %TRUE if the authorization has not expired
+ **/
+gboolean
+fu_auth_cache_lookup (FuAuthCache *self, const gchar *sender, const gchar *action_id)
+{
+	FuAuthCacheItem *item;
+	g_autofree gchar *key = NULL;
+
+	g_return_val_if_fail (FU_IS_AUTH_CACHE (self), FALSE);
+	g_return_val_if_fail (sender != NULL, FALSE);
+	g_return_val_if_fail (action_id != NULL, FALSE);
+
+	key = g_strdup_printf ("%s:%s", sender, action_id);
+	item = g_hash_table_lookup (self->items, key);
+	if (item == NULL)
+		return FALSE;
+	if (g_get_monotonic_time () >= item->expiry) {
+		g_hash_table_remove (self->items, key);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_auth_cache_has_sender:
+ * @self: A #FuAuthCache
+ * @sender: A D-Bus unique name, e.g. `:1.23`
+ *
+ * Finds out if any authorizations are remembered for @sender, even if they
+ * have expired.
+ *
+ * Returns: %TRUE if found
+ **/
+gboolean
+fu_auth_cache_has_sender (FuAuthCache *self, const gchar *sender)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_return_val_if_fail (FU_IS_AUTH_CACHE (self), FALSE);
+	g_return_val_if_fail (sender != NULL, FALSE);
+
+	g_hash_table_iter_init (&iter, self->items);
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		FuAuthCacheItem *item = (FuAuthCacheItem *) value;
+		if (g_strcmp0 (item->sender, sender) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static gboolean
+fu_auth_cache_item_has_sender_cb (gpointer key, gpointer value, gpointer user_data)
+{
+	FuAuthCacheItem *item = (FuAuthCacheItem *) value;
+	return g_strcmp0 (item->sender, (const gchar *) user_data) == 0;
+}
+
+/**
+ * fu_auth_cache_remove_sender:
+ * @self: A #FuAuthCache
+ * @sender: A D-Bus unique name, e.g. `:1.23`
+ *
+ * Forgets all the authorizations for @sender, typically because it has
+ * disconnected from the bus.
+ *
+ * Returns: the number of authorizations removed
+ **/
+guint
+fu_auth_cache_remove_sender (FuAuthCache *self, const gchar *sender)
+{
+	g_return_val_if_fail (FU_IS_AUTH_CACHE (self), 0);
+	g_return_val_if_fail (sender != NULL, 0);
+	return g_hash_table_foreach_remove (self->items,
+					    fu_auth_cache_item_has_sender_cb,
+					    (gpointer) sender);
+}
+
+static void
+fu_auth_cache_class_init (FuAuthCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_auth_cache_finalize;
+}
+
+static void
+fu_auth_cache_init (FuAuthCache *self)
+{
+	self->max_age = FU_AUTH_CACHE_MAX_AGE;
+	self->items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+					     (GDestroyNotify) fu_auth_cache_item_free);
+}
+
+static void
+fu_auth_cache_finalize (GObject *obj)
+{
+	FuAuthCache *self = FU_AUTH_CACHE (obj);
+
+	g_hash_table_unref (self->items);
+
+	G_OBJECT_CLASS (fu_auth_cache_parent_class)->finalize (obj);
+}
+
+FuAuthCache *
+fu_auth_cache_new (void)
+{
+	FuAuthCache *self;
+	self = g_object_new (FU_TYPE_AUTH_CACHE, NULL);
+	return FU_AUTH_CACHE (self);
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#define FU_TYPE_AUTH_CACHE (fu_auth_cache_get_type ())
+G_DECLARE_FINAL_TYPE (FuAuthCache, fu_auth_cache, FU, AUTH_CACHE, GObject)
+
+FuAuthCache	*fu_auth_cache_new		(void);
+void		 fu_auth_cache_set_max_age	(FuAuthCache	*self,
+						 gint64		 max_age);
+void		 fu_auth_cache_add		(FuAuthCache	*self,
+						 const gchar	*sender,
+						 const gchar	*action_id);
+gboolean	 fu_auth_cache_lookup		(FuAuthCache	*self,
+						 const gchar	*sender,
+						 const gchar	*action_id);
+gboolean	 fu_auth_cache_has_sender	(FuAuthCache	*self,
+						 const gchar	*sender);
+guint		 fu_auth_cache_remove_sender	(FuAuthCache	*self,
+						 const gchar	*sender);
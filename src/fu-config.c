@@ -32,6 +32,7 @@ struct _FuConfig
 	GPtrArray		*approved_firmware;	/* (element-type utf-8) */
 	guint64			 archive_size_max;
 	guint			 idle_timeout;
+	guint			 progress_interval;	/* ms */
 	gchar			*config_file;
 	gboolean		 update_motd;
 	gboolean		 enumerate_all_devices;
@@ -51,6 +52,7 @@ fu_config_reload (FuConfig *self, GError **error)
 {
 	guint64 archive_size_max;
 	guint idle_timeout;
+	guint64 progress_interval;
 	g_auto(GStrv) approved_firmware = NULL;
 	g_auto(GStrv) devices = NULL;
 	g_auto(GStrv) plugins = NULL;
@@ -58,6 +60,7 @@ fu_config_reload (FuConfig *self, GError **error)
 	g_autoptr(GKeyFile) keyfile = g_key_file_new ();
 	g_autoptr(GError) error_update_motd = NULL;
 	g_autoptr(GError) error_enumerate_all = NULL;
+	g_autoptr(GError) error_progress_interval = NULL;
 
 	g_debug ("loading config values from %s", self->config_file);
 	if (!g_key_file_load_from_file (keyfile, self->config_file,
@@ -122,6 +125,14 @@ fu_config_reload (FuConfig *self, GError **error)
 	if (idle_timeout > 0)
 		self->idle_timeout = idle_timeout;
 
+	/* get the minimum time between progress updates, where 0 is unlimited */
+	progress_interval = g_key_file_get_uint64 (keyfile,
+						   "fwupd",
+						   "ProgressUpdateInterval",
+						   &error_progress_interval);
+	if (error_progress_interval == NULL)
+		self->progress_interval = progress_interval;
+
 	/* get the domains to run in verbose */
 	domains = g_key_file_get_string (keyfile,
 					 "fwupd",
@@ -220,6 +231,13 @@ fu_config_get_idle_timeout (FuConfig *self)
 	return self->idle_timeout;
 }
 
+guint
+fu_config_get_progress_interval (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->progress_interval;
+}
+
 GPtrArray *
 fu_config_get_blacklist_devices (FuConfig *self)
 {
@@ -279,6 +297,7 @@ static void
 fu_config_init (FuConfig *self)
 {
 	self->archive_size_max = 512 * 0x100000;
+	self->progress_interval = 250;
 	self->blacklist_devices = g_ptr_array_new_with_free_func (g_free);
 	self->blacklist_plugins = g_ptr_array_new_with_free_func (g_free);
 	self->approved_firmware = g_ptr_array_new_with_free_func (g_free);
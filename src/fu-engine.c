@@ -13,6 +13,7 @@
 #include <gio/gunixinputstream.h>
 #endif
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #ifdef HAVE_GUDEV
 #include <gudev/gudev.h>
 #endif
@@ -21,8 +22,12 @@
 #include <sys/utsname.h>
 #endif
 #include <errno.h>
+#ifdef HAVE_MALLOC_TRIM
+#include <malloc.h>
+#endif
 
 #include "fwupd-common-private.h"
+#include "fwupd-device-private.h"
 #include "fwupd-enums-private.h"
 #include "fwupd-error.h"
 #include "fwupd-release-private.h"
@@ -31,6 +36,8 @@
 
 #include "fu-cabinet.h"
 #include "fu-common-cab.h"
+#include "fu-common-checksum.h"
+#include "fu-common-delta.h"
 #include "fu-common.h"
 #include "fu-config.h"
 #include "fu-debug.h"
@@ -62,6 +69,9 @@
 #endif
 
 static void fu_engine_finalize	 (GObject *obj);
+static gboolean fu_engine_load_metadata_store (FuEngine *self,
+					       FuEngineLoadFlags flags,
+					       GError **error);
 
 struct _FuEngine
 {
@@ -77,6 +87,7 @@ struct _FuEngine
 	FwupdStatus		 status;
 	gboolean		 tainted;
 	guint			 percentage;
+	GPtrArray		*composite_progress;	/* (element-type FuEngineCompositeProgress) */
 	FuHistory		*history;
 	FuIdle			*idle;
 	XbSilo			*silo;
@@ -98,9 +109,28 @@ struct _FuEngine
 	GHashTable		*firmware_gtypes;
 	gchar			*host_machine_id;
 	JcatContext		*jcat_context;
+	GQueue			*cabinet_cache;	/* (element-type FuEngineCabinetCacheItem), most recent first */
+	guint64			 cabinet_cache_size;
+	guint64			 cabinet_cache_size_max;
+	guint			 cabinet_cache_id;
 	gboolean		 loaded;
+	FuEngineLoadFlags	 load_flags;
 };
 
+/* clients usually call GetDetails and then Install for the same archive; the
+ * size limit only counts the archive bytes, and not any payloads that have
+ * been decompressed from a cached archive */
+#define FU_ENGINE_CABINET_CACHE_MAX		4
+#define FU_ENGINE_CABINET_CACHE_SIZE_MAX	(64 * 1024 * 1024)	/* bytes */
+#define FU_ENGINE_CABINET_CACHE_TIMEOUT		300			/* s */
+#define FU_ENGINE_INSTALLED_IMAGE_MAX_AGE	(90 * 24 * 60 * 60)	/* s */
+
+typedef struct {
+	gchar			*checksum;
+	XbSilo			*silo;
+	guint64			 size;
+} FuEngineCabinetCacheItem;
+
 enum {
 	SIGNAL_CHANGED,
 	SIGNAL_DEVICE_ADDED,
@@ -113,8 +143,104 @@ enum {
 
 static guint signals[SIGNAL_LAST] = { 0 };
 
+typedef struct {
+	gchar			*device_id;
+	guint			 weight;
+	guint			 progress;	/* highest seen, as each phase restarts at 0 */
+	gboolean		 done;
+} FuEngineCompositeProgress;
+
 G_DEFINE_TYPE (FuEngine, fu_engine, G_TYPE_OBJECT)
 
+static void
+fu_engine_cabinet_cache_item_free (FuEngineCabinetCacheItem *item)
+{
+	g_free (item->checksum);
+	g_object_unref (item->silo);
+	g_free (item);
+}
+
+/* drops the least recently used archives until within both limits */
+static void
+fu_engine_cabinet_cache_prune (FuEngine *self, guint max_items, guint64 max_size)
+{
+	while (g_queue_get_length (self->cabinet_cache) > max_items ||
+	       self->cabinet_cache_size > max_size) {
+		FuEngineCabinetCacheItem *item = g_queue_pop_tail (self->cabinet_cache);
+		if (item == NULL)
+			break;
+		g_debug ("evicting archive %s from cache", item->checksum);
+		self->cabinet_cache_size -= item->size;
+		fu_engine_cabinet_cache_item_free (item);
+	}
+}
+
+static void
+fu_engine_cabinet_cache_clear (FuEngine *self)
+{
+	fu_engine_cabinet_cache_prune (self, 0, 0);
+	if (self->cabinet_cache_id != 0) {
+		g_source_remove (self->cabinet_cache_id);
+		self->cabinet_cache_id = 0;
+	}
+}
+
+static gboolean
+fu_engine_cabinet_cache_timeout_cb (gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	g_debug ("clearing unused archives from cache");
+	self->cabinet_cache_id = 0;
+	fu_engine_cabinet_cache_clear (self);
+	return G_SOURCE_REMOVE;
+}
+
+/* the cache is only useful for a GetDetails followed by an Install */
+static void
+fu_engine_cabinet_cache_touch (FuEngine *self)
+{
+	if (self->cabinet_cache_id != 0)
+		g_source_remove (self->cabinet_cache_id);
+	self->cabinet_cache_id = g_timeout_add_seconds (FU_ENGINE_CABINET_CACHE_TIMEOUT,
+							fu_engine_cabinet_cache_timeout_cb,
+							self);
+}
+
+/**
+ * fu_engine_set_cabinet_cache_size_max:
+ * @self: A #FuEngine
+ * @size_max: maximum total size of the cached archives in bytes
+ *
+ * Sets the total size of the archives that can be kept after they have been
+ * parsed. Only the archive bytes are counted, and not the firmware payloads
+ * that have been decompressed from them.
+ **/
+void
+fu_engine_set_cabinet_cache_size_max (FuEngine *self, guint64 size_max)
+{
+	g_return_if_fail (FU_IS_ENGINE (self));
+	self->cabinet_cache_size_max = size_max;
+	fu_engine_cabinet_cache_prune (self, FU_ENGINE_CABINET_CACHE_MAX, size_max);
+}
+
+/* the silo may have been dropped under memory pressure; if it cannot be
+ * reloaded then this is tried again on the next call */
+static XbSilo *
+fu_engine_get_metadata_silo (FuEngine *self, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (self->silo != NULL)
+		return self->silo;
+	if (!fu_engine_load_metadata_store (self, self->load_flags, &error_local)) {
+		g_warning ("failed to reload metadata: %s", error_local->message);
+		g_clear_object (&self->silo);
+		g_propagate_prefixed_error (error, g_steal_pointer (&error_local),
+					    "failed to reload metadata: ");
+		return NULL;
+	}
+	return self->silo;
+}
+
 static void
 fu_engine_emit_changed (FuEngine *self)
 {
@@ -193,18 +319,146 @@ fu_engine_set_percentage (FuEngine *self, guint percentage)
 {
 	if (self->percentage == percentage)
 		return;
+
+	/* a new phase on one device does not move the composite update backwards */
+	if (self->composite_progress != NULL && percentage < self->percentage)
+		return;
 	self->percentage = percentage;
 
 	/* emit changed */
 	g_signal_emit (self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, percentage);
 }
 
+static void
+fu_engine_composite_progress_free (FuEngineCompositeProgress *item)
+{
+	g_free (item->device_id);
+	g_free (item);
+}
+
+static void
+fu_engine_composite_progress_setup (FuEngine *self, GPtrArray *install_tasks)
+{
+	gboolean use_duration = TRUE;
+
+	/* weight by the expected install duration, but only if all are set */
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		FuDevice *device = fu_install_task_get_device (task);
+		if (fu_device_get_install_duration (device) == 0) {
+			use_duration = FALSE;
+			break;
+		}
+	}
+	if (self->composite_progress != NULL)
+		g_ptr_array_unref (self->composite_progress);
+	self->composite_progress = NULL;
+	fu_engine_set_percentage (self, 0);
+	self->composite_progress = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_engine_composite_progress_free);
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		FuDevice *device = fu_install_task_get_device (task);
+		FuEngineCompositeProgress *item = g_new0 (FuEngineCompositeProgress, 1);
+		item->device_id = g_strdup (fu_device_get_id (device));
+		item->weight = use_duration ? fu_device_get_install_duration (device) : 1;
+		g_ptr_array_add (self->composite_progress, item);
+	}
+}
+
+static void
+fu_engine_composite_progress_clear (FuEngine *self)
+{
+	if (self->composite_progress == NULL)
+		return;
+	g_ptr_array_unref (self->composite_progress);
+	self->composite_progress = NULL;
+}
+
+/* progress is often reported by a child or proxy of the device that is in the
+ * composite update, e.g. a bootloader or the hub it is attached to */
+static FuEngineCompositeProgress *
+fu_engine_composite_progress_find (FuEngine *self, FuDevice *device)
+{
+	FuDevice *device_tmp = device;
+
+	for (guint depth = 0; device_tmp != NULL && depth < 16; depth++) {
+		for (guint i = 0; i < self->composite_progress->len; i++) {
+			FuEngineCompositeProgress *item = g_ptr_array_index (self->composite_progress, i);
+			if (g_strcmp0 (item->device_id, fu_device_get_id (device_tmp)) == 0)
+				return item;
+		}
+		if (fu_device_get_parent (device_tmp) != NULL)
+			device_tmp = fu_device_get_parent (device_tmp);
+		else
+			device_tmp = fu_device_get_proxy (device_tmp);
+	}
+	return NULL;
+}
+
+/* returns the weighted percentage of all the devices in the composite update,
+ * which only gets to 100% when every install task has completed */
+static guint
+fu_engine_composite_progress_get (FuEngine *self)
+{
+	gboolean all_done = TRUE;
+	guint64 done = 0;
+	guint64 total = 0;
+	guint percentage;
+
+	for (guint i = 0; i < self->composite_progress->len; i++) {
+		FuEngineCompositeProgress *item = g_ptr_array_index (self->composite_progress, i);
+		done += (guint64) item->weight * item->progress;
+		total += item->weight;
+		if (!item->done)
+			all_done = FALSE;
+	}
+	if (all_done)
+		return 100;
+	percentage = total > 0 ? (guint) (done / total) : 0;
+	return MIN (percentage, 99);
+}
+
+/* returns the composite percentage, or just the device percentage if not part
+ * of a composite update */
+static guint
+fu_engine_composite_progress_update (FuEngine *self, FuDevice *device, guint progress)
+{
+	FuEngineCompositeProgress *item;
+
+	if (self->composite_progress == NULL)
+		return progress;
+
+	/* an unrelated device does not change the composite percentage */
+	item = fu_engine_composite_progress_find (self, device);
+	if (item != NULL && !item->done)
+		item->progress = MAX (item->progress, MIN (progress, 100));
+	return fu_engine_composite_progress_get (self);
+}
+
+/* the install task at @idx has completed, which is matched by position as the
+ * device may have been replugged with a different ID */
+static guint
+fu_engine_composite_progress_done (FuEngine *self, guint idx)
+{
+	FuEngineCompositeProgress *item;
+
+	if (self->composite_progress == NULL)
+		return 100;
+	item = g_ptr_array_index (self->composite_progress, idx);
+	item->progress = 100;
+	item->done = TRUE;
+	return fu_engine_composite_progress_get (self);
+}
+
 static void
 fu_engine_progress_notify_cb (FuDevice *device, GParamSpec *pspec, FuEngine *self)
 {
+	guint percentage;
 	if (fu_device_get_status (device) == FWUPD_STATUS_UNKNOWN)
 		return;
-	fu_engine_set_percentage (self, fu_device_get_progress (device));
+	percentage = fu_engine_composite_progress_update (self, device,
+							  fu_device_get_progress (device));
+	fu_engine_set_percentage (self, percentage);
 	fu_engine_emit_device_changed (self, device);
 }
 
@@ -444,12 +698,15 @@ fu_engine_set_release_from_appstream (FuEngine *self,
 static const gchar *
 fu_engine_get_remote_id_for_checksum (FuEngine *self, const gchar *csum)
 {
+	XbSilo *silo = fu_engine_get_metadata_silo (self, NULL);
 	g_autofree gchar *xpath = NULL;
 	g_autoptr(XbNode) key = NULL;
+	if (silo == NULL)
+		return NULL;
 	xpath = g_strdup_printf ("components/component/releases/release/"
 				 "checksum[@target='container'][text()='%s']/../../"
 				 "../../custom/value[@key='fwupd::RemoteId']", csum);
-	key = xb_silo_query_first (self->silo, xpath, NULL);
+	key = xb_silo_query_first (silo, xpath, NULL);
 	if (key == NULL)
 		return NULL;
 	return xb_node_get_text (key);
@@ -505,6 +762,7 @@ fu_engine_modify_config (FuEngine *self, const gchar *key, const gchar *value, G
 		"BlacklistDevices",
 		"BlacklistPlugins",
 		"IdleTimeout",
+		"ProgressUpdateInterval",
 		"VerboseDomains",
 		"UpdateMotd",
 		"EnumerateAllDevices",
@@ -743,6 +1001,7 @@ XbNode *
 fu_engine_get_component_by_guids (FuEngine *self, FuDevice *device)
 {
 	GPtrArray *guids = fu_device_get_guids (device);
+	XbSilo *silo;
 	g_autoptr(GString) xpath = g_string_new (NULL);
 	g_autoptr(XbNode) component = NULL;
 	for (guint i = 0; i < guids->len; i++) {
@@ -752,7 +1011,10 @@ fu_engine_get_component_by_guids (FuEngine *self, FuDevice *device)
 					"provides/firmware[@type='flashed'][text()='%s']/"
 					"../..", guid);
 	}
-	component = xb_silo_query_first (self->silo, xpath->str, NULL);
+	silo = fu_engine_get_metadata_silo (self, NULL);
+	if (silo == NULL)
+		return NULL;
+	component = xb_silo_query_first (silo, xpath->str, NULL);
 	if (component != NULL)
 		return g_steal_pointer (&component);
 	return NULL;
@@ -835,13 +1097,17 @@ fu_engine_verify (FuEngine *self, const gchar *device_id, GError **error)
 		FwupdVersionFormat fmt = fu_device_get_version_format (device);
 		for (guint i = 0; i < guids->len; i++) {
 			const gchar *guid = g_ptr_array_index (guids, i);
+			XbSilo *silo;
 			g_autofree gchar *xpath2 = NULL;
 			g_autoptr(GPtrArray) releases = NULL;
 			xpath2 = g_strdup_printf ("components/component/"
 						  "provides/firmware[@type='flashed'][text()='%s']/"
 						  "../../releases/release",
 						  guid);
-			releases = xb_silo_query (self->silo, xpath2, 0, error);
+			silo = fu_engine_get_metadata_silo (self, error);
+			if (silo == NULL)
+				return FALSE;
+			releases = xb_silo_query (silo, xpath2, 0, error);
 			if (releases == NULL)
 				return FALSE;
 			for (guint j = 0; j < releases->len; j++) {
@@ -1464,18 +1730,26 @@ fu_engine_install_tasks (FuEngine *self,
 		return FALSE;
 	}
 
+	/* show one percentage for the entire composite update */
+	if (install_tasks->len > 1)
+		fu_engine_composite_progress_setup (self, install_tasks);
+
 	/* all authenticated, so install all the things */
 	for (guint i = 0; i < install_tasks->len; i++) {
 		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
 		if (!fu_engine_install (self, task, blob_cab, flags, error)) {
 			g_autoptr(GError) error_local = NULL;
+			fu_engine_composite_progress_clear (self);
 			if (!fu_engine_composite_cleanup (self, devices, &error_local)) {
 				g_warning ("failed to cleanup failed composite action: %s",
 					   error_local->message);
 			}
 			return FALSE;
 		}
+		fu_engine_set_percentage (self,
+					  fu_engine_composite_progress_done (self, i));
 	}
+	fu_engine_composite_progress_clear (self);
 
 	/* set all the device statuses back to unknown */
 	for (guint i = 0; i < install_tasks->len; i++) {
@@ -1727,6 +2001,137 @@ fu_engine_schedule_update (FuEngine *self,
 	return fu_engine_offline_setup (error);
 }
 
+/* the image written by the last successful install, used as a delta source */
+static gchar *
+fu_engine_get_installed_image_filename (FuDevice *device)
+{
+	g_autofree gchar *cachedir = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *basename = g_strdup_printf ("%s.bin", fu_device_get_id (device));
+	return g_build_filename (cachedir, "installed", basename, NULL);
+}
+
+/* delete images for devices that have not been updated for a long time */
+static void
+fu_engine_prune_installed_images (const gchar *filename_keep)
+{
+	const gchar *fn;
+	gint64 now = g_get_real_time () / G_USEC_PER_SEC;
+	g_autofree gchar *dirname = g_path_get_dirname (filename_keep);
+	g_autoptr(GDir) dir = NULL;
+
+	dir = g_dir_open (dirname, 0, NULL);
+	if (dir == NULL)
+		return;
+	while ((fn = g_dir_read_name (dir)) != NULL) {
+		GStatBuf buf = { 0x0 };
+		g_autofree gchar *filename = g_build_filename (dirname, fn, NULL);
+		if (!g_str_has_suffix (fn, ".bin"))
+			continue;
+		if (g_strcmp0 (filename, filename_keep) == 0)
+			continue;
+		if (g_stat (filename, &buf) != 0)
+			continue;
+		if (now - (gint64) buf.st_mtime < FU_ENGINE_INSTALLED_IMAGE_MAX_AGE)
+			continue;
+		g_debug ("pruning installed image %s", filename);
+		if (g_unlink (filename) != 0)
+			g_debug ("failed to delete %s", filename);
+	}
+}
+
+/* only devices being sent deltas need the image, as the vendor is likely to
+ * ship the next release as a delta against it too */
+static void
+fu_engine_save_installed_image (FuDevice *device, GBytes *blob, gboolean is_delta)
+{
+	g_autofree gchar *fn = fu_engine_get_installed_image_filename (device);
+	g_autoptr(GError) error_local = NULL;
+
+	/* any old image no longer matches what is on the device */
+	if (!is_delta) {
+		if (g_file_test (fn, G_FILE_TEST_EXISTS) && g_unlink (fn) != 0)
+			g_debug ("failed to delete %s", fn);
+		return;
+	}
+	if (!fu_common_mkdir_parent (fn, &error_local) ||
+	    !fu_common_set_contents_bytes (fn, blob, &error_local)) {
+		g_debug ("failed to save installed image: %s", error_local->message);
+		return;
+	}
+	fu_engine_prune_installed_images (fn);
+}
+
+static GBytes *
+fu_engine_get_delta_source (FuEngine *self,
+			    FuDevice *device,
+			    const gchar *checksum,
+			    GError **error)
+{
+	g_autofree gchar *fn = fu_engine_get_installed_image_filename (device);
+	g_autoptr(GBytes) blob = NULL;
+
+	/* prefer the cached copy as reading back can be slow */
+	if (g_file_test (fn, G_FILE_TEST_EXISTS)) {
+		g_autoptr(GError) error_local = NULL;
+		blob = fu_common_get_contents_bytes (fn, &error_local);
+		if (blob == NULL) {
+			g_debug ("failed to load %s: %s", fn, error_local->message);
+		} else {
+			g_autofree gchar *csum = NULL;
+			csum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+			if (g_strcmp0 (csum, checksum) == 0)
+				return g_steal_pointer (&blob);
+			g_debug ("%s is %s, delta requires %s", fn, csum, checksum);
+		}
+	}
+
+	/* the delta verifies this matches */
+	blob = fu_engine_firmware_read (self, device, FWUPD_INSTALL_FLAG_NONE, error);
+	if (blob == NULL) {
+		g_prefix_error (error, "no installed image for delta: ");
+		return NULL;
+	}
+	return g_steal_pointer (&blob);
+}
+
+static GBytes *
+fu_engine_firmware_delta_apply (FuEngine *self,
+				FuDevice *device,
+				XbNode *rel,
+				GBytes *blob_delta,
+				GError **error)
+{
+	const gchar *csum_content;
+	g_autofree gchar *source_checksum = NULL;
+	g_autoptr(GBytes) blob_src = NULL;
+	g_autoptr(GBytes) blob_dst = NULL;
+
+	if (!fu_common_delta_parse_header (blob_delta, &source_checksum, NULL, NULL, error))
+		return NULL;
+	blob_src = fu_engine_get_delta_source (self, device, source_checksum, error);
+	if (blob_src == NULL)
+		return NULL;
+	blob_dst = fu_common_delta_apply (blob_src, blob_delta, error);
+	if (blob_dst == NULL)
+		return NULL;
+
+	/* the cabinet could not check the full-image checksum */
+	csum_content = xb_node_query_text (rel, "checksum[@target='content']", NULL);
+	if (csum_content != NULL) {
+		GChecksumType kind = fwupd_checksum_guess_kind (csum_content);
+		g_autofree gchar *csum = g_compute_checksum_for_bytes (kind, blob_dst);
+		if (g_strcmp0 (csum, csum_content) != 0) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "reconstructed checksum invalid, expected %s, got %s",
+				     csum_content, csum);
+			return NULL;
+		}
+	}
+	return g_steal_pointer (&blob_dst);
+}
+
 static gboolean
 fu_engine_install_release (FuEngine *self,
 			   FuDevice *device_orig,
@@ -1744,10 +2149,23 @@ fu_engine_install_release (FuEngine *self,
 	g_autoptr(FuDevice) device_tmp = NULL;
 	g_autoptr(FuDevice) device = g_object_ref (device_orig);
 	g_autoptr(GBytes) blob_fw2 = NULL;
+	g_autoptr(GBytes) blob_fw_delta = NULL;
 	g_autoptr(GError) error_local = NULL;
 
-	/* get per-release firmware blob */
+	/* get per-release firmware blob, reconstructing it if required */
+	if (!fu_cabinet_load_release (rel, error))
+		return FALSE;
 	blob_fw = xb_node_get_data (rel, "fwupd::FirmwareBlob");
+	if (blob_fw == NULL) {
+		GBytes *blob_delta = xb_node_get_data (rel, "fwupd::FirmwareDelta");
+		if (blob_delta != NULL) {
+			blob_fw_delta = fu_engine_firmware_delta_apply (self, device, rel,
+									blob_delta, error);
+			if (blob_fw_delta == NULL)
+				return FALSE;
+			blob_fw = blob_fw_delta;
+		}
+	}
 	if (blob_fw == NULL) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
@@ -1829,6 +2247,9 @@ fu_engine_install_release (FuEngine *self,
 		g_propagate_error (error, g_steal_pointer (&error_local));
 		return FALSE;
 	}
+	/* save the payload rather than the builder output, as this is what
+	 * the next delta will be generated against */
+	fu_engine_save_installed_image (device, blob_fw, blob_fw_delta != NULL);
 
 	/* the device may have changed */
 	device_tmp = fu_device_list_get_by_id (self->device_list,
@@ -1889,50 +2310,43 @@ fu_engine_install_release (FuEngine *self,
 }
 
 typedef struct {
-	gboolean	 ret;
-	GError		**error;
-	FuEngine	*self;
-	FuDevice	*device;
+	XbNode			*rel;
+	FuVersionKey		*key;
 } FuEngineSortHelper;
 
 static gint
 fu_engine_sort_release_versions_cb (gconstpointer a, gconstpointer b, gpointer user_data)
 {
-	FuEngineSortHelper *helper = (FuEngineSortHelper *) user_data;
-	XbNode *na = *((XbNode **) a);
-	XbNode *nb = *((XbNode **) b);
-	g_autofree gchar *va = NULL;
-	g_autofree gchar *vb = NULL;
-
-	/* already failed */
-	if (!helper->ret)
-		return 0;
-
-	/* get the semver from the release */
-	va = fu_engine_get_release_version (helper->self, helper->device, na, helper->error);
-	if (va == NULL) {
-		g_prefix_error (helper->error, "failed to get release version: ");
-		return 0;
-	}
-	vb = fu_engine_get_release_version (helper->self, helper->device, nb, helper->error);
-	if (vb == NULL) {
-		g_prefix_error (helper->error, "failed to get release version: ");
-		return 0;
-	}
-	return fu_common_vercmp_full (va, vb, fu_device_get_version_format (helper->device));
+	const FuEngineSortHelper *helper_a = (const FuEngineSortHelper *) a;
+	const FuEngineSortHelper *helper_b = (const FuEngineSortHelper *) b;
+	return fu_common_version_key_compare (helper_a->key, helper_b->key);
 }
 
 static gboolean
 fu_engine_sort_releases (FuEngine *self, FuDevice *device, GPtrArray *rels, GError **error)
 {
-	FuEngineSortHelper helper = {
-		.ret = TRUE,
-		.self = self,
-		.device = device,
-		.error = error,
-	};
-	g_ptr_array_sort_with_data (rels, fu_engine_sort_release_versions_cb, &helper);
-	return helper.ret;
+	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	g_autofree FuEngineSortHelper *helpers = g_new0 (FuEngineSortHelper, rels->len);
+	g_autoptr(GPtrArray) keys = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_common_version_key_free);
+
+	/* get the semver from each release once, not on every comparison */
+	for (guint i = 0; i < rels->len; i++) {
+		XbNode *rel = g_ptr_array_index (rels, i);
+		g_autofree gchar *version = NULL;
+		version = fu_engine_get_release_version (self, device, rel, error);
+		if (version == NULL) {
+			g_prefix_error (error, "failed to get release version: ");
+			return FALSE;
+		}
+		helpers[i].rel = rel;
+		helpers[i].key = fu_common_version_key_new (version, fmt);
+		g_ptr_array_add (keys, helpers[i].key);
+	}
+	g_qsort_with_data (helpers, (gint) rels->len, sizeof(FuEngineSortHelper),
+			   fu_engine_sort_release_versions_cb, NULL);
+	for (guint i = 0; i < rels->len; i++)
+		rels->pdata[i] = helpers[i].rel;
+	return TRUE;
 }
 
 /**
@@ -2592,6 +3006,23 @@ fu_engine_appstream_upgrade_cb (XbBuilderFixup *self,
 	return TRUE;
 }
 
+static XbSilo *
+fu_engine_build_silo_from_blob (FuEngine *self, GBytes *blob_cab, GError **error)
+{
+	g_autoptr(FuCabinet) cabinet = fu_cabinet_new ();
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* load file */
+	fu_engine_set_status (self, FWUPD_STATUS_DECOMPRESSING);
+	fu_cabinet_set_size_max (cabinet, fu_engine_get_archive_size_max (self));
+	fu_cabinet_set_jcat_context (cabinet, self->jcat_context);
+	if (!fu_cabinet_parse (cabinet, blob_cab, FU_CABINET_PARSE_FLAG_NONE, error))
+		return NULL;
+	silo = fu_cabinet_get_silo (cabinet);
+	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
+	return g_steal_pointer (&silo);
+}
+
 static XbBuilderSource *
 fu_engine_create_metadata_builder_source (FuEngine *self,
 					  const gchar *fn,
@@ -2608,7 +3039,7 @@ fu_engine_create_metadata_builder_source (FuEngine *self,
 		return NULL;
 
 	/* convert the silo for the CAB into a XbBuilderSource */
-	silo = fu_engine_get_silo_from_blob (self, blob, error);
+	silo = fu_engine_build_silo_from_blob (self, blob, error);
 	if (silo == NULL)
 		return NULL;
 	xml = xb_silo_export (silo, XB_NODE_EXPORT_FLAG_NONE, error);
@@ -2982,6 +3413,9 @@ static void
 fu_engine_config_changed_cb (FuConfig *config, FuEngine *self)
 {
 	fu_idle_set_timeout (self->idle, fu_config_get_idle_timeout (config));
+
+	/* the archive size limit may have changed */
+	fu_engine_cabinet_cache_clear (self);
 }
 
 static void
@@ -3256,28 +3690,55 @@ fu_engine_update_metadata (FuEngine *self, const gchar *remote_id,
  * @blob_cab: A #GBytes
  * @error: A #GError, or %NULL
  *
- * Creates a silo from a .cab file blob.
+ * Creates a silo from a .cab file blob. The silo for a recently used archive
+ * with the same contents is reused, along with the payloads that have already
+ * been decompressed and verified.
  *
  * Returns: (transfer container): a #XbSilo, or %NULL
  **/
 XbSilo *
 fu_engine_get_silo_from_blob (FuEngine *self, GBytes *blob_cab, GError **error)
 {
-	g_autoptr(FuCabinet) cabinet = fu_cabinet_new ();
+	FuEngineCabinetCacheItem *item;
+	g_autofree gchar *checksum = NULL;
 	g_autoptr(XbSilo) silo = NULL;
 
 	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
 	g_return_val_if_fail (blob_cab != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	/* load file */
-	fu_engine_set_status (self, FWUPD_STATUS_DECOMPRESSING);
-	fu_cabinet_set_size_max (cabinet, fu_engine_get_archive_size_max (self));
-	fu_cabinet_set_jcat_context (cabinet, self->jcat_context);
-	if (!fu_cabinet_parse (cabinet, blob_cab, FU_CABINET_PARSE_FLAG_NONE, error))
+	/* already parsed */
+	checksum = fu_common_checksum_tree_for_bytes (blob_cab, G_CHECKSUM_SHA256);
+	for (GList *l = self->cabinet_cache->head; l != NULL; l = l->next) {
+		item = (FuEngineCabinetCacheItem *) l->data;
+		if (g_strcmp0 (item->checksum, checksum) != 0)
+			continue;
+		g_debug ("using cached silo for archive %s", checksum);
+		g_queue_unlink (self->cabinet_cache, l);
+		g_queue_push_head_link (self->cabinet_cache, l);
+		fu_engine_cabinet_cache_touch (self);
+		return g_object_ref (item->silo);
+	}
+
+	silo = fu_engine_build_silo_from_blob (self, blob_cab, error);
+	if (silo == NULL)
 		return NULL;
-	silo = fu_cabinet_get_silo (cabinet);
-	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
+
+	/* too large to keep */
+	if (g_bytes_get_size (blob_cab) > self->cabinet_cache_size_max)
+		return g_steal_pointer (&silo);
+
+	/* drop the least recently used */
+	item = g_new0 (FuEngineCabinetCacheItem, 1);
+	item->checksum = g_steal_pointer (&checksum);
+	item->silo = g_object_ref (silo);
+	item->size = g_bytes_get_size (blob_cab);
+	g_queue_push_head (self->cabinet_cache, item);
+	self->cabinet_cache_size += item->size;
+	fu_engine_cabinet_cache_prune (self,
+				       FU_ENGINE_CABINET_CACHE_MAX,
+				       self->cabinet_cache_size_max);
+	fu_engine_cabinet_cache_touch (self);
 	return g_steal_pointer (&silo);
 }
 
@@ -3285,6 +3746,7 @@ static FuDevice *
 fu_engine_get_result_from_component (FuEngine *self, XbNode *component, GError **error)
 {
 	FwupdReleaseFlags release_flags = FWUPD_RELEASE_FLAG_NONE;
+	gboolean has_device = FALSE;
 	g_autoptr(FuInstallTask) task = NULL;
 	g_autoptr(FuDevice) dev = NULL;
 	g_autoptr(FwupdRelease) rel = NULL;
@@ -3316,6 +3778,7 @@ fu_engine_get_result_from_component (FuEngine *self, XbNode *component, GError *
 			continue;
 		device = fu_device_list_get_by_guid (self->device_list, guid, NULL);
 		if (device != NULL) {
+			has_device = TRUE;
 			fu_device_set_name (dev, fu_device_get_name (device));
 			fu_device_set_flags (dev, fu_device_get_flags (device));
 			fu_device_set_id (dev, fu_device_get_id (device));
@@ -3342,7 +3805,6 @@ fu_engine_get_result_from_component (FuEngine *self, XbNode *component, GError *
 					   error))
 		return NULL;
 
-	/* verify trust */
 	release = xb_node_query_first (component,
 				       "releases/release",
 				       &error_local);
@@ -3354,7 +3816,12 @@ fu_engine_get_result_from_component (FuEngine *self, XbNode *component, GError *
 			     error_local->message);
 		return NULL;
 	}
-	if (!fu_keyring_get_release_flags (release,
+
+	/* verify trust, which needs the payload to be decompressed; this is
+	 * only useful for firmware that could be installed on this system, and
+	 * is checked again by fu_install_task_check_requirements() before install */
+	if (has_device &&
+	    !fu_keyring_get_release_flags (release,
 					   &release_flags,
 					   &error_local)) {
 		if (g_error_matches (error_local,
@@ -3687,15 +4154,49 @@ fu_engine_get_remote_by_id (FuEngine *self, const gchar *remote_id, GError **err
 }
 
 
+/* the key is cached on the release as it is compared many times */
+static const FuVersionKey *
+fu_engine_release_get_version_key (FwupdRelease *rel, FwupdVersionFormat fmt)
+{
+	FuVersionKey *key = g_object_get_data (G_OBJECT (rel), "fwupd::VersionKey");
+	if (key == NULL ||
+	    !fu_common_version_key_matches (key, fwupd_release_get_version (rel), fmt)) {
+		key = fu_common_version_key_new (fwupd_release_get_version (rel), fmt);
+		g_object_set_data_full (G_OBJECT (rel), "fwupd::VersionKey", key,
+					(GDestroyNotify) fu_common_version_key_free);
+	}
+	return key;
+}
+
+typedef struct {
+	FwupdRelease		*rel;
+	const FuVersionKey	*key;
+} FuEngineReleaseSortHelper;
+
 static gint
 fu_engine_sort_releases_cb (gconstpointer a, gconstpointer b, gpointer user_data)
 {
-	FuDevice *device = FU_DEVICE (user_data);
-	FwupdRelease *rel_a = FWUPD_RELEASE (*((FwupdRelease **) a));
-	FwupdRelease *rel_b = FWUPD_RELEASE (*((FwupdRelease **) b));
-	return fu_common_vercmp_full (fwupd_release_get_version (rel_b),
-				      fwupd_release_get_version (rel_a),
-				      fu_device_get_version_format (device));
+	const FuEngineReleaseSortHelper *helper_a = (const FuEngineReleaseSortHelper *) a;
+	const FuEngineReleaseSortHelper *helper_b = (const FuEngineReleaseSortHelper *) b;
+	return fu_common_version_key_compare (helper_b->key, helper_a->key);
+}
+
+/* newest first */
+static void
+fu_engine_sort_releases_by_version (FuDevice *device, GPtrArray *releases)
+{
+	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	g_autofree FuEngineReleaseSortHelper *helpers = NULL;
+
+	helpers = g_new0 (FuEngineReleaseSortHelper, releases->len);
+	for (guint i = 0; i < releases->len; i++) {
+		helpers[i].rel = g_ptr_array_index (releases, i);
+		helpers[i].key = fu_engine_release_get_version_key (helpers[i].rel, fmt);
+	}
+	g_qsort_with_data (helpers, (gint) releases->len, sizeof(FuEngineReleaseSortHelper),
+			   fu_engine_sort_releases_cb, NULL);
+	for (guint i = 0; i < releases->len; i++)
+		releases->pdata[i] = helpers[i].rel;
 }
 
 static gboolean
@@ -3719,6 +4220,8 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 					     GError **error)
 {
 	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	const FuVersionKey *key_device;
+	g_autoptr(FuVersionKey) key_lowest = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(FuInstallTask) task = fu_install_task_new (device, component);
 	g_autoptr(GPtrArray) releases_tmp = NULL;
@@ -3740,10 +4243,14 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 		g_propagate_error (error, g_steal_pointer (&error_local));
 		return FALSE;
 	}
+	key_device = fu_device_get_version_key (device);
+	if (fu_device_get_version_lowest (device) != NULL)
+		key_lowest = fu_common_version_key_new (fu_device_get_version_lowest (device), fmt);
 	for (guint i = 0; i < releases_tmp->len; i++) {
 		XbNode *release = g_ptr_array_index (releases_tmp, i);
 		const gchar *remote_id;
 		const gchar *update_message;
+		const FuVersionKey *key_rel;
 		gint vercmp;
 		GPtrArray *checksums;
 		g_autoptr(FwupdRelease) rel = fwupd_release_new ();
@@ -3773,21 +4280,17 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 			continue;
 
 		/* test for upgrade or downgrade */
-		vercmp = fu_common_vercmp_full (fwupd_release_get_version (rel),
-						fu_device_get_version (device),
-						fmt);
+		key_rel = fu_engine_release_get_version_key (rel, fmt);
+		vercmp = fu_common_version_key_compare (key_rel, key_device);
 		if (vercmp > 0)
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_IS_UPGRADE);
 		else if (vercmp < 0)
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_IS_DOWNGRADE);
 
 		/* lower than allowed to downgrade to */
-		if (fu_device_get_version_lowest (device) != NULL &&
-		    fu_common_vercmp_full (fwupd_release_get_version (rel),
-					   fu_device_get_version_lowest (device),
-					   fmt) < 0) {
+		if (key_lowest != NULL &&
+		    fu_common_version_key_compare (key_rel, key_lowest) < 0)
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_BLOCKED_VERSION);
-		}
 
 		/* check if remote is whitelisting firmware */
 		remote_id = fwupd_release_get_remote_id (rel);
@@ -3819,6 +4322,7 @@ fu_engine_get_releases_for_device (FuEngine *self, FuDevice *device, GError **er
 {
 	GPtrArray *device_guids;
 	GPtrArray *releases;
+	XbSilo *silo;
 	const gchar *version;
 	g_autoptr(GError) error_all = NULL;
 	g_autoptr(GError) error_local = NULL;
@@ -3853,7 +4357,10 @@ fu_engine_get_releases_for_device (FuEngine *self, FuDevice *device, GError **er
 					"provides/firmware[@type=$'flashed'][text()=$'%s']/"
 					"../..", guid);
 	}
-	components = xb_silo_query (self->silo, xpath->str, 0, &error_local);
+	silo = fu_engine_get_metadata_silo (self, error);
+	if (silo == NULL)
+		return NULL;
+	components = xb_silo_query (silo, xpath->str, 0, &error_local);
 	if (components == NULL) {
 		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
 		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
@@ -3939,7 +4446,7 @@ fu_engine_get_releases (FuEngine *self, const gchar *device_id, GError **error)
 				     "No releases for device");
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_by_version (device, releases);
 	return g_steal_pointer (&releases);
 }
 
@@ -4029,7 +4536,7 @@ fu_engine_get_downgrades (FuEngine *self, const gchar *device_id, GError **error
 		}
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_by_version (device, releases);
 	return g_steal_pointer (&releases);
 }
 
@@ -4176,7 +4683,7 @@ fu_engine_get_upgrades (FuEngine *self, const gchar *device_id, GError **error)
 		}
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_by_version (device, releases);
 	return g_steal_pointer (&releases);
 }
 
@@ -4982,6 +5489,7 @@ fu_engine_add_plugin_filter (FuEngine *self, const gchar *plugin_glob)
 static gboolean
 fu_engine_plugin_check_supported_cb (FuPlugin *plugin, const gchar *guid, FuEngine *self)
 {
+	XbSilo *silo;
 	g_autoptr(XbNode) n = NULL;
 	g_autofree gchar *xpath = NULL;
 
@@ -4991,7 +5499,10 @@ fu_engine_plugin_check_supported_cb (FuPlugin *plugin, const gchar *guid, FuEngi
 	xpath = g_strdup_printf ("components/component/"
 				 "provides/firmware[@type='flashed'][text()='%s']",
 				 guid);
-	n = xb_silo_query_first (self->silo, xpath, NULL);
+	silo = fu_engine_get_metadata_silo (self, NULL);
+	if (silo == NULL)
+		return FALSE;
+	n = xb_silo_query_first (silo, xpath, NULL);
 	return n != NULL;
 }
 
@@ -5142,6 +5653,12 @@ fu_engine_get_archive_size_max (FuEngine *self)
 	return fu_config_get_archive_size_max (self->config);
 }
 
+guint
+fu_engine_get_progress_interval (FuEngine *self)
+{
+	return fu_config_get_progress_interval (self->config);
+}
+
 static void
 fu_engine_usb_device_removed_cb (GUsbContext *ctx,
 				 GUsbDevice *usb_device,
@@ -5399,6 +5916,39 @@ fu_engine_ensure_client_certificate (FuEngine *self)
 	g_debug ("client certificate exists and working");
 }
 
+static gboolean
+fu_engine_enumerate (FuEngine *self, FuEngineLoadFlags flags, GError **error)
+{
+	/* coldplug plugins */
+	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
+		fu_engine_plugins_coldplug (self, FALSE);
+
+	/* coldplug USB devices */
+	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
+		g_usb_context_enumerate (self->usb_ctx);
+
+#ifdef HAVE_GUDEV
+	/* coldplug udev devices */
+	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
+		fu_engine_enumerate_udev (self);
+#endif
+
+	/* set device properties from the metadata */
+	fu_engine_md_refresh_devices (self);
+
+	/* update the db for devices that were updated during the reboot */
+	if (!fu_engine_update_history_database (self, error))
+		return FALSE;
+
+	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
+
+	/* let clients know engine finished starting up */
+	fu_engine_emit_changed (self);
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_engine_load:
  * @self: A #FuEngine
@@ -5425,6 +5975,7 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 	/* avoid re-loading a second time if fu-tool or fu-util request to */
 	if (self->loaded)
 		return TRUE;
+	self->load_flags = flags;
 
 /* TODO: Read registry key [HKEY_LOCAL_MACHINE\SOFTWARE\Microsoft\Cryptography] "MachineGuid" */
 #ifndef _WIN32
@@ -5538,40 +6089,216 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 
 	/* add devices */
 	fu_engine_plugins_setup (self);
-	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
-		fu_engine_plugins_coldplug (self, FALSE);
-
-	/* coldplug USB devices */
 	g_signal_connect (self->usb_ctx, "device-added",
 			  G_CALLBACK (fu_engine_usb_device_added_cb),
 			  self);
 	g_signal_connect (self->usb_ctx, "device-removed",
 			  G_CALLBACK (fu_engine_usb_device_removed_cb),
 			  self);
-	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
-		g_usb_context_enumerate (self->usb_ctx);
+	self->loaded = TRUE;
 
-#ifdef HAVE_GUDEV
-	/* coldplug udev devices */
-	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
-		fu_engine_enumerate_udev (self);
+	/* the caller will use fu_engine_load_devices() when ready */
+	if (flags & FU_ENGINE_LOAD_FLAG_DEFER_ENUMERATE)
+		return TRUE;
+	return fu_engine_enumerate (self, flags, error);
+}
+
+/**
+ * fu_engine_load_devices:
+ * @self: A #FuEngine
+ * @error: A #GError, or %NULL
+ *
+ * Enumerates the hardware after the engine was loaded using
+ * %FU_ENGINE_LOAD_FLAG_DEFER_ENUMERATE.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_load_devices (FuEngine *self, GError **error)
+{
+	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return fu_engine_enumerate (self, FU_ENGINE_LOAD_FLAG_NONE, error);
+}
+
+static guint64
+fu_engine_get_resident_size (void)
+{
+	g_autofree gchar *status = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	if (!g_file_get_contents ("/proc/self/status", &status, NULL, NULL))
+		return 0;
+	lines = g_strsplit (status, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		if (g_str_has_prefix (lines[i], "VmRSS:"))
+			return g_ascii_strtoull (lines[i] + 6, NULL, 10) * 1024;
+	}
+	return 0;
+}
+
+/**
+ * fu_engine_shed_memory:
+ * @self: A #FuEngine
+ * @flags: #FuEngineShedFlags, e.g. %FU_ENGINE_SHED_FLAG_CACHES
+ *
+ * Releases memory that can be recreated later when required. This should not
+ * be called while an update is in progress.
+ *
+ * Returns: the reduction in resident size in bytes, which may be zero
+ **/
+guint64
+fu_engine_shed_memory (FuEngine *self, FuEngineShedFlags flags)
+{
+	guint64 rss_before;
+	guint64 rss_after;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), 0);
+
+	rss_before = fu_engine_get_resident_size ();
+	if (flags & FU_ENGINE_SHED_FLAG_CACHES) {
+		g_debug ("dropping metadata, quirk and cabinet databases");
+		g_clear_object (&self->silo);
+		fu_quirks_unload (self->quirks);
+		fu_engine_cabinet_cache_clear (self);
+	}
+	if (flags & FU_ENGINE_SHED_FLAG_HISTORY) {
+		g_debug ("closing history database");
+		fu_history_unload (self->history);
+	}
+#ifdef HAVE_MALLOC_TRIM
+	if (flags & FU_ENGINE_SHED_FLAG_HEAP)
+		malloc_trim (0);
 #endif
+	rss_after = fu_engine_get_resident_size ();
+	return rss_before > rss_after ? rss_before - rss_after : 0;
+}
 
-	/* set device properties from the metadata */
-	fu_engine_md_refresh_devices (self);
+static gchar *
+fu_engine_get_boot_id (void)
+{
+	gchar *boot_id = NULL;
+	if (!g_file_get_contents ("/proc/sys/kernel/random/boot_id",
+				  &boot_id, NULL, NULL))
+		return g_strdup ("");
+	return g_strstrip (boot_id);
+}
 
-	/* update the db for devices that were updated during the reboot */
-	if (!fu_engine_update_history_database (self, error))
-		return FALSE;
+static gchar *
+fu_engine_get_snapshot_filename (void)
+{
+	g_autofree gchar *cachedir = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	return g_build_filename (cachedir, "devices.snapshot", NULL);
+}
 
-	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
-	self->loaded = TRUE;
+/**
+ * fu_engine_save_snapshot:
+ * @self: A #FuEngine
+ * @error: A #GError, or %NULL
+ *
+ * Saves the current device list so that the next instance of the daemon
+ * can return it to clients while the hardware is being enumerated.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_save_snapshot (FuEngine *self, GError **error)
+{
+	GVariantBuilder builder;
+	g_autofree gchar *boot_id = fu_engine_get_boot_id ();
+	g_autofree gchar *filename = fu_engine_get_snapshot_filename ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GVariant) val = NULL;
 
-	/* let clients know engine finished starting up */
-	fu_engine_emit_changed (self);
+	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	/* success */
-	return TRUE;
+	/* the untrusted form is used so that no serial numbers are saved */
+	devices = fu_device_list_get_active (self->device_list);
+	g_ptr_array_sort (devices, fu_engine_sort_devices_by_priority_name);
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *device = g_ptr_array_index (devices, i);
+		g_variant_builder_add_value (&builder, fwupd_device_to_variant (device));
+	}
+	val = g_variant_ref_sink (g_variant_new ("(ssaa{sv})",
+						 PACKAGE_VERSION,
+						 boot_id,
+						 &builder));
+	blob = g_variant_get_data_as_bytes (val);
+	return fu_common_set_contents_bytes (filename, blob, error);
+}
+
+/**
+ * fu_engine_load_snapshot:
+ * @self: A #FuEngine
+ * @error: A #GError, or %NULL
+ *
+ * Loads, and then deletes, the device list saved by fu_engine_save_snapshot().
+ * Snapshots from a different daemon version or from a previous boot are
+ * ignored.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): devices, or %NULL
+ **/
+GPtrArray *
+fu_engine_load_snapshot (FuEngine *self, GError **error)
+{
+	const gchar *boot_id_snapshot = NULL;
+	const gchar *version = NULL;
+	g_autofree gchar *boot_id = fu_engine_get_boot_id ();
+	g_autofree gchar *filename = fu_engine_get_snapshot_filename ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GVariant) array = NULL;
+	g_autoptr(GVariant) tuple = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* only ever use the snapshot once */
+	if (!g_file_test (filename, G_FILE_TEST_EXISTS)) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "no snapshot at %s", filename);
+		return NULL;
+	}
+	blob = fu_common_get_contents_bytes (filename, error);
+	if (blob == NULL)
+		return NULL;
+	if (g_unlink (filename) != 0)
+		g_debug ("failed to delete %s", filename);
+
+	val = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("(ssaa{sv})"),
+							    blob, FALSE));
+	g_variant_get (val, "(&s&s@aa{sv})", &version, &boot_id_snapshot, &array);
+	if (g_strcmp0 (version, PACKAGE_VERSION) != 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "snapshot from version %s, expected %s",
+			     version, PACKAGE_VERSION);
+		return NULL;
+	}
+	if (g_strcmp0 (boot_id_snapshot, boot_id) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "snapshot from a previous boot");
+		return NULL;
+	}
+	tuple = g_variant_ref_sink (g_variant_new_tuple (&array, 1));
+	devices = fwupd_device_array_from_variant (tuple);
+	if (devices->len == 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOTHING_TO_DO,
+				     "No devices in snapshot");
+		return NULL;
+	}
+	return g_steal_pointer (&devices);
 }
 
 static void
@@ -5668,6 +6395,8 @@ fu_engine_init (FuEngine *self)
 	self->compile_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->approved_firmware = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	self->firmware_gtypes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->cabinet_cache = g_queue_new ();
+	self->cabinet_cache_size_max = FU_ENGINE_CABINET_CACHE_SIZE_MAX;
 
 	g_signal_connect (self->config, "changed",
 			  G_CALLBACK (fu_engine_config_changed_cb),
@@ -5734,6 +6463,8 @@ fu_engine_finalize (GObject *obj)
 #endif
 	if (self->coldplug_id != 0)
 		g_source_remove (self->coldplug_id);
+	if (self->composite_progress != NULL)
+		g_ptr_array_unref (self->composite_progress);
 
 	g_free (self->host_machine_id);
 	g_object_unref (self->idle);
@@ -5754,6 +6485,9 @@ fu_engine_finalize (GObject *obj)
 	g_hash_table_unref (self->compile_versions);
 	g_hash_table_unref (self->approved_firmware);
 	g_hash_table_unref (self->firmware_gtypes);
+	if (self->cabinet_cache_id != 0)
+		g_source_remove (self->cabinet_cache_id);
+	g_queue_free_full (self->cabinet_cache, (GDestroyNotify) fu_engine_cabinet_cache_item_free);
 	g_object_unref (self->plugin_list);
 
 	G_OBJECT_CLASS (fu_engine_parent_class)->finalize (obj);
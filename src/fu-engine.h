@@ -24,6 +24,8 @@ G_DECLARE_FINAL_TYPE (FuEngine, fu_engine, FU, ENGINE, GObject)
  * FuEngineLoadFlags:
  * @FU_ENGINE_LOAD_FLAG_NONE:		No flags set
  * @FU_ENGINE_LOAD_FLAG_READONLY_FS:	Ignore readonly filesystem errors
+ * @FU_ENGINE_LOAD_FLAG_NO_ENUMERATE:	Do not coldplug any devices
+ * @FU_ENGINE_LOAD_FLAG_DEFER_ENUMERATE:	Coldplug devices in fu_engine_load_devices()
  *
  * The flags to use when loading the engine.
  **/
@@ -31,21 +33,48 @@ typedef enum {
 	FU_ENGINE_LOAD_FLAG_NONE		= 0,
 	FU_ENGINE_LOAD_FLAG_READONLY_FS		= 1 << 0,
 	FU_ENGINE_LOAD_FLAG_NO_ENUMERATE	= 1 << 1,
+	FU_ENGINE_LOAD_FLAG_DEFER_ENUMERATE	= 1 << 2,
 	/*< private >*/
 	FU_ENGINE_LOAD_FLAG_LAST
 } FuEngineLoadFlags;
 
+/**
+ * FuEngineShedFlags:
+ * @FU_ENGINE_SHED_FLAG_NONE:		No flags set
+ * @FU_ENGINE_SHED_FLAG_CACHES:		Drop the metadata, quirk and cabinet databases
+ * @FU_ENGINE_SHED_FLAG_HISTORY:	Close the history database
+ * @FU_ENGINE_SHED_FLAG_HEAP:		Return unused heap memory to the kernel
+ *
+ * The things to release when the system is low on memory.
+ **/
+typedef enum {
+	FU_ENGINE_SHED_FLAG_NONE		= 0,
+	FU_ENGINE_SHED_FLAG_CACHES		= 1 << 0,
+	FU_ENGINE_SHED_FLAG_HISTORY		= 1 << 1,
+	FU_ENGINE_SHED_FLAG_HEAP		= 1 << 2,
+	/*< private >*/
+	FU_ENGINE_SHED_FLAG_LAST
+} FuEngineShedFlags;
+
 FuEngine	*fu_engine_new				(FuAppFlags	 app_flags);
 void		 fu_engine_add_app_flag			(FuEngine	*self,
 							 FuAppFlags	 app_flags);
 void		 fu_engine_add_plugin_filter		(FuEngine	*self,
 							 const gchar	*plugin_glob);
 void		 fu_engine_idle_reset			(FuEngine	*self);
+guint64		 fu_engine_shed_memory			(FuEngine	*self,
+							 FuEngineShedFlags flags);
 gboolean	 fu_engine_load				(FuEngine	*self,
 							 FuEngineLoadFlags flags,
 							 GError		**error);
 gboolean	 fu_engine_load_plugins			(FuEngine	*self,
 							 GError		**error);
+gboolean	 fu_engine_load_devices			(FuEngine	*self,
+							 GError		**error);
+gboolean	 fu_engine_save_snapshot		(FuEngine	*self,
+							 GError		**error);
+GPtrArray	*fu_engine_load_snapshot		(FuEngine	*self,
+							 GError		**error);
 gboolean	 fu_engine_get_tainted			(FuEngine	*self);
 const gchar	*fu_engine_get_host_product		(FuEngine *self);
 const gchar	*fu_engine_get_host_machine_id		(FuEngine *self);
@@ -53,7 +82,10 @@ FwupdStatus	 fu_engine_get_status			(FuEngine	*self);
 XbSilo		*fu_engine_get_silo_from_blob		(FuEngine	*self,
 							 GBytes		*blob_cab,
 							 GError		**error);
+void		 fu_engine_set_cabinet_cache_size_max	(FuEngine	*self,
+							 guint64	 size_max);
 guint64		 fu_engine_get_archive_size_max		(FuEngine	*self);
+guint		 fu_engine_get_progress_interval	(FuEngine	*self);
 GPtrArray	*fu_engine_get_plugins			(FuEngine	*self);
 GPtrArray	*fu_engine_get_devices			(FuEngine	*self,
 							 GError		**error);
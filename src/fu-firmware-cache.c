@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuFirmwareCache"
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#include "fwupd-error.h"
+
+#include "fu-common.h"
+#include "fu-firmware-cache.h"
+
+typedef struct {
+	gchar		*filename;
+	guint64		 size;
+	gint64		 mtime;
+} FuFirmwareCacheItem;
+
+static void
+fu_firmware_cache_item_free (FuFirmwareCacheItem *item)
+{
+	g_free (item->filename);
+	g_free (item);
+}
+
+static gint
+fu_firmware_cache_item_sort_cb (gconstpointer a, gconstpointer b)
+{
+	FuFirmwareCacheItem *item1 = *((FuFirmwareCacheItem **) a);
+	FuFirmwareCacheItem *item2 = *((FuFirmwareCacheItem **) b);
+	if (item1->mtime < item2->mtime)
+		return -1;
+	if (item1->mtime > item2->mtime)
+		return 1;
+	return 0;
+}
+
+/* the system location is only writable when run as root or from the unit */
+static gboolean
+fu_firmware_cache_dir_is_writable (const gchar *cachedir)
+{
+	g_autofree gchar *parent = NULL;
+	if (g_file_test (cachedir, G_FILE_TEST_IS_DIR))
+		return g_access (cachedir, W_OK) == 0;
+	parent = g_path_get_dirname (cachedir);
+	return g_access (parent, W_OK) == 0;
+}
+
+/**
+ * fu_firmware_cache_get_dir:
+ *
+ * Gets the directory used to store downloaded firmware, which is
+ * `/var/cache/fwupd/firmware` when writable and a per-user location otherwise.
+ *
+ * Returns: a path
+ **/
+gchar *
+fu_firmware_cache_get_dir (void)
+{
+	g_autofree gchar *cachedir_pkg = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *cachedir = g_build_filename (cachedir_pkg, "firmware", NULL);
+	if (fu_firmware_cache_dir_is_writable (cachedir))
+		return g_steal_pointer (&cachedir);
+	return g_build_filename (g_get_user_cache_dir (), "fwupd", "firmware", NULL);
+}
+
+/**
+ * fu_firmware_cache_build_filename:
+ * @cachedir: a directory, typically from fu_firmware_cache_get_dir()
+ * @checksum: the release checksum, e.g. from fwupd_checksum_get_best()
+ * @error: A #GError, or %NULL
+ *
+ * Builds the content-addressed filename for a cabinet archive. Releases from
+ * different devices or remotes that share a checksum share one file.
+ *
+ * Returns: a filename, or %NULL if @checksum is not valid
+ **/
+gchar *
+fu_firmware_cache_build_filename (const gchar *cachedir,
+				  const gchar *checksum,
+				  GError **error)
+{
+	g_autofree gchar *basename = NULL;
+
+	g_return_val_if_fail (cachedir != NULL, NULL);
+
+	/* the checksum is used as a path component, so be paranoid */
+	if (checksum == NULL || checksum[0] == '\0') {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "no checksum");
+		return NULL;
+	}
+	for (guint i = 0; checksum[i] != '\0'; i++) {
+		if (!g_ascii_isxdigit (checksum[i])) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "checksum %s is not hexadecimal",
+				     checksum);
+			return NULL;
+		}
+	}
+	basename = g_strdup_printf ("%s.cab", checksum);
+	return g_build_filename (cachedir, basename, NULL);
+}
+
+/**
+ * fu_firmware_cache_touch:
+ * @filename: a filename
+ *
+ * Marks the cached file as recently used so that it is evicted last.
+ **/
+void
+fu_firmware_cache_touch (const gchar *filename)
+{
+	if (g_utime (filename, NULL) != 0)
+		g_debug ("failed to update timestamp on %s", filename);
+}
+
+/**
+ * fu_firmware_cache_prune:
+ * @cachedir: a directory, typically from fu_firmware_cache_get_dir()
+ * @max_size: the maximum number of bytes to keep
+ * @filename_keep: (nullable): a filename that must not be deleted
+ * @error: A #GError, or %NULL
+ *
+ * Deletes the least recently used cabinet archives until the total size of
+ * the directory is no larger than @max_size.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_firmware_cache_prune (const gchar *cachedir,
+			 guint64 max_size,
+			 const gchar *filename_keep,
+			 GError **error)
+{
+	const gchar *fn;
+	guint64 total = 0;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) items = NULL;
+
+	g_return_val_if_fail (cachedir != NULL, FALSE);
+
+	/* nothing downloaded yet */
+	if (!g_file_test (cachedir, G_FILE_TEST_IS_DIR))
+		return TRUE;
+	dir = g_dir_open (cachedir, 0, error);
+	if (dir == NULL)
+		return FALSE;
+	items = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_firmware_cache_item_free);
+	while ((fn = g_dir_read_name (dir)) != NULL) {
+		FuFirmwareCacheItem *item;
+		GStatBuf buf = { 0x0 };
+		g_autofree gchar *filename = NULL;
+
+		if (!g_str_has_suffix (fn, ".cab"))
+			continue;
+		filename = g_build_filename (cachedir, fn, NULL);
+		if (g_stat (filename, &buf) != 0)
+			continue;
+		total += (guint64) buf.st_size;
+		if (g_strcmp0 (filename, filename_keep) == 0)
+			continue;
+		item = g_new0 (FuFirmwareCacheItem, 1);
+		item->filename = g_steal_pointer (&filename);
+		item->size = (guint64) buf.st_size;
+		item->mtime = (gint64) buf.st_mtime;
+		g_ptr_array_add (items, item);
+	}
+
+	/* oldest first */
+	g_ptr_array_sort (items, fu_firmware_cache_item_sort_cb);
+	for (guint i = 0; i < items->len && total > max_size; i++) {
+		FuFirmwareCacheItem *item = g_ptr_array_index (items, i);
+		g_debug ("evicting %s from firmware cache", item->filename);
+		if (g_unlink (item->filename) != 0) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "Failed to delete: %s",
+				     item->filename);
+			return FALSE;
+		}
+		total -= item->size;
+	}
+	return TRUE;
+}
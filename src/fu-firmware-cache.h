@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib.h>
+
+/* the default size cap for the downloaded firmware store, in bytes */
+#define FU_FIRMWARE_CACHE_MAX_SIZE_DEFAULT	(512 * 1024 * 1024)
+
+gchar		*fu_firmware_cache_get_dir		(void);
+gchar		*fu_firmware_cache_build_filename	(const gchar	*cachedir,
+							 const gchar	*checksum,
+							 GError		**error);
+void		 fu_firmware_cache_touch		(const gchar	*filename);
+gboolean	 fu_firmware_cache_prune		(const gchar	*cachedir,
+							 guint64	 max_size,
+							 const gchar	*filename_keep,
+							 GError		**error);
@@ -432,6 +432,24 @@ fu_history_load (FuHistory *self, GError **error)
 	return TRUE;
 }
 
+/**
+ * fu_history_unload:
+ * @self: A #FuHistory
+ *
+ * Closes the database to free memory; it is opened again when next required.
+ **/
+void
+fu_history_unload (FuHistory *self)
+{
+	g_autoptr(GRWLockWriterLocker) locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_if_fail (FU_IS_HISTORY (self));
+	g_return_if_fail (locker != NULL);
+	if (self->db == NULL)
+		return;
+	sqlite3_close (self->db);
+	self->db = NULL;
+}
+
 static gchar *
 _convert_hash_to_string (GHashTable *hash)
 {
@@ -14,6 +14,7 @@
 G_DECLARE_FINAL_TYPE (FuHistory, fu_history, FU, HISTORY, GObject)
 
 FuHistory	*fu_history_new				(void);
+void		 fu_history_unload			(FuHistory	*self);
 
 gboolean	 fu_history_add_device			(FuHistory	*self,
 							 FuDevice	*device,
@@ -10,6 +10,7 @@
 
 #include "fwupd-error.h"
 
+#include "fu-cabinet.h"
 #include "fu-keyring-utils.h"
 
 /**
@@ -19,6 +20,8 @@
  * @error: A #GError, or %NULL
  *
  * Uses the correct keyring to get the trust flags for a given release.
+ * Releases from a cabinet archive have the payload decompressed and verified
+ * the first time this is called.
  *
  * Returns: %TRUE if @flags has been set
  **/
@@ -29,6 +32,10 @@ fu_keyring_get_release_flags (XbNode *release,
 {
 	GBytes *blob;
 
+	/* the payload trust is only known once it has been decompressed */
+	if (!fu_cabinet_load_release (release, error))
+		return FALSE;
+
 	blob = g_object_get_data (G_OBJECT (release), "fwupd::ReleaseFlags");
 	if (blob == NULL) {
 		g_debug ("no fwupd::ReleaseFlags set by loader");
@@ -24,11 +24,14 @@
 #include "fwupd-remote-private.h"
 #include "fwupd-resources.h"
 
+#include "fu-auth-cache.h"
 #include "fu-common.h"
 #include "fu-debug.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
 #include "fu-install-task.h"
+#include "fu-metrics.h"
+#include "fu-progress-limiter.h"
 
 #ifndef HAVE_POLKIT_0_114
 #pragma clang diagnostic push
@@ -50,8 +53,15 @@ typedef struct {
 	PolkitAuthority		*authority;
 	guint			 owner_id;
 	FuEngine		*engine;
+	FuMetrics		*metrics;
+	FuMetrics		*metrics_auth;
 	gboolean		 update_in_progress;
 	gboolean		 pending_sigterm;
+	FuProgressLimiter	*progress_limiter;
+	FuAuthCache		*auth_cache;
+	GHashTable		*auth_watches;	/* sender : NameOwnerChanged subscription ID */
+	GPtrArray		*snapshot;	/* (element-type FwupdDevice) */
+	guint			 load_devices_id;
 } FuMainPrivate;
 
 static gboolean
@@ -173,9 +183,22 @@ fu_main_emit_property_changed (FuMainPrivate *priv,
 	g_variant_builder_clear (&invalidated_builder);
 }
 
+static void
+fu_main_progress_limiter_percentage_changed_cb (FuProgressLimiter *progress_limiter,
+						guint percentage,
+						FuMainPrivate *priv)
+{
+	g_debug ("Emitting PropertyChanged('Percentage'='%u%%')", percentage);
+	fu_main_emit_property_changed (priv, "Percentage",
+				       g_variant_new_uint32 (percentage));
+}
+
 static void
 fu_main_set_status (FuMainPrivate *priv, FwupdStatus status)
 {
+	/* send any coalesced percentage before the status changes */
+	fu_progress_limiter_flush (priv->progress_limiter);
+
 	g_debug ("Emitting PropertyChanged('Status'='%s')",
 		 fwupd_status_to_string (status));
 	fu_main_emit_property_changed (priv, "Status",
@@ -199,20 +222,19 @@ fu_main_engine_percentage_changed_cb (FuEngine *engine,
 				      guint percentage,
 				      FuMainPrivate *priv)
 {
-	g_debug ("Emitting PropertyChanged('Percentage'='%u%%')", percentage);
-	fu_main_emit_property_changed (priv, "Percentage",
-				       g_variant_new_uint32 (percentage));
+	fu_progress_limiter_set_interval (priv->progress_limiter,
+					  fu_engine_get_progress_interval (priv->engine));
+	fu_progress_limiter_set_percentage (priv->progress_limiter, percentage);
 }
 
 static gboolean
-fu_main_get_device_flags_for_sender (FuMainPrivate *priv, const char *sender,
-				     FwupdDeviceFlags *flags, GError **error)
+fu_main_get_uid_for_sender (FuMainPrivate *priv, const gchar *sender,
+			    uid_t *calling_uid, GError **error)
 {
-	uid_t calling_uid;
 	g_autoptr(GVariant) value = NULL;
 
 	g_return_val_if_fail (sender != NULL, FALSE);
-	g_return_val_if_fail (flags != NULL, FALSE);
+	g_return_val_if_fail (calling_uid != NULL, FALSE);
 
 	value = g_dbus_proxy_call_sync (priv->proxy_uid,
 					"GetConnectionUnixUser",
@@ -225,7 +247,20 @@ fu_main_get_device_flags_for_sender (FuMainPrivate *priv, const char *sender,
 		g_prefix_error (error, "failed to read user id of caller: ");
 		return FALSE;
 	}
-	g_variant_get (value, "(u)", &calling_uid);
+	g_variant_get (value, "(u)", calling_uid);
+	return TRUE;
+}
+
+static gboolean
+fu_main_get_device_flags_for_sender (FuMainPrivate *priv, const char *sender,
+				     FwupdDeviceFlags *flags, GError **error)
+{
+	uid_t calling_uid;
+
+	g_return_val_if_fail (flags != NULL, FALSE);
+
+	if (!fu_main_get_uid_for_sender (priv, sender, &calling_uid, error))
+		return FALSE;
 	if (calling_uid == 0)
 		*flags |= FWUPD_DEVICE_FLAG_TRUSTED;
 
@@ -296,6 +331,49 @@ fu_main_result_array_to_variant (GPtrArray *results)
 	return g_variant_new ("(aa{sv})", &builder);
 }
 
+typedef struct {
+	FuMetrics		*metrics;
+	gchar			*method_name;
+	gint64			 start_time;
+	guint64			 bytes_out;
+} FuMainMetricsHelper;
+
+/* called when the method has returned and the invocation is destroyed */
+static void
+fu_main_metrics_invocation_weak_notify_cb (gpointer user_data, GObject *where_the_object_was)
+{
+	FuMainMetricsHelper *helper = (FuMainMetricsHelper *) user_data;
+	fu_metrics_add_sample (helper->metrics,
+			       helper->method_name,
+			       g_get_monotonic_time () - helper->start_time,
+			       helper->bytes_out);
+	g_object_unref (helper->metrics);
+	g_free (helper->method_name);
+	g_free (helper);
+}
+
+static void
+fu_main_metrics_watch_invocation (FuMainPrivate *priv, GDBusMethodInvocation *invocation)
+{
+	FuMainMetricsHelper *helper = g_new0 (FuMainMetricsHelper, 1);
+	helper->metrics = g_object_ref (priv->metrics);
+	helper->method_name = g_strdup (g_dbus_method_invocation_get_method_name (invocation));
+	helper->start_time = g_get_monotonic_time ();
+	g_object_set_data (G_OBJECT (invocation), "fwupd-metrics", helper);
+	g_object_weak_ref (G_OBJECT (invocation),
+			   fu_main_metrics_invocation_weak_notify_cb,
+			   helper);
+}
+
+static void
+fu_main_invocation_return_value (GDBusMethodInvocation *invocation, GVariant *val)
+{
+	FuMainMetricsHelper *helper = g_object_get_data (G_OBJECT (invocation), "fwupd-metrics");
+	if (helper != NULL && val != NULL)
+		helper->bytes_out = g_variant_get_size (val);
+	g_dbus_method_invocation_return_value (invocation, val);
+}
+
 typedef struct {
 	GDBusMethodInvocation	*invocation;
 	PolkitSubject		*subject;
@@ -309,6 +387,8 @@ typedef struct {
 	gchar			*remote_id;
 	gchar			*key;
 	gchar			*value;
+	gchar			*action_id;
+	gint64			 auth_time;
 	XbSilo			*silo;
 } FuMainAuthHelper;
 
@@ -331,6 +411,7 @@ fu_main_auth_helper_free (FuMainAuthHelper *helper)
 	g_free (helper->remote_id);
 	g_free (helper->key);
 	g_free (helper->value);
+	g_free (helper->action_id);
 	g_object_unref (helper->invocation);
 	g_free (helper);
 }
@@ -368,19 +449,215 @@ fu_main_authorization_is_valid (PolkitAuthorizationResult *auth, GError **error)
 	return TRUE;
 }
 
+typedef struct {
+	FuMainPrivate		*priv;
+	gchar			*sender;
+	gchar			*action_id;
+} FuMainAuthCacheHelper;
+
 static void
-fu_main_authorize_unlock_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+fu_main_auth_cache_helper_free (FuMainAuthCacheHelper *helper)
 {
-	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
+	g_free (helper->sender);
+	g_free (helper->action_id);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuMainAuthCacheHelper, fu_main_auth_cache_helper_free)
+#pragma clang diagnostic pop
+
+static void
+fu_main_name_owner_changed_cb (GDBusConnection *connection,
+			       const gchar *sender_name,
+			       const gchar *object_path,
+			       const gchar *interface_name,
+			       const gchar *signal_name,
+			       GVariant *parameters,
+			       gpointer user_data)
+{
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
+	const gchar *name = NULL;
+	const gchar *old_owner = NULL;
+	const gchar *new_owner = NULL;
+	guint removed;
+	guint watch_id;
+
+	/* only interested in the client going away */
+	g_variant_get (parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
+	if (new_owner[0] != '\0')
+		return;
+	removed = fu_auth_cache_remove_sender (priv->auth_cache, name);
+	if (removed > 0)
+		g_debug ("%s disconnected, forgot %u authorizations", name, removed);
+	watch_id = GPOINTER_TO_UINT (g_hash_table_lookup (priv->auth_watches, name));
+	if (watch_id != 0) {
+		g_dbus_connection_signal_unsubscribe (connection, watch_id);
+		g_hash_table_remove (priv->auth_watches, name);
+	}
+}
+
+static void
+fu_main_auth_cache_insert (FuMainPrivate *priv,
+			   const gchar *sender,
+			   const gchar *action_id)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	guint watch_id;
+
+	fu_auth_cache_add (priv->auth_cache, sender, action_id);
+
+	/* stop watching clients whose authorizations have all expired */
+	g_hash_table_iter_init (&iter, priv->auth_watches);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		if (fu_auth_cache_has_sender (priv->auth_cache, (const gchar *) key))
+			continue;
+		g_dbus_connection_signal_unsubscribe (priv->connection,
+						      GPOINTER_TO_UINT (value));
+		g_hash_table_iter_remove (&iter);
+	}
+
+	/* forget the authorizations when this client goes away, without
+	 * waking up for every other name on the bus */
+	if (g_hash_table_contains (priv->auth_watches, sender))
+		return;
+	watch_id = g_dbus_connection_signal_subscribe (priv->connection,
+						       "org.freedesktop.DBus",
+						       "org.freedesktop.DBus",
+						       "NameOwnerChanged",
+						       "/org/freedesktop/DBus",
+						       sender,
+						       G_DBUS_SIGNAL_FLAGS_NONE,
+						       fu_main_name_owner_changed_cb,
+						       priv, NULL);
+	g_hash_table_insert (priv->auth_watches,
+			     g_strdup (sender),
+			     GUINT_TO_POINTER (watch_id));
+}
+
+static void
+fu_main_auth_cache_uid_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(FuMainAuthCacheHelper) helper = (FuMainAuthCacheHelper *) user_data;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) value = NULL;
+	uid_t calling_uid = G_MAXUINT;
+
+	value = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (value == NULL) {
+		g_debug ("not caching authorization, failed to read user id of caller: %s",
+			 error->message);
+		return;
+	}
+	g_variant_get (value, "(u)", &calling_uid);
+	if (calling_uid != 0)
+		return;
+	fu_main_auth_cache_insert (helper->priv, helper->sender, helper->action_id);
+}
+
+static void
+fu_main_auth_cache_add (FuMainPrivate *priv,
+			const gchar *sender,
+			const gchar *action_id,
+			PolkitAuthorizationResult *auth)
+{
+	FuMainAuthCacheHelper *helper;
+
+	/* only remember results polkit itself would not ask for again, i.e.
+	 * the user chose to keep the authorization or the caller is root */
+	if (polkit_authorization_result_get_retains_authorization (auth)) {
+		fu_main_auth_cache_insert (priv, sender, action_id);
+		return;
+	}
+
+	/* do not block the method reply on a round trip to the bus */
+	helper = g_new0 (FuMainAuthCacheHelper, 1);
+	helper->priv = priv;
+	helper->sender = g_strdup (sender);
+	helper->action_id = g_strdup (action_id);
+	g_dbus_proxy_call (priv->proxy_uid,
+			   "GetConnectionUnixUser",
+			   g_variant_new ("(s)", sender),
+			   G_DBUS_CALL_FLAGS_NONE,
+			   2000,
+			   NULL,
+			   fu_main_auth_cache_uid_cb,
+			   helper);
+}
+
+/* takes ownership of @helper_ref, which is passed to @callback */
+static void
+fu_main_check_authorization (FuMainAuthHelper *helper_ref,
+			     const gchar *action_id,
+			     GAsyncReadyCallback callback)
+{
+	FuMainPrivate *priv = helper_ref->priv;
+	const gchar *sender = g_dbus_method_invocation_get_sender (helper_ref->invocation);
+	g_autoptr(FuMainAuthHelper) helper = helper_ref;
+	g_autoptr(PolkitSubject) subject = NULL;
+
+	g_free (helper->action_id);
+	helper->action_id = g_strdup (action_id);
+	helper->auth_time = g_get_monotonic_time ();
+
+	/* same caller was authorized for this action recently */
+	if (fu_auth_cache_lookup (priv->auth_cache, sender, action_id)) {
+		g_autofree gchar *id = g_strdup_printf ("%s:cached", action_id);
+		g_autoptr(GTask) task = NULL;
+		g_debug ("using cached authorization for %s from %s", action_id, sender);
+		fu_metrics_add_sample (priv->metrics_auth, id,
+				       g_get_monotonic_time () - helper->auth_time, 0);
+		task = g_task_new (NULL, NULL, callback, g_steal_pointer (&helper));
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+
+	if (helper->subject == NULL)
+		helper->subject = polkit_system_bus_name_new (sender);
+	subject = g_object_ref (helper->subject);
+	polkit_authority_check_authorization (priv->authority, subject,
+					      action_id, NULL,
+					      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
+					      NULL,
+					      callback,
+					      g_steal_pointer (&helper));
+}
+
+static gboolean
+fu_main_check_authorization_finish (FuMainAuthHelper *helper,
+				    GAsyncResult *res,
+				    GError **error)
+{
+	FuMainPrivate *priv = helper->priv;
 	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
+	/* from the cache */
+	if (G_IS_TASK (res))
+		return g_task_propagate_boolean (G_TASK (res), error);
+
+	auth = polkit_authority_check_authorization_finish (priv->authority, res, error);
+	fu_metrics_add_sample (priv->metrics_auth, helper->action_id,
+			       g_get_monotonic_time () - helper->auth_time, 0);
+	if (!fu_main_authorization_is_valid (auth, error))
+		return FALSE;
+	fu_main_auth_cache_add (priv,
+				g_dbus_method_invocation_get_sender (helper->invocation),
+				helper->action_id, auth);
+	return TRUE;
+}
+
+static void
+fu_main_authorize_unlock_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
+	g_autoptr(GError) error = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -392,7 +669,7 @@ fu_main_authorize_unlock_cb (GObject *source, GAsyncResult *res, gpointer user_d
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void
@@ -400,13 +677,10 @@ fu_main_authorize_set_approved_firmware_cb (GObject *source, GAsyncResult *res,
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -416,7 +690,7 @@ fu_main_authorize_set_approved_firmware_cb (GObject *source, GAsyncResult *res,
 		const gchar *csum = g_ptr_array_index (helper->checksums, i);
 		fu_engine_add_approved_firmware (helper->priv->engine, csum);
 	}
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void
@@ -425,13 +699,10 @@ fu_main_authorize_self_sign_cb (GObject *source, GAsyncResult *res, gpointer use
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autofree gchar *sig = NULL;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -444,7 +715,7 @@ fu_main_authorize_self_sign_cb (GObject *source, GAsyncResult *res, gpointer use
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, g_variant_new ("(s)", sig));
+	fu_main_invocation_return_value (helper->invocation, g_variant_new ("(s)", sig));
 }
 
 static void
@@ -452,12 +723,9 @@ fu_main_modify_config_cb (GObject *source, GAsyncResult *res, gpointer user_data
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -468,7 +736,7 @@ fu_main_modify_config_cb (GObject *source, GAsyncResult *res, gpointer user_data
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void
@@ -476,13 +744,10 @@ fu_main_authorize_activate_cb (GObject *source, GAsyncResult *res, gpointer user
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -494,7 +759,7 @@ fu_main_authorize_activate_cb (GObject *source, GAsyncResult *res, gpointer user
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void
@@ -502,13 +767,10 @@ fu_main_authorize_verify_update_cb (GObject *source, GAsyncResult *res, gpointer
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -520,7 +782,7 @@ fu_main_authorize_verify_update_cb (GObject *source, GAsyncResult *res, gpointer
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void
@@ -528,13 +790,10 @@ fu_main_authorize_modify_remote_cb (GObject *source, GAsyncResult *res, gpointer
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -550,7 +809,7 @@ fu_main_authorize_modify_remote_cb (GObject *source, GAsyncResult *res, gpointer
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 static void fu_main_authorize_install_queue (FuMainAuthHelper *helper);
@@ -560,13 +819,10 @@ fu_main_authorize_install_cb (GObject *source, GAsyncResult *res, gpointer user_
 {
 	g_autoptr(FuMainAuthHelper) helper = (FuMainAuthHelper *) user_data;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(PolkitAuthorizationResult) auth = NULL;
 
 	/* get result */
 	fu_main_set_status (helper->priv, FWUPD_STATUS_IDLE);
-	auth = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (source),
-							    res, &error);
-	if (!fu_main_authorization_is_valid (auth, &error)) {
+	if (!fu_main_check_authorization_finish (helper, res, &error)) {
 		g_dbus_method_invocation_return_gerror (helper->invocation, error);
 		return;
 	}
@@ -586,14 +842,10 @@ fu_main_authorize_install_queue (FuMainAuthHelper *helper_ref)
 	/* still more things to to authenticate */
 	if (helper->action_ids->len > 0) {
 		g_autofree gchar *action_id = g_strdup (g_ptr_array_index (helper->action_ids, 0));
-		g_autoptr(PolkitSubject) subject = g_object_ref (helper->subject);
 		g_ptr_array_remove_index (helper->action_ids, 0);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      action_id, NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_install_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     action_id,
+					     fu_main_authorize_install_cb);
 		return;
 	}
 
@@ -613,7 +865,7 @@ fu_main_authorize_install_queue (FuMainAuthHelper *helper_ref)
 	}
 
 	/* success */
-	g_dbus_method_invocation_return_value (helper->invocation, NULL);
+	fu_main_invocation_return_value (helper->invocation, NULL);
 }
 
 #if !GLIB_CHECK_VERSION(2,54,0)
@@ -796,6 +1048,61 @@ fu_main_device_id_valid (const gchar *device_id, GError **error)
 	return FALSE;
 }
 
+/* clients may have cached devices from the snapshot that were unplugged
+ * while the daemon was not running */
+static void
+fu_main_emit_snapshot_removed (FuMainPrivate *priv, GPtrArray *snapshot)
+{
+	/* not yet connected */
+	if (priv->connection == NULL)
+		return;
+	for (guint i = 0; i < snapshot->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (snapshot, i);
+		GVariant *val;
+		g_autoptr(FuDevice) device = NULL;
+
+		device = fu_engine_get_device (priv->engine, fwupd_device_get_id (dev), NULL);
+		if (device != NULL)
+			continue;
+		g_debug ("snapshot device %s no longer exists", fwupd_device_get_id (dev));
+		val = fwupd_device_to_variant (dev);
+		g_dbus_connection_emit_signal (priv->connection,
+					       NULL,
+					       FWUPD_DBUS_PATH,
+					       FWUPD_DBUS_INTERFACE,
+					       "DeviceRemoved",
+					       g_variant_new_tuple (&val, 1), NULL);
+	}
+}
+
+/* stop serving the snapshot and enumerate the real hardware */
+static void
+fu_main_ensure_devices_loaded (FuMainPrivate *priv)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) snapshot = NULL;
+
+	if (priv->snapshot == NULL)
+		return;
+	if (priv->load_devices_id != 0) {
+		g_source_remove (priv->load_devices_id);
+		priv->load_devices_id = 0;
+	}
+	snapshot = g_steal_pointer (&priv->snapshot);
+	if (!fu_engine_load_devices (priv->engine, &error))
+		g_warning ("failed to load devices: %s", error->message);
+	fu_main_emit_snapshot_removed (priv, snapshot);
+}
+
+static gboolean
+fu_main_load_devices_cb (gpointer user_data)
+{
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
+	priv->load_devices_id = 0;
+	fu_main_ensure_devices_loaded (priv);
+	return G_SOURCE_REMOVE;
+}
+
 static void
 fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			    const gchar *object_path, const gchar *interface_name,
@@ -808,11 +1115,32 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 
 	/* activity */
 	fu_engine_idle_reset (priv->engine);
+	fu_main_metrics_watch_invocation (priv, invocation);
+
+	/* only GetDevices can be answered from the snapshot */
+	if (g_strcmp0 (method_name, "GetDevices") != 0)
+		fu_main_ensure_devices_loaded (priv);
 
+	if (g_strcmp0 (method_name, "GetMetrics") == 0) {
+		GVariantBuilder builder;
+		g_debug ("Called %s()", method_name);
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+		fu_metrics_add_to_builder (priv->metrics, &builder);
+		fu_metrics_add_to_builder (priv->metrics_auth, &builder);
+		val = g_variant_builder_end (&builder);
+		fu_main_invocation_return_value (invocation,
+						 g_variant_new_tuple (&val, 1));
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetDevices") == 0) {
 		g_autoptr(GPtrArray) devices = NULL;
 		g_debug ("Called %s()", method_name);
-		devices = fu_engine_get_devices (priv->engine, &error);
+		/* the snapshot only has the untrusted form of each device,
+		 * so no caller gets serial numbers until enumeration is done */
+		if (priv->snapshot != NULL)
+			devices = g_ptr_array_ref (priv->snapshot);
+		else
+			devices = fu_engine_get_devices (priv->engine, &error);
 		if (devices == NULL) {
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
@@ -822,7 +1150,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetReleases") == 0) {
@@ -840,7 +1168,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_release_array_to_variant (releases);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetApprovedFirmware") == 0) {
@@ -852,15 +1180,14 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_variant_builder_add_value (&builder, g_variant_new_string (checksum));
 		}
 		val = g_variant_builder_end (&builder);
-		g_dbus_method_invocation_return_value (invocation,
-						       g_variant_new_tuple (&val, 1));
+		fu_main_invocation_return_value (invocation,
+						 g_variant_new_tuple (&val, 1));
 		return;
 	}
 	if (g_strcmp0 (method_name, "SetApprovedFirmware") == 0) {
 		g_autofree gchar *checksums_str = NULL;
 		g_auto(GStrv) checksums = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		g_variant_get (parameters, "(^as)", &checksums);
 		checksums_str = g_strjoinv (",", checksums);
@@ -874,14 +1201,9 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		helper->checksums = g_ptr_array_new_with_free_func (g_free);
 		for (guint i = 0; checksums[i] != NULL; i++)
 			g_ptr_array_add (helper->checksums, g_strdup (checksums[i]));
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.set-approved-firmware",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_set_approved_firmware_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.set-approved-firmware",
+					     fu_main_authorize_set_approved_firmware_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "SelfSign") == 0) {
@@ -889,7 +1211,6 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		gchar *prop_key;
 		g_autofree gchar *value = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 		g_autoptr(GVariantIter) iter = NULL;
 
 		g_variant_get (parameters, "(sa{sv})", &value, &iter);
@@ -913,14 +1234,9 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		helper->priv = priv;
 		helper->value = g_steal_pointer (&value);
 		helper->invocation = g_object_ref (invocation);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.self-sign",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_self_sign_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.self-sign",
+					     fu_main_authorize_self_sign_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetDowngrades") == 0) {
@@ -938,7 +1254,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_release_array_to_variant (releases);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetUpgrades") == 0) {
@@ -956,7 +1272,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_release_array_to_variant (releases);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetRemotes") == 0) {
@@ -968,7 +1284,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_remote_array_to_variant (remotes);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetHistory") == 0) {
@@ -984,7 +1300,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "ClearResults") == 0) {
@@ -995,7 +1311,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, NULL);
+		fu_main_invocation_return_value (invocation, NULL);
 		return;
 	}
 	if (g_strcmp0 (method_name, "ModifyDevice") == 0) {
@@ -1010,7 +1326,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, NULL);
+		fu_main_invocation_return_value (invocation, NULL);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetResults") == 0) {
@@ -1028,8 +1344,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fwupd_device_to_variant (result);
-		g_dbus_method_invocation_return_value (invocation,
-						       g_variant_new_tuple (&val, 1));
+		fu_main_invocation_return_value (invocation,
+						 g_variant_new_tuple (&val, 1));
 		return;
 	}
 	if (g_strcmp0 (method_name, "UpdateMetadata") == 0) {
@@ -1071,13 +1387,12 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, NULL);
+		fu_main_invocation_return_value (invocation, NULL);
 		return;
 	}
 	if (g_strcmp0 (method_name, "Unlock") == 0) {
 		const gchar *device_id = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		g_variant_get (parameters, "(&s)", &device_id);
 		g_debug ("Called %s(%s)", method_name, device_id);
@@ -1092,20 +1407,14 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		helper->priv = priv;
 		helper->invocation = g_object_ref (invocation);
 		helper->device_id = g_strdup (device_id);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.device-unlock",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_unlock_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.device-unlock",
+					     fu_main_authorize_unlock_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "Activate") == 0) {
 		const gchar *device_id = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		g_variant_get (parameters, "(&s)", &device_id);
 		g_debug ("Called %s(%s)", method_name, device_id);
@@ -1120,21 +1429,15 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		helper->priv = priv;
 		helper->invocation = g_object_ref (invocation);
 		helper->device_id = g_strdup (device_id);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.device-activate",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_activate_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.device-activate",
+					     fu_main_authorize_activate_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "ModifyConfig") == 0) {
 		g_autofree gchar *key = NULL;
 		g_autofree gchar *value = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		g_variant_get (parameters, "(ss)", &key, &value);
 		g_debug ("Called %s(%s=%s)", method_name, key, value);
@@ -1145,14 +1448,9 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		helper->key = g_steal_pointer (&key);
 		helper->value = g_steal_pointer (&value);
 		helper->invocation = g_object_ref (invocation);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.modify-config",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_modify_config_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.modify-config",
+					     fu_main_modify_config_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "ModifyRemote") == 0) {
@@ -1160,7 +1458,6 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		const gchar *key = NULL;
 		const gchar *value = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		/* check the id exists */
 		g_variant_get (parameters, "(&s&s&s)", &remote_id, &key, &value);
@@ -1176,20 +1473,14 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 
 		/* authenticate */
 		fu_main_set_status (priv, FWUPD_STATUS_WAITING_FOR_AUTH);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.modify-remote",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_modify_remote_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.modify-remote",
+					     fu_main_authorize_modify_remote_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "VerifyUpdate") == 0) {
 		const gchar *device_id = NULL;
 		g_autoptr(FuMainAuthHelper) helper = NULL;
-		g_autoptr(PolkitSubject) subject = NULL;
 
 		/* check the id exists */
 		g_variant_get (parameters, "(&s)", &device_id);
@@ -1207,14 +1498,9 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 
 		/* authenticate */
 		fu_main_set_status (priv, FWUPD_STATUS_WAITING_FOR_AUTH);
-		subject = polkit_system_bus_name_new (sender);
-		polkit_authority_check_authorization (priv->authority, subject,
-						      "org.freedesktop.fwupd.verify-update",
-						      NULL,
-						      POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION,
-						      NULL,
-						      fu_main_authorize_verify_update_cb,
-						      g_steal_pointer (&helper));
+		fu_main_check_authorization (g_steal_pointer (&helper),
+					     "org.freedesktop.fwupd.verify-update",
+					     fu_main_authorize_verify_update_cb);
 		return;
 	}
 	if (g_strcmp0 (method_name, "Verify") == 0) {
@@ -1229,7 +1515,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, NULL);
+		fu_main_invocation_return_value (invocation, NULL);
 		return;
 	}
 	if (g_strcmp0 (method_name, "Install") == 0) {
@@ -1352,7 +1638,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_result_array_to_variant (results);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, val);
 		return;
 	}
 	g_set_error (&error,
@@ -1446,7 +1732,15 @@ fu_main_on_name_acquired_cb (GDBusConnection *connection,
 			     const gchar *name,
 			     gpointer user_data)
 {
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
 	g_debug ("FuMain: acquired name: %s", name);
+
+	/* let any queued GetDevices calls be answered from the snapshot first */
+	if (priv->snapshot != NULL) {
+		priv->load_devices_id = g_idle_add_full (G_PRIORITY_LOW,
+							 fu_main_load_devices_cb,
+							 priv, NULL);
+	}
 }
 
 static void
@@ -1488,14 +1782,33 @@ fu_main_memory_monitor_warning_cb (GMemoryMonitor *memory_monitor,
 				   GMemoryMonitorWarningLevel level,
 				   FuMainPrivate *priv)
 {
-	/* can do straight away? */
+	FuEngineShedFlags flags = FU_ENGINE_SHED_FLAG_CACHES | FU_ENGINE_SHED_FLAG_HEAP;
+	guint64 reclaimed;
+	g_autofree gchar *reclaimed_str = NULL;
+
+	/* we can just rescan hardware when restarted */
+	if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL) {
+		if (priv->update_in_progress) {
+			g_warning ("OOM during a firmware update, ignoring");
+			priv->pending_sigterm = TRUE;
+			return;
+		}
+		g_debug ("OOM event, shutting down");
+		g_main_loop_quit (priv->loop);
+		return;
+	}
+
+	/* do not pull anything away from an update */
 	if (priv->update_in_progress) {
-		g_warning ("OOM during a firmware update, ignoring");
-		priv->pending_sigterm = TRUE;
+		g_debug ("low memory warning during a firmware update, ignoring");
 		return;
 	}
-	g_debug ("OOM event, shutting down");
-	g_main_loop_quit (priv->loop);
+	if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM)
+		flags |= FU_ENGINE_SHED_FLAG_HISTORY;
+	reclaimed = fu_engine_shed_memory (priv->engine, flags);
+	reclaimed_str = g_format_size (reclaimed);
+	g_message ("low memory warning level %u, reclaimed %s",
+		   (guint) level, reclaimed_str);
 }
 #endif
 
@@ -1521,6 +1834,10 @@ fu_main_load_introspection (const gchar *filename, GError **error)
 static void
 fu_main_private_free (FuMainPrivate *priv)
 {
+	if (priv->load_devices_id != 0)
+		g_source_remove (priv->load_devices_id);
+	if (priv->snapshot != NULL)
+		g_ptr_array_unref (priv->snapshot);
 	if (priv->loop != NULL)
 		g_main_loop_unref (priv->loop);
 	if (priv->owner_id > 0)
@@ -1529,6 +1846,24 @@ fu_main_private_free (FuMainPrivate *priv)
 		g_object_unref (priv->proxy_uid);
 	if (priv->engine != NULL)
 		g_object_unref (priv->engine);
+	if (priv->metrics != NULL)
+		g_object_unref (priv->metrics);
+	if (priv->metrics_auth != NULL)
+		g_object_unref (priv->metrics_auth);
+	if (priv->progress_limiter != NULL)
+		g_object_unref (priv->progress_limiter);
+	if (priv->auth_cache != NULL)
+		g_object_unref (priv->auth_cache);
+	if (priv->auth_watches != NULL) {
+		GHashTableIter iter;
+		gpointer value;
+		g_hash_table_iter_init (&iter, priv->auth_watches);
+		while (g_hash_table_iter_next (&iter, NULL, &value)) {
+			g_dbus_connection_signal_unsubscribe (priv->connection,
+							      GPOINTER_TO_UINT (value));
+		}
+		g_hash_table_unref (priv->auth_watches);
+	}
 	if (priv->connection != NULL)
 		g_object_unref (priv->connection);
 	if (priv->authority != NULL)
@@ -1552,6 +1887,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuMainPrivate, fu_main_private_free)
 int
 main (int argc, char *argv[])
 {
+	FuEngineLoadFlags load_flags = FU_ENGINE_LOAD_FLAG_NONE;
 	gboolean immediate_exit = FALSE;
 	gboolean timed_exit = FALSE;
 	const GOptionEntry options[] = {
@@ -1589,6 +1925,16 @@ main (int argc, char *argv[])
 	/* create new objects */
 	priv = g_new0 (FuMainPrivate, 1);
 	priv->loop = g_main_loop_new (NULL, FALSE);
+	priv->metrics = fu_metrics_new ();
+	fu_metrics_set_kind (priv->metrics, "method");
+	priv->metrics_auth = fu_metrics_new ();
+	fu_metrics_set_kind (priv->metrics_auth, "authorization");
+	priv->progress_limiter = fu_progress_limiter_new ();
+	g_signal_connect (priv->progress_limiter, "percentage-changed",
+			  G_CALLBACK (fu_main_progress_limiter_percentage_changed_cb),
+			  priv);
+	priv->auth_cache = fu_auth_cache_new ();
+	priv->auth_watches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
 	/* load engine */
 	priv->engine = fu_engine_new (FU_APP_FLAGS_NONE);
@@ -1610,7 +1956,18 @@ main (int argc, char *argv[])
 	g_signal_connect (priv->engine, "percentage-changed",
 			  G_CALLBACK (fu_main_engine_percentage_changed_cb),
 			  priv);
-	if (!fu_engine_load (priv->engine, FU_ENGINE_LOAD_FLAG_NONE, &error)) {
+
+	/* return the devices found by the last instance until the hardware has
+	 * been enumerated, unless profiling the startup */
+	if (!immediate_exit && !timed_exit) {
+		g_autoptr(GError) error_snapshot = NULL;
+		priv->snapshot = fu_engine_load_snapshot (priv->engine, &error_snapshot);
+		if (priv->snapshot == NULL)
+			g_debug ("not using snapshot: %s", error_snapshot->message);
+		else
+			load_flags |= FU_ENGINE_LOAD_FLAG_DEFER_ENUMERATE;
+	}
+	if (!fu_engine_load (priv->engine, load_flags, &error)) {
 		g_printerr ("Failed to load engine: %s\n", error->message);
 		return EXIT_FAILURE;
 	}
@@ -1626,7 +1983,7 @@ main (int argc, char *argv[])
 			  G_CALLBACK (fu_main_argv_changed_cb), priv);
 
 #if GLIB_CHECK_VERSION(2,63,3)
-	/* shut down on low memory event as we can just rescan hardware */
+	/* release caches on low memory, and shut down if critical */
 	priv->memory_monitor = g_memory_monitor_dup_default ();
 	g_signal_connect (G_OBJECT (priv->memory_monitor), "low-memory-warning",
 			  G_CALLBACK (fu_main_memory_monitor_warning_cb), priv);
@@ -1670,6 +2027,14 @@ main (int argc, char *argv[])
 	g_message ("Daemon ready for requests");
 	g_main_loop_run (priv->loop);
 
+	/* allow the next instance to start quickly */
+	if (priv->snapshot == NULL && !priv->update_in_progress &&
+	    !immediate_exit && !timed_exit) {
+		g_autoptr(GError) error_snapshot = NULL;
+		if (!fu_engine_save_snapshot (priv->engine, &error_snapshot))
+			g_warning ("failed to save snapshot: %s", error_snapshot->message);
+	}
+
 	/* success */
 	return EXIT_SUCCESS;
 }
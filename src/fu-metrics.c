@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuMetrics"
+
+#include "config.h"
+
+#include <glib-object.h>
+
+#include "fu-metrics.h"
+
+/* each power of two is split into 2^3 buckets, so a reported percentile is
+ * never more than 12.5% larger than the real value */
+#define FU_METRICS_SUB_BUCKET_BITS		3
+#define FU_METRICS_SUB_BUCKETS			(1u << FU_METRICS_SUB_BUCKET_BITS)
+#define FU_METRICS_DURATION_BITS		40	/* µs, about 12 days */
+#define FU_METRICS_BUCKETS			((FU_METRICS_DURATION_BITS - FU_METRICS_SUB_BUCKET_BITS + 1) * \
+						 FU_METRICS_SUB_BUCKETS)
+
+static void fu_metrics_finalize	 (GObject *obj);
+
+struct _FuMetrics
+{
+	GObject			 parent_instance;
+	GHashTable		*items;		/* id:FuMetricsItem */
+	gchar			*kind;
+};
+
+typedef struct {
+	guint64			 count;
+	guint64			 sum;
+	guint64			 bytes_out;
+	guint64			 buckets[FU_METRICS_BUCKETS];
+} FuMetricsItem;
+
+G_DEFINE_TYPE (FuMetrics, fu_metrics, G_TYPE_OBJECT)
+
+static guint
+fu_metrics_value_to_bucket (guint64 value)
+{
+	guint msb = 0;
+
+	if (value >= ((guint64) 1 << FU_METRICS_DURATION_BITS))
+		return FU_METRICS_BUCKETS - 1;
+	if (value < FU_METRICS_SUB_BUCKETS)
+		return (guint) value;
+	for (guint64 tmp = value >> 1; tmp != 0; tmp >>= 1)
+		msb++;
+	return (msb - FU_METRICS_SUB_BUCKET_BITS + 1) * FU_METRICS_SUB_BUCKETS +
+		((value >> (msb - FU_METRICS_SUB_BUCKET_BITS)) & (FU_METRICS_SUB_BUCKETS - 1));
+}
+
+/* returns the largest value that would be put into the bucket */
+static guint64
+fu_metrics_bucket_to_value (guint bucket)
+{
+	guint exponent = bucket / FU_METRICS_SUB_BUCKETS;
+	guint64 mantissa = bucket % FU_METRICS_SUB_BUCKETS;
+	if (exponent == 0)
+		return bucket;
+	return ((FU_METRICS_SUB_BUCKETS + mantissa + 1) << (exponent - 1)) - 1;
+}
+
+/**
+ * fu_metrics_set_kind:
+ * @self: A #FuMetrics
+ * @kind: (nullable): what is being timed, e.g. `method` or `authorization`
+ *
+ * Sets the kind of event, which is exported so that metrics from several
+ * #FuMetrics objects with overlapping IDs can be told apart.
+ **/
+void
+fu_metrics_set_kind (FuMetrics *self, const gchar *kind)
+{
+	g_return_if_fail (FU_IS_METRICS (self));
+	g_free (self->kind);
+	self->kind = g_strdup (kind);
+}
+
+/**
+ * fu_metrics_add_sample:
+ * @self: A #FuMetrics
+ * @id: An identifier, e.g. `GetDevices`
+ * @duration: time taken in µs
+ * @bytes_out: number of bytes sent in the response, or 0
+ *
+ * Records a single timed event.
+ **/
+void
+fu_metrics_add_sample (FuMetrics *self, const gchar *id, guint64 duration, guint64 bytes_out)
+{
+	FuMetricsItem *item;
+
+	g_return_if_fail (FU_IS_METRICS (self));
+	g_return_if_fail (id != NULL);
+
+	item = g_hash_table_lookup (self->items, id);
+	if (item == NULL) {
+		item = g_new0 (FuMetricsItem, 1);
+		g_hash_table_insert (self->items, g_strdup (id), item);
+	}
+	item->count++;
+	item->sum += duration;
+	item->bytes_out += bytes_out;
+	item->buckets[fu_metrics_value_to_bucket (duration)]++;
+}
+
+/**
+ * fu_metrics_get_count:
+ * @self: A #FuMetrics
+ * @id: An identifier, e.g. `GetDevices`
+ *
+ * Gets the number of samples recorded.
+ *
+ * Returns: integer
+ **/
+guint64
+fu_metrics_get_count (FuMetrics *self, const gchar *id)
+{
+	FuMetricsItem *item;
+	g_return_val_if_fail (FU_IS_METRICS (self), 0);
+	g_return_val_if_fail (id != NULL, 0);
+	item = g_hash_table_lookup (self->items, id);
+	if (item == NULL)
+		return 0;
+	return item->count;
+}
+
+static guint64
+fu_metrics_item_get_percentile (FuMetricsItem *item, guint percentile)
+{
+	guint64 cumulative = 0;
+	guint64 rank;
+
+	if (item->count == 0)
+		return 0;
+	rank = (item->count * percentile + 99) / 100;
+	if (rank == 0)
+		rank = 1;
+	for (guint i = 0; i < FU_METRICS_BUCKETS; i++) {
+		cumulative += item->buckets[i];
+		if (cumulative >= rank)
+			return fu_metrics_bucket_to_value (i);
+	}
+	return fu_metrics_bucket_to_value (FU_METRICS_BUCKETS - 1);
+}
+
+/**
+ * fu_metrics_get_percentile:
+ * @self: A #FuMetrics
+ * @id: An identifier, e.g. `GetDevices`
+ * @percentile: A value from 0 to 100, e.g. 95
+ *
+ * Gets the approximate duration that the percentage of samples completed in.
+ *
+ * Returns: time in µs, or 0 if no samples have been recorded
+ **/
+guint64
+fu_metrics_get_percentile (FuMetrics *self, const gchar *id, guint percentile)
+{
+	FuMetricsItem *item;
+	g_return_val_if_fail (FU_IS_METRICS (self), 0);
+	g_return_val_if_fail (id != NULL, 0);
+	g_return_val_if_fail (percentile <= 100, 0);
+	item = g_hash_table_lookup (self->items, id);
+	if (item == NULL)
+		return 0;
+	return fu_metrics_item_get_percentile (item, percentile);
+}
+
+/**
+ * fu_metrics_add_to_builder:
+ * @self: A #FuMetrics
+ * @builder: A #GVariantBuilder of type `aa{sv}`
+ *
+ * Adds all the recorded metrics to @builder, sorted by ID.
+ **/
+void
+fu_metrics_add_to_builder (FuMetrics *self, GVariantBuilder *builder)
+{
+	g_autoptr(GList) ids = NULL;
+
+	g_return_if_fail (FU_IS_METRICS (self));
+	g_return_if_fail (builder != NULL);
+
+	ids = g_hash_table_get_keys (self->items);
+	ids = g_list_sort (ids, (GCompareFunc) g_strcmp0);
+	for (GList *l = ids; l != NULL; l = l->next) {
+		const gchar *id = l->data;
+		FuMetricsItem *item = g_hash_table_lookup (self->items, id);
+		GVariantBuilder dict;
+		g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+		g_variant_builder_add (&dict, "{sv}", "Id",
+				       g_variant_new_string (id));
+		if (self->kind != NULL) {
+			g_variant_builder_add (&dict, "{sv}", "Kind",
+					       g_variant_new_string (self->kind));
+		}
+		g_variant_builder_add (&dict, "{sv}", "Count",
+				       g_variant_new_uint64 (item->count));
+		g_variant_builder_add (&dict, "{sv}", "Sum",
+				       g_variant_new_uint64 (item->sum));
+		g_variant_builder_add (&dict, "{sv}", "BytesOut",
+				       g_variant_new_uint64 (item->bytes_out));
+		g_variant_builder_add (&dict, "{sv}", "P50",
+				       g_variant_new_uint64 (fu_metrics_item_get_percentile (item, 50)));
+		g_variant_builder_add (&dict, "{sv}", "P95",
+				       g_variant_new_uint64 (fu_metrics_item_get_percentile (item, 95)));
+		g_variant_builder_add (&dict, "{sv}", "P99",
+				       g_variant_new_uint64 (fu_metrics_item_get_percentile (item, 99)));
+		g_variant_builder_add_value (builder, g_variant_builder_end (&dict));
+	}
+}
+
+/**
+ * fu_metrics_to_variant:
+ * @self: A #FuMetrics
+ *
+ * Exports all the recorded metrics, sorted by ID.
+ *
+ * Returns: (transfer floating): a #GVariant of type `aa{sv}`
+ **/
+GVariant *
+fu_metrics_to_variant (FuMetrics *self)
+{
+	GVariantBuilder builder;
+
+	g_return_val_if_fail (FU_IS_METRICS (self), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+	fu_metrics_add_to_builder (self, &builder);
+	return g_variant_builder_end (&builder);
+}
+
+static void
+fu_metrics_class_init (FuMetricsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_metrics_finalize;
+}
+
+static void
+fu_metrics_init (FuMetrics *self)
+{
+	self->items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+fu_metrics_finalize (GObject *obj)
+{
+	FuMetrics *self = FU_METRICS (obj);
+
+	g_hash_table_unref (self->items);
+	g_free (self->kind);
+
+	G_OBJECT_CLASS (fu_metrics_parent_class)->finalize (obj);
+}
+
+FuMetrics *
+fu_metrics_new (void)
+{
+	FuMetrics *self;
+	self = g_object_new (FU_TYPE_METRICS, NULL);
+	return FU_METRICS (self);
+}
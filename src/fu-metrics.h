@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#define FU_TYPE_METRICS (fu_metrics_get_type ())
+G_DECLARE_FINAL_TYPE (FuMetrics, fu_metrics, FU, METRICS, GObject)
+
+FuMetrics	*fu_metrics_new			(void);
+void		 fu_metrics_set_kind		(FuMetrics	*self,
+						 const gchar	*kind);
+void		 fu_metrics_add_sample		(FuMetrics	*self,
+						 const gchar	*id,
+						 guint64	 duration,
+						 guint64	 bytes_out);
+guint64		 fu_metrics_get_count		(FuMetrics	*self,
+						 const gchar	*id);
+guint64		 fu_metrics_get_percentile	(FuMetrics	*self,
+						 const gchar	*id,
+						 guint		 percentile);
+void		 fu_metrics_add_to_builder	(FuMetrics	*self,
+						 GVariantBuilder *builder);
+GVariant	*fu_metrics_to_variant		(FuMetrics	*self);
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuProgressLimiter"
+
+#include "config.h"
+
+#include "fu-progress-limiter.h"
+
+enum {
+	SIGNAL_PERCENTAGE_CHANGED,
+	SIGNAL_LAST
+};
+
+static guint signals[SIGNAL_LAST] = { 0 };
+
+static void fu_progress_limiter_finalize	 (GObject *obj);
+
+struct _FuProgressLimiter
+{
+	GObject			 parent_instance;
+	guint			 interval;		/* ms */
+	guint			 timeout_id;
+	guint			 percentage_pending;	/* or G_MAXUINT if unset */
+	guint			 percentage_emitted;	/* or G_MAXUINT if unset */
+	gint64			 percentage_emitted_time;	/* us */
+};
+
+G_DEFINE_TYPE (FuProgressLimiter, fu_progress_limiter, G_TYPE_OBJECT)
+
+/**
+ * fu_progress_limiter_flush:
+ * @self: A #FuProgressLimiter
+ *
+ * Emits any percentage that is being held back, e.g. because the status is
+ * about to change.
+ **/
+void
+fu_progress_limiter_flush (FuProgressLimiter *self)
+{
+	g_return_if_fail (FU_IS_PROGRESS_LIMITER (self));
+
+	if (self->timeout_id != 0) {
+		g_source_remove (self->timeout_id);
+		self->timeout_id = 0;
+	}
+	if (self->percentage_emitted == self->percentage_pending)
+		return;
+	self->percentage_emitted = self->percentage_pending;
+	self->percentage_emitted_time = g_get_monotonic_time ();
+	g_signal_emit (self, signals[SIGNAL_PERCENTAGE_CHANGED], 0,
+		       self->percentage_emitted);
+}
+
+static gboolean
+fu_progress_limiter_timeout_cb (gpointer user_data)
+{
+	FuProgressLimiter *self = FU_PROGRESS_LIMITER (user_data);
+	self->timeout_id = 0;
+	fu_progress_limiter_flush (self);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * fu_progress_limiter_set_interval:
+ * @self: A #FuProgressLimiter
+ * @interval: minimum time between signals in ms, or 0 for no limit
+ *
+ * Sets how often ::percentage-changed can be emitted.
+ **/
+void
+fu_progress_limiter_set_interval (FuProgressLimiter *self, guint interval)
+{
+	g_return_if_fail (FU_IS_PROGRESS_LIMITER (self));
+	self->interval = interval;
+}
+
+/**
+ * fu_progress_limiter_set_percentage:
+ * @self: A #FuProgressLimiter
+ * @percentage: A value from 0 to 100
+ *
+ * Sets the current percentage. The start and the end of the transfer are
+ * always emitted straight away, and other values are coalesced so that
+ * ::percentage-changed is not emitted more often than the interval.
+ **/
+void
+fu_progress_limiter_set_percentage (FuProgressLimiter *self, guint percentage)
+{
+	gint64 elapsed;
+
+	g_return_if_fail (FU_IS_PROGRESS_LIMITER (self));
+
+	/* always send the start and the end of the transfer */
+	self->percentage_pending = percentage;
+	if (self->interval == 0 || percentage == 0 || percentage == 100) {
+		fu_progress_limiter_flush (self);
+		return;
+	}
+
+	/* rate limit, but make sure the last value gets sent eventually */
+	elapsed = (g_get_monotonic_time () - self->percentage_emitted_time) / 1000;
+	if (elapsed >= (gint64) self->interval) {
+		fu_progress_limiter_flush (self);
+		return;
+	}
+	if (self->timeout_id == 0) {
+		self->timeout_id = g_timeout_add (self->interval - (guint) elapsed,
+						  fu_progress_limiter_timeout_cb,
+						  self);
+	}
+}
+
+static void
+fu_progress_limiter_class_init (FuProgressLimiterClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_progress_limiter_finalize;
+
+	signals[SIGNAL_PERCENTAGE_CHANGED] =
+		g_signal_new ("percentage-changed",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_VOID__UINT,
+			      G_TYPE_NONE, 1, G_TYPE_UINT);
+}
+
+static void
+fu_progress_limiter_init (FuProgressLimiter *self)
+{
+	self->percentage_pending = G_MAXUINT;
+	self->percentage_emitted = G_MAXUINT;
+}
+
+static void
+fu_progress_limiter_finalize (GObject *obj)
+{
+	FuProgressLimiter *self = FU_PROGRESS_LIMITER (obj);
+
+	if (self->timeout_id != 0)
+		g_source_remove (self->timeout_id);
+
+	G_OBJECT_CLASS (fu_progress_limiter_parent_class)->finalize (obj);
+}
+
+FuProgressLimiter *
+fu_progress_limiter_new (void)
+{
+	FuProgressLimiter *self;
+	self = g_object_new (FU_TYPE_PROGRESS_LIMITER, NULL);
+	return FU_PROGRESS_LIMITER (self);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#define FU_TYPE_PROGRESS_LIMITER (fu_progress_limiter_get_type ())
+G_DECLARE_FINAL_TYPE (FuProgressLimiter, fu_progress_limiter, FU, PROGRESS_LIMITER, GObject)
+
+FuProgressLimiter *fu_progress_limiter_new		(void);
+void		 fu_progress_limiter_set_interval	(FuProgressLimiter	*self,
+							 guint			 interval);
+void		 fu_progress_limiter_set_percentage	(FuProgressLimiter	*self,
+							 guint			 percentage);
+void		 fu_progress_limiter_flush		(FuProgressLimiter	*self);
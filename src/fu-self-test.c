@@ -14,15 +14,20 @@
 #include <libgcab.h>
 #include <stdlib.h>
 #include <string.h>
+#include <utime.h>
 
+#include "fu-auth-cache.h"
 #include "fu-config.h"
 #include "fu-device-list.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
+#include "fu-firmware-cache.h"
 #include "fu-history.h"
 #include "fu-install-task.h"
+#include "fu-metrics.h"
 #include "fu-plugin-private.h"
 #include "fu-plugin-list.h"
+#include "fu-progress-limiter.h"
 #include "fu-progressbar.h"
 #include "fu-hash.h"
 #include "fu-smbios-private.h"
@@ -151,6 +156,42 @@ fu_engine_generate_md_func (gconstpointer user_data)
 	g_assert_cmpstr (tmp, ==, NULL);
 }
 
+static void
+fu_engine_shed_memory_metadata_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GBytes) data = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) component1 = NULL;
+	g_autoptr(XbNode) component2 = NULL;
+
+	/* put cab file somewhere we can parse it */
+	filename = g_build_filename (TESTDATADIR_DST, "colorhug", "colorhug-als-3.0.2.cab", NULL);
+	data = fu_common_get_contents_bytes (filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data);
+	ret = fu_common_set_contents_bytes ("/tmp/fwupd-self-test/var/cache/fwupd/foo.cab",
+					    data, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fu_device_add_guid (device, "12345678-1234-1234-1234-123456789012");
+	component1 = fu_engine_get_component_by_guids (engine, device);
+	g_assert_nonnull (component1);
+
+	/* the metadata is reloaded on the next query */
+	fu_engine_shed_memory (engine, FU_ENGINE_SHED_FLAG_CACHES);
+	component2 = fu_engine_get_component_by_guids (engine, device);
+	g_assert_nonnull (component2);
+	g_assert_cmpstr (xb_node_query_text (component2, "id", NULL), ==,
+			 xb_node_query_text (component1, "id", NULL));
+}
+
 static void
 fu_plugin_hash_func (gconstpointer user_data)
 {
@@ -1078,6 +1119,177 @@ fu_engine_device_unlock_func (gconstpointer user_data)
 	g_assert_nonnull (fwupd_device_get_release_default (FWUPD_DEVICE (device)));
 }
 
+static void
+fu_engine_snapshot_func (gconstpointer user_data)
+{
+	FwupdDevice *device_tmp;
+	gboolean ret;
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	fu_engine_set_silo (engine, silo_empty);
+
+	/* add a dummy device */
+	fu_device_set_id (device, "dummy");
+	fu_device_set_name (device, "Dummy device");
+	fu_device_set_serial (device, "12345");
+	fu_device_set_version_format (device, FWUPD_VERSION_FORMAT_TRIPLET);
+	fu_device_set_version (device, "1.2.3");
+	fu_device_add_guid (device, "12345678-1234-1234-1234-123456789012");
+	fu_device_add_flag (device, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fu_engine_add_device (engine, device);
+
+	/* save and load */
+	ret = fu_engine_save_snapshot (engine, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	devices = fu_engine_load_snapshot (engine, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 1);
+	device_tmp = g_ptr_array_index (devices, 0);
+	g_assert_cmpstr (fwupd_device_get_id (device_tmp), ==, fu_device_get_id (device));
+	g_assert_cmpstr (fwupd_device_get_name (device_tmp), ==, "Dummy device");
+	g_assert_cmpstr (fwupd_device_get_version (device_tmp), ==, "1.2.3");
+	g_assert_cmpstr (fwupd_device_get_serial (device_tmp), ==, NULL);
+	g_assert_true (fwupd_device_has_flag (device_tmp, FWUPD_DEVICE_FLAG_UPDATABLE));
+
+	/* only used once */
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	devices = fu_engine_load_snapshot (engine, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (devices);
+}
+
+static void
+fu_engine_cabinet_cache_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GBytes) blob_cab = NULL;
+	g_autoptr(GBytes) blob_cab2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo1 = NULL;
+	g_autoptr(XbSilo) silo2 = NULL;
+	g_autoptr(XbSilo) silo3 = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+#if defined(__s390x__)
+	/* See https://github.com/fwupd/fwupd/issues/318 for more information */
+	g_test_skip ("Skipping cabinet test on s390x due to known problem with gcab");
+	return;
+#endif
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* get generated file as a blob */
+	filename = g_build_filename (TESTDATADIR_DST, "missing-hwid", "hwid-1.2.3.cab", NULL);
+	blob_cab = fu_common_get_contents_bytes (filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_cab);
+	silo1 = fu_engine_get_silo_from_blob (engine, blob_cab, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo1);
+
+	/* the same contents are only parsed once */
+	blob_cab2 = g_bytes_new (g_bytes_get_data (blob_cab, NULL),
+				 g_bytes_get_size (blob_cab));
+	silo2 = fu_engine_get_silo_from_blob (engine, blob_cab2, &error);
+	g_assert_no_error (error);
+	g_assert_true (silo2 == silo1);
+
+	/* parsed again when the caches have been dropped */
+	fu_engine_shed_memory (engine, FU_ENGINE_SHED_FLAG_CACHES);
+	silo3 = fu_engine_get_silo_from_blob (engine, blob_cab, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo3);
+	g_assert_true (silo3 != silo1);
+}
+
+static GBytes *
+fu_test_get_cab (const gchar *dirname, const gchar *basename)
+{
+	g_autofree gchar *filename = g_build_filename (TESTDATADIR_DST, dirname, basename, NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GBytes) blob = fu_common_get_contents_bytes (filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob);
+	return g_steal_pointer (&blob);
+}
+
+static void
+fu_engine_cabinet_cache_evict_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GBytes) blob_a = NULL;
+	g_autoptr(GBytes) blob_b = NULL;
+	g_autoptr(GBytes) blob_c = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_a1 = NULL;
+	g_autoptr(XbSilo) silo_a2 = NULL;
+	g_autoptr(XbSilo) silo_a3 = NULL;
+	g_autoptr(XbSilo) silo_b1 = NULL;
+	g_autoptr(XbSilo) silo_b2 = NULL;
+	g_autoptr(XbSilo) silo_c = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+#if defined(__s390x__)
+	/* See https://github.com/fwupd/fwupd/issues/318 for more information */
+	g_test_skip ("Skipping cabinet test on s390x due to known problem with gcab");
+	return;
+#endif
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* only room for two of the three archives */
+	blob_a = fu_test_get_cab ("missing-hwid", "hwid-1.2.3.cab");
+	blob_b = fu_test_get_cab ("missing-hwid", "noreqs-1.2.3.cab");
+	blob_c = fu_test_get_cab ("colorhug", "colorhug-als-3.0.2.cab");
+	fu_engine_set_cabinet_cache_size_max (engine,
+					      g_bytes_get_size (blob_a) +
+					      g_bytes_get_size (blob_b) +
+					      g_bytes_get_size (blob_c) - 1);
+
+	/* use A again after B so that B is the least recently used */
+	silo_a1 = fu_engine_get_silo_from_blob (engine, blob_a, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo_a1);
+	silo_b1 = fu_engine_get_silo_from_blob (engine, blob_b, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo_b1);
+	silo_a2 = fu_engine_get_silo_from_blob (engine, blob_a, &error);
+	g_assert_no_error (error);
+	g_assert_true (silo_a2 == silo_a1);
+
+	/* adding C evicts B but not A */
+	silo_c = fu_engine_get_silo_from_blob (engine, blob_c, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo_c);
+	silo_a3 = fu_engine_get_silo_from_blob (engine, blob_a, &error);
+	g_assert_no_error (error);
+	g_assert_true (silo_a3 == silo_a1);
+	silo_b2 = fu_engine_get_silo_from_blob (engine, blob_b, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo_b2);
+	g_assert_true (silo_b2 != silo_b1);
+}
+
 static void
 fu_engine_require_hwid_func (gconstpointer user_data)
 {
@@ -2462,6 +2674,61 @@ fu_plugin_module_func (gconstpointer user_data)
 	g_unlink (pending_cap);
 }
 
+static void
+fu_firmware_cache_func (gconstpointer user_data)
+{
+	gboolean ret;
+	const gchar *checksums[] = { "aaaa", "bbbb", "cccc", NULL };
+	g_autofree gchar *cachedir = g_build_filename ("/tmp/fwupd-self-test", "firmware", NULL);
+	g_autofree gchar *fn_keep = NULL;
+	g_autofree gchar *fn_invalid = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* the checksum is used as a path component */
+	fn_invalid = fu_firmware_cache_build_filename (cachedir, "../../etc/passwd", &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (fn_invalid);
+	g_clear_error (&error);
+
+	/* add three files, oldest first */
+	for (guint i = 0; checksums[i] != NULL; i++) {
+		struct utimbuf times = { 0x0 };
+		g_autofree gchar *fn = NULL;
+		fn = fu_firmware_cache_build_filename (cachedir, checksums[i], &error);
+		g_assert_no_error (error);
+		g_assert_nonnull (fn);
+		ret = fu_common_mkdir_parent (fn, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = g_file_set_contents (fn, "0123456789", 10, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		times.actime = times.modtime = 1000 + i;
+		g_assert_cmpint (g_utime (fn, &times), ==, 0);
+	}
+
+	/* using the oldest makes it the most recently used */
+	fn_keep = fu_firmware_cache_build_filename (cachedir, "aaaa", &error);
+	g_assert_no_error (error);
+	fu_firmware_cache_touch (fn_keep);
+
+	/* evict down to two files */
+	ret = fu_firmware_cache_prune (cachedir, 25, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	for (guint i = 0; checksums[i] != NULL; i++) {
+		g_autofree gchar *fn = fu_firmware_cache_build_filename (cachedir, checksums[i], NULL);
+		g_assert_true (g_file_test (fn, G_FILE_TEST_EXISTS) == (i != 1));
+	}
+
+	/* the file being installed is never evicted */
+	ret = fu_firmware_cache_prune (cachedir, 0, fn_keep, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_true (g_file_test (fn_keep, G_FILE_TEST_EXISTS));
+	g_unlink (fn_keep);
+}
+
 static void
 fu_history_func (gconstpointer user_data)
 {
@@ -2514,6 +2781,9 @@ fu_history_func (gconstpointer user_data)
 
 	g_object_unref (device);
 
+	/* close the database, which gets reopened on demand */
+	fu_history_unload (history);
+
 	/* get device */
 	device = fu_history_get_device_by_id (history, "2ba16d10df45823dd4494ff10a0bfccfef512c9d", &error);
 	g_assert_no_error (error);
@@ -2645,6 +2915,13 @@ _plugin_composite_device_added_cb (FuPlugin *plugin, FuDevice *device, gpointer
 	g_ptr_array_add (devices, g_object_ref (device));
 }
 
+static void
+_plugin_composite_percentage_changed_cb (FuEngine *engine, guint percentage, gpointer user_data)
+{
+	GArray *percentages = (GArray *) user_data;
+	g_array_append_val (percentages, percentage);
+}
+
 static void
 fu_plugin_composite_func (gconstpointer user_data)
 {
@@ -2655,6 +2932,7 @@ fu_plugin_composite_func (gconstpointer user_data)
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GArray) percentages = g_array_new (FALSE, FALSE, sizeof(guint));
 	g_autoptr(GPtrArray) install_tasks = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
 	g_autoptr(XbSilo) silo = NULL;
@@ -2774,6 +3052,9 @@ fu_plugin_composite_func (gconstpointer user_data)
 	g_assert_cmpint (install_tasks->len, ==, 3);
 
 	/* install the cab */
+	g_signal_connect (engine, "percentage-changed",
+			  G_CALLBACK (_plugin_composite_percentage_changed_cb),
+			  percentages);
 	ret = fu_engine_install_tasks (engine,
 				       install_tasks,
 				       blob,
@@ -2782,6 +3063,17 @@ fu_plugin_composite_func (gconstpointer user_data)
 	g_assert_no_error (error);
 	g_assert_true (ret);
 
+	/* one percentage for all three devices, which never goes backwards and
+	 * only gets to 100% when the last device has finished */
+	g_assert_cmpint (percentages->len, >, 1);
+	for (guint i = 1; i < percentages->len; i++) {
+		g_assert_cmpint (g_array_index (percentages, guint, i), >=,
+				 g_array_index (percentages, guint, i - 1));
+	}
+	for (guint i = 0; i < percentages->len - 1; i++)
+		g_assert_cmpint (g_array_index (percentages, guint, i), <, 100);
+	g_assert_cmpint (g_array_index (percentages, guint, percentages->len - 1), ==, 100);
+
 	/* verify everything upgraded */
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index (devices, i);
@@ -2906,6 +3198,132 @@ fu_progressbar_func (gconstpointer user_data)
 	fu_progressbar_update (progressbar, FWUPD_STATUS_IDLE, 0);
 }
 
+static void
+fu_metrics_func (gconstpointer user_data)
+{
+	const gchar *kind = NULL;
+	g_autoptr(FuMetrics) metrics = fu_metrics_new ();
+	g_autoptr(GVariant) child = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	/* no samples */
+	g_assert_cmpint (fu_metrics_get_count (metrics, "GetDevices"), ==, 0);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "GetDevices", 50), ==, 0);
+
+	/* 1us to 100us, rounded up to the bucket size */
+	for (guint i = 1; i <= 100; i++)
+		fu_metrics_add_sample (metrics, "GetDevices", i, 10);
+	g_assert_cmpint (fu_metrics_get_count (metrics, "GetDevices"), ==, 100);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "GetDevices", 50), ==, 51);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "GetDevices", 95), ==, 95);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "GetDevices", 99), ==, 103);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "GetDevices", 100), ==, 103);
+
+	/* very slow */
+	fu_metrics_add_sample (metrics, "Install", G_MAXUINT64, 0);
+	g_assert_cmpint (fu_metrics_get_percentile (metrics, "Install", 50), >, 0);
+
+	/* export */
+	fu_metrics_set_kind (metrics, "method");
+	val = g_variant_ref_sink (fu_metrics_to_variant (metrics));
+	g_assert_cmpint (g_variant_n_children (val), ==, 2);
+	child = g_variant_get_child_value (val, 0);
+	g_assert_true (g_variant_lookup (child, "Kind", "&s", &kind));
+	g_assert_cmpstr (kind, ==, "method");
+}
+
+static void
+fu_auth_cache_func (gconstpointer user_data)
+{
+	g_autoptr(FuAuthCache) auth_cache = fu_auth_cache_new ();
+
+	/* hit */
+	fu_auth_cache_add (auth_cache, ":1.23", "org.freedesktop.fwupd.update-internal");
+	g_assert_true (fu_auth_cache_lookup (auth_cache, ":1.23", "org.freedesktop.fwupd.update-internal"));
+	g_assert_false (fu_auth_cache_lookup (auth_cache, ":1.23", "org.freedesktop.fwupd.downgrade-hotplug"));
+	g_assert_false (fu_auth_cache_lookup (auth_cache, ":1.24", "org.freedesktop.fwupd.update-internal"));
+
+	/* invalidated when the client disconnects */
+	fu_auth_cache_add (auth_cache, ":1.23", "org.freedesktop.fwupd.downgrade-hotplug");
+	fu_auth_cache_add (auth_cache, ":1.24", "org.freedesktop.fwupd.update-internal");
+	g_assert_true (fu_auth_cache_has_sender (auth_cache, ":1.23"));
+	g_assert_cmpint (fu_auth_cache_remove_sender (auth_cache, ":1.23"), ==, 2);
+	g_assert_false (fu_auth_cache_has_sender (auth_cache, ":1.23"));
+	g_assert_false (fu_auth_cache_lookup (auth_cache, ":1.23", "org.freedesktop.fwupd.update-internal"));
+	g_assert_true (fu_auth_cache_lookup (auth_cache, ":1.24", "org.freedesktop.fwupd.update-internal"));
+	g_assert_cmpint (fu_auth_cache_remove_sender (auth_cache, ":1.23"), ==, 0);
+
+	/* expired, which also prunes the other expired entries */
+	fu_auth_cache_set_max_age (auth_cache, 0);
+	fu_auth_cache_add (auth_cache, ":1.25", "org.freedesktop.fwupd.update-internal");
+	fu_auth_cache_add (auth_cache, ":1.25", "org.freedesktop.fwupd.downgrade-hotplug");
+	g_assert_false (fu_auth_cache_lookup (auth_cache, ":1.25", "org.freedesktop.fwupd.update-internal"));
+	g_assert_true (fu_auth_cache_has_sender (auth_cache, ":1.25"));
+	fu_auth_cache_add (auth_cache, ":1.26", "org.freedesktop.fwupd.update-internal");
+	g_assert_false (fu_auth_cache_has_sender (auth_cache, ":1.25"));
+	g_assert_true (fu_auth_cache_lookup (auth_cache, ":1.24", "org.freedesktop.fwupd.update-internal"));
+}
+
+static void
+fu_progress_limiter_percentage_changed_cb (FuProgressLimiter *progress_limiter,
+					   guint percentage,
+					   gpointer user_data)
+{
+	GArray *percentages = (GArray *) user_data;
+	g_array_append_val (percentages, percentage);
+}
+
+static void
+fu_progress_limiter_func (gconstpointer user_data)
+{
+	g_autoptr(FuProgressLimiter) progress_limiter = fu_progress_limiter_new ();
+	g_autoptr(GArray) percentages = g_array_new (FALSE, FALSE, sizeof(guint));
+
+	g_signal_connect (progress_limiter, "percentage-changed",
+			  G_CALLBACK (fu_progress_limiter_percentage_changed_cb),
+			  percentages);
+
+	/* nothing set yet */
+	fu_progress_limiter_flush (progress_limiter);
+	g_assert_cmpint (percentages->len, ==, 0);
+
+	/* the first 0% is always sent */
+	fu_progress_limiter_set_interval (progress_limiter, 200);
+	fu_progress_limiter_set_percentage (progress_limiter, 0);
+	g_assert_cmpint (percentages->len, ==, 1);
+	g_assert_cmpint (g_array_index (percentages, guint, 0), ==, 0);
+
+	/* coalesced, and the last value sent when the interval has passed */
+	for (guint i = 1; i < 50; i++)
+		fu_progress_limiter_set_percentage (progress_limiter, i);
+	g_assert_cmpint (percentages->len, ==, 1);
+	fu_test_loop_run_with_timeout (500);
+	fu_test_loop_quit ();
+	g_assert_cmpint (percentages->len, ==, 2);
+	g_assert_cmpint (g_array_index (percentages, guint, 1), ==, 49);
+
+	/* sent straight away after the interval, and on flush */
+	fu_progress_limiter_set_percentage (progress_limiter, 60);
+	fu_progress_limiter_set_percentage (progress_limiter, 61);
+	g_assert_cmpint (percentages->len, ==, 3);
+	g_assert_cmpint (g_array_index (percentages, guint, 2), ==, 60);
+	fu_progress_limiter_flush (progress_limiter);
+	g_assert_cmpint (percentages->len, ==, 4);
+	g_assert_cmpint (g_array_index (percentages, guint, 3), ==, 61);
+
+	/* the end is always sent, but not repeated */
+	fu_progress_limiter_set_percentage (progress_limiter, 100);
+	fu_progress_limiter_set_percentage (progress_limiter, 100);
+	g_assert_cmpint (percentages->len, ==, 5);
+	g_assert_cmpint (g_array_index (percentages, guint, 4), ==, 100);
+
+	/* no limit */
+	fu_progress_limiter_set_interval (progress_limiter, 0);
+	fu_progress_limiter_set_percentage (progress_limiter, 1);
+	fu_progress_limiter_set_percentage (progress_limiter, 2);
+	g_assert_cmpint (percentages->len, ==, 7);
+}
+
 static gint
 fu_install_task_compare_func_cb (gconstpointer a, gconstpointer b)
 {
@@ -2996,8 +3414,16 @@ main (int argc, char **argv)
 			      fu_device_list_remove_chain_func);
 	g_test_add_data_func ("/fwupd/install-task{compare}", self,
 			      fu_install_task_compare_func);
+	g_test_add_data_func ("/fwupd/metrics", self,
+			      fu_metrics_func);
+	g_test_add_data_func ("/fwupd/auth-cache", self,
+			      fu_auth_cache_func);
+	g_test_add_data_func ("/fwupd/progress-limiter", self,
+			      fu_progress_limiter_func);
 	g_test_add_data_func ("/fwupd/engine{device-unlock}", self,
 			      fu_engine_device_unlock_func);
+	g_test_add_data_func ("/fwupd/engine{snapshot}", self,
+			      fu_engine_snapshot_func);
 	g_test_add_data_func ("/fwupd/engine{multiple-releases}", self,
 			      fu_engine_multiple_rels_func);
 	g_test_add_data_func ("/fwupd/engine{history-success}", self,
@@ -3010,6 +3436,10 @@ main (int argc, char **argv)
 	}
 	g_test_add_data_func ("/fwupd/device-list{replug-user}", self,
 			      fu_device_list_replug_user_func);
+	g_test_add_data_func ("/fwupd/engine{cabinet-cache}", self,
+			      fu_engine_cabinet_cache_func);
+	g_test_add_data_func ("/fwupd/engine{cabinet-cache-evict}", self,
+			      fu_engine_cabinet_cache_evict_func);
 	g_test_add_data_func ("/fwupd/engine{require-hwid}", self,
 			      fu_engine_require_hwid_func);
 	g_test_add_data_func ("/fwupd/engine{history-inherit}", self,
@@ -3048,12 +3478,16 @@ main (int argc, char **argv)
 			      fu_engine_install_duration_func);
 	g_test_add_data_func ("/fwupd/engine{generate-md}", self,
 			      fu_engine_generate_md_func);
+	g_test_add_data_func ("/fwupd/engine{shed-memory-metadata}", self,
+			      fu_engine_shed_memory_metadata_func);
 	g_test_add_data_func ("/fwupd/engine{requirements-other-device}", self,
 			      fu_engine_requirements_other_device_func);
 	g_test_add_data_func ("/fwupd/plugin{composite}", self,
 			      fu_plugin_composite_func);
 	g_test_add_data_func ("/fwupd/history", self,
 			      fu_history_func);
+	g_test_add_data_func ("/fwupd/firmware-cache", self,
+			      fu_firmware_cache_func);
 	g_test_add_data_func ("/fwupd/history{migrate}", self,
 			      fu_history_migrate_func);
 	g_test_add_data_func ("/fwupd/plugin-list", self,
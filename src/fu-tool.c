@@ -21,6 +21,7 @@
 #include <libsoup/soup.h>
 #include <jcat.h>
 
+#include "fu-common-delta.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
 #include "fu-history.h"
@@ -1650,6 +1651,176 @@ fu_util_firmware_parse (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+/* each measurement is repeated until it takes at least this long */
+#define FU_UTIL_BENCHMARK_MIN_ELAPSED		0.1f	/* s */
+
+/* throughput at the largest size must not drop below this fraction of the
+ * throughput at the second-smallest size, which catches parsers that have
+ * become quadratic without depending on the speed of the CI machine */
+#define FU_UTIL_BENCHMARK_SCALING_MIN		0.25f
+
+static GBytes *
+fu_util_firmware_benchmark_payload (gsize bufsz)
+{
+	guint32 seed = 0x12345678;
+	guint8 *buf = g_malloc (bufsz);
+
+	/* deterministic so runs are comparable, but not trivially compressible */
+	for (gsize i = 0; i < bufsz; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = (guint8) (seed >> 16);
+	}
+	return g_bytes_new_take (buf, bufsz);
+}
+
+static gdouble
+fu_util_firmware_benchmark_parse (GType gtype,
+				  GBytes *blob,
+				  FwupdInstallFlags flags,
+				  GError **error)
+{
+	guint cnt = 0;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	do {
+		g_autoptr(FuFirmware) firmware = g_object_new (gtype, NULL);
+		if (!fu_firmware_parse (firmware, blob, flags, error))
+			return -1.f;
+		cnt++;
+	} while (g_timer_elapsed (timer, NULL) < FU_UTIL_BENCHMARK_MIN_ELAPSED);
+	return (gdouble) g_bytes_get_size (blob) * cnt /
+		(g_timer_elapsed (timer, NULL) * 1024 * 1024);
+}
+
+static gdouble
+fu_util_firmware_benchmark_write (FuFirmware *firmware, GError **error)
+{
+	gsize bufsz = 0;
+	guint cnt = 0;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	do {
+		g_autoptr(GBytes) blob = fu_firmware_write (firmware, error);
+		if (blob == NULL)
+			return -1.f;
+		bufsz = g_bytes_get_size (blob);
+		cnt++;
+	} while (g_timer_elapsed (timer, NULL) < FU_UTIL_BENCHMARK_MIN_ELAPSED);
+	return (gdouble) bufsz * cnt /
+		(g_timer_elapsed (timer, NULL) * 1024 * 1024);
+}
+
+static gboolean
+fu_util_firmware_benchmark_gtype (FuUtilPrivate *priv,
+				  const gchar *id,
+				  GError **error)
+{
+	GType gtype = fu_engine_get_firmware_gtype_by_id (priv->engine, id);
+	gdouble rate_first = -1.f;
+	gdouble rate_last = -1.f;
+	const gsize sizes[] = { 0x1000, 0x10000, 0x100000, 0x400000, 0 };
+
+	for (guint i = 0; sizes[i] != 0; i++) {
+		gdouble rate_parse;
+		gdouble rate_write;
+		g_autofree gchar *sizestr = g_format_size (sizes[i]);
+		g_autoptr(FuFirmware) firmware = g_object_new (gtype, NULL);
+		g_autoptr(FuFirmwareImage) img = NULL;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GBytes) payload = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* build the synthetic corpus using the type itself */
+		payload = fu_util_firmware_benchmark_payload (sizes[i]);
+		img = fu_firmware_image_new (payload);
+		fu_firmware_add_image (firmware, img);
+		blob = fu_firmware_write (firmware, &error_local);
+		if (blob == NULL) {
+			g_print ("%-16s %10s  skipped: %s\n",
+				 id, sizestr, error_local->message);
+			return TRUE;
+		}
+		rate_write = fu_util_firmware_benchmark_write (firmware, error);
+		if (rate_write < 0.f)
+			return FALSE;
+		rate_parse = fu_util_firmware_benchmark_parse (gtype,
+							      blob,
+							      priv->flags | FWUPD_INSTALL_FLAG_FORCE,
+							      &error_local);
+		if (rate_parse < 0.f) {
+			g_print ("%-16s %10s  skipped: cannot parse own output: %s\n",
+				 id, sizestr, error_local->message);
+			return TRUE;
+		}
+		g_print ("%-16s %10s  parse %9.1f MB/s  write %9.1f MB/s\n",
+			 id, sizestr, rate_parse, rate_write);
+
+		/* the smallest size is dominated by fixed overhead */
+		if (i == 1)
+			rate_first = rate_parse;
+		rate_last = rate_parse;
+	}
+
+	/* check the parser scales linearly */
+	if (rate_first > 0.f && rate_last < rate_first * FU_UTIL_BENCHMARK_SCALING_MIN) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INTERNAL,
+			     "%s parse throughput regressed from %.1f MB/s to %.1f MB/s "
+			     "as the firmware size increased",
+			     id, rate_first, rate_last);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gint
+fu_util_firmware_type_sort_cb (const gchar **item1, const gchar **item2)
+{
+	return g_strcmp0 (*item1, *item2);
+}
+
+static gboolean
+fu_util_firmware_benchmark (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	g_autoptr(GPtrArray) firmware_types = NULL;
+
+	/* check args */
+	if (g_strv_length (values) > 1) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments, expected [FIRMWARE-TYPE]");
+		return FALSE;
+	}
+
+	/* load engine */
+	if (!fu_engine_load (priv->engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, error))
+		return FALSE;
+
+	/* just one type */
+	if (g_strv_length (values) == 1) {
+		if (fu_engine_get_firmware_gtype_by_id (priv->engine, values[0]) == G_TYPE_INVALID) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_NOT_FOUND,
+				     "GType %s not supported", values[0]);
+			return FALSE;
+		}
+		return fu_util_firmware_benchmark_gtype (priv, values[0], error);
+	}
+
+	/* every registered type */
+	firmware_types = fu_engine_get_firmware_gtype_ids (priv->engine);
+	g_ptr_array_sort (firmware_types, (GCompareFunc) fu_util_firmware_type_sort_cb);
+	for (guint i = 0; i < firmware_types->len; i++) {
+		const gchar *id = g_ptr_array_index (firmware_types, i);
+		if (!fu_util_firmware_benchmark_gtype (priv, id, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_util_firmware_convert (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -1740,6 +1911,47 @@ fu_util_firmware_convert (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_util_firmware_delta (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	g_autoptr(GBytes) blob_delta = NULL;
+	g_autoptr(GBytes) blob_src = NULL;
+	g_autoptr(GBytes) blob_dst = NULL;
+	g_autoptr(GBytes) blob_tmp = NULL;
+
+	/* check args */
+	if (g_strv_length (values) != 3) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments, expected FILENAME-SRC FILENAME-DST FILENAME-DELTA");
+		return FALSE;
+	}
+
+	/* load files */
+	blob_src = fu_common_get_contents_bytes (values[0], error);
+	if (blob_src == NULL)
+		return FALSE;
+	blob_dst = fu_common_get_contents_bytes (values[1], error);
+	if (blob_dst == NULL)
+		return FALSE;
+
+	/* generate, and check it round-trips before saving */
+	blob_delta = fu_common_delta_generate (blob_src, blob_dst, error);
+	if (blob_delta == NULL)
+		return FALSE;
+	blob_tmp = fu_common_delta_apply (blob_src, blob_delta, error);
+	if (blob_tmp == NULL)
+		return FALSE;
+	if (!fu_common_set_contents_bytes (values[2], blob_delta, error))
+		return FALSE;
+	g_print ("Wrote %s: %" G_GSIZE_FORMAT " bytes, %.1f%% of the full image\n",
+		 values[2], g_bytes_get_size (blob_delta),
+		 g_bytes_get_size (blob_dst) > 0 ?
+		 100.f * g_bytes_get_size (blob_delta) / g_bytes_get_size (blob_dst) : 0.f);
+	return TRUE;
+}
+
 static gboolean
 fu_util_verify_update (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -2152,6 +2364,18 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: command description */
 		     _("Convert a firmware file"),
 		     fu_util_firmware_convert);
+	fu_util_cmd_array_add (cmd_array,
+		     "firmware-delta",
+		     "FILENAME-SRC FILENAME-DST FILENAME-DELTA",
+		     /* TRANSLATORS: command description */
+		     _("Generate a binary delta between two firmware files"),
+		     fu_util_firmware_delta);
+	fu_util_cmd_array_add (cmd_array,
+		     "firmware-benchmark",
+		     "[FIRMWARE-TYPE]",
+		     /* TRANSLATORS: command description */
+		     _("Measure the parse and write speed of firmware types"),
+		     fu_util_firmware_benchmark);
 	fu_util_cmd_array_add (cmd_array,
 		     "firmware-parse",
 		     "FILENAME [FIRMWARE-TYPE]",
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include "fu-firmware-cache.h"
 #include "fu-history.h"
 #include "fu-plugin-private.h"
 #include "fu-progressbar.h"
@@ -672,71 +673,16 @@ fu_util_clear_history (FuUtilPrivate *priv, gchar **values, GError **error)
 }
 
 static gboolean
-fu_util_report_history_for_remote (FuUtilPrivate *priv,
-				const gchar *remote_id,
-				GPtrArray *devices,
-				GError **error)
+fu_util_report_history_parse_response (const gchar *report_uri,
+				       SoupMessage *msg,
+				       guint status_code,
+				       GError **error)
 {
 	JsonNode *json_root;
 	JsonObject *json_object;
 	const gchar *server_msg = NULL;
-	guint status_code;
-	const gchar *report_uri;
-	g_autofree gchar *data = NULL;
-	g_autofree gchar *sig = NULL;
 	g_autoptr(JsonParser) json_parser = NULL;
-	g_autoptr(SoupMessage) msg = NULL;
-	g_autoptr(FwupdRemote) remote = NULL;
-
-	/* convert to JSON */
-	data = fwupd_build_history_report_json (devices, error);
-	if (data == NULL)
-		return FALSE;
-
-	/* self sign data */
-	if (priv->sign) {
-		sig = fwupd_client_self_sign (priv->client, data,
-					      FWUPD_SELF_SIGN_FLAG_ADD_TIMESTAMP,
-					      priv->cancellable, error);
-		if (sig == NULL)
-			return FALSE;
-	}
-
-	remote = fwupd_client_get_remote_by_id (priv->client, remote_id,
-						NULL, error);
-	if (remote == NULL)
-		return FALSE;
-	report_uri = fwupd_remote_get_report_uri (remote);
-
-	/* ask for permission */
-	if (!priv->assume_yes && !fwupd_remote_get_automatic_reports (remote)) {
-		fu_util_print_data (_("Target"), report_uri);
-		fu_util_print_data (_("Payload"), data);
-		if (sig != NULL)
-			fu_util_print_data (_("Signature"), sig);
-		g_print ("%s [Y|n]: ", _("Proceed with upload?"));
-		if (!fu_util_prompt_for_boolean (TRUE)) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_PERMISSION_DENIED,
-					     "User declined action");
-			return FALSE;
-		}
-	}
 
-	/* POST request */
-	if (sig != NULL) {
-		g_autoptr(SoupMultipart) mp = NULL;
-		mp = soup_multipart_new (SOUP_FORM_MIME_TYPE_MULTIPART);
-		soup_multipart_append_form_string (mp, "payload", data);
-		soup_multipart_append_form_string (mp, "signature", sig);
-		msg = soup_form_request_new_from_multipart (report_uri, mp);
-	} else {
-		msg = soup_message_new (SOUP_METHOD_POST, report_uri);
-		soup_message_set_request (msg, "application/json; charset=utf-8",
-					  SOUP_MEMORY_COPY, data, strlen (data));
-	}
-	status_code = soup_session_send_message (priv->soup_session, msg);
 	g_debug ("server returned: %s", msg->response_body->data);
 
 	/* server returned nothing, and probably exploded in a ball of flames */
@@ -822,6 +768,117 @@ fu_util_report_history_for_remote (FuUtilPrivate *priv,
 	return TRUE;
 }
 
+/* writes the report to a temporary file rather than building it in memory */
+static GMappedFile *
+fu_util_report_history_build_mapped (FuUtilPrivate *priv,
+				     GPtrArray *devices,
+				     GFile **file,
+				     GError **error)
+{
+	GOutputStream *ostream;
+	g_autofree gchar *path = NULL;
+	g_autoptr(GFileIOStream) iostream = NULL;
+
+	*file = g_file_new_tmp ("fwupd-report-XXXXXX.json", &iostream, error);
+	if (*file == NULL)
+		return NULL;
+	ostream = g_io_stream_get_output_stream (G_IO_STREAM (iostream));
+	if (!fwupd_build_history_report_json_to_stream (devices, ostream,
+							FWUPD_REPORT_FLAG_NONE,
+							priv->cancellable, error))
+		return NULL;
+	if (!g_io_stream_close (G_IO_STREAM (iostream), priv->cancellable, error))
+		return NULL;
+	path = g_file_get_path (*file);
+	return g_mapped_file_new (path, FALSE, error);
+}
+
+static gboolean
+fu_util_report_history_for_remote (FuUtilPrivate *priv,
+				const gchar *remote_id,
+				GPtrArray *devices,
+				GError **error)
+{
+	guint status_code;
+	const gchar *report_uri;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *sig = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GMappedFile) mapped = NULL;
+	g_autoptr(SoupMessage) msg = NULL;
+	g_autoptr(FwupdRemote) remote = NULL;
+
+	remote = fwupd_client_get_remote_by_id (priv->client, remote_id,
+						NULL, error);
+	if (remote == NULL)
+		return FALSE;
+	report_uri = fwupd_remote_get_report_uri (remote);
+
+	/* the report is not shown or signed, so stream it */
+	if (!priv->sign &&
+	    (priv->assume_yes || fwupd_remote_get_automatic_reports (remote))) {
+		mapped = fu_util_report_history_build_mapped (priv, devices, &file, error);
+		if (mapped == NULL) {
+			if (file != NULL)
+				g_file_delete (file, NULL, NULL);
+			return FALSE;
+		}
+		msg = soup_message_new (SOUP_METHOD_POST, report_uri);
+		soup_message_set_request (msg, "application/json; charset=utf-8",
+					  SOUP_MEMORY_STATIC,
+					  g_mapped_file_get_contents (mapped),
+					  g_mapped_file_get_length (mapped));
+		status_code = soup_session_send_message (priv->soup_session, msg);
+		g_file_delete (file, NULL, NULL);
+		return fu_util_report_history_parse_response (report_uri, msg, status_code, error);
+	}
+
+	/* convert to JSON */
+	data = fwupd_build_history_report_json (devices, error);
+	if (data == NULL)
+		return FALSE;
+
+	/* self sign data */
+	if (priv->sign) {
+		sig = fwupd_client_self_sign (priv->client, data,
+					      FWUPD_SELF_SIGN_FLAG_ADD_TIMESTAMP,
+					      priv->cancellable, error);
+		if (sig == NULL)
+			return FALSE;
+	}
+
+	/* ask for permission */
+	if (!priv->assume_yes && !fwupd_remote_get_automatic_reports (remote)) {
+		fu_util_print_data (_("Target"), report_uri);
+		fu_util_print_data (_("Payload"), data);
+		if (sig != NULL)
+			fu_util_print_data (_("Signature"), sig);
+		g_print ("%s [Y|n]: ", _("Proceed with upload?"));
+		if (!fu_util_prompt_for_boolean (TRUE)) {
+			g_set_error_literal (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_PERMISSION_DENIED,
+					     "User declined action");
+			return FALSE;
+		}
+	}
+
+	/* POST request */
+	if (sig != NULL) {
+		g_autoptr(SoupMultipart) mp = NULL;
+		mp = soup_multipart_new (SOUP_FORM_MIME_TYPE_MULTIPART);
+		soup_multipart_append_form_string (mp, "payload", data);
+		soup_multipart_append_form_string (mp, "signature", sig);
+		msg = soup_form_request_new_from_multipart (report_uri, mp);
+	} else {
+		msg = soup_message_new (SOUP_METHOD_POST, report_uri);
+		soup_message_set_request (msg, "application/json; charset=utf-8",
+					  SOUP_MEMORY_COPY, data, strlen (data));
+	}
+	status_code = soup_session_send_message (priv->soup_session, msg);
+	return fu_util_report_history_parse_response (report_uri, msg, status_code, error);
+}
+
 static gboolean
 fu_util_report_history (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -1771,25 +1828,20 @@ fu_util_get_remotes (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
-static gboolean
-fu_util_update_device_with_release (FuUtilPrivate *priv,
-				    FwupdDevice *dev,
-				    FwupdRelease *rel,
-				    GError **error)
+/* returns the local filename of the firmware, downloading it if required */
+static gchar *
+fu_util_download_release (FuUtilPrivate *priv, FwupdRelease *rel, GError **error)
 {
 	GPtrArray *checksums;
+	const gchar *checksum;
 	const gchar *remote_id;
 	const gchar *uri_tmp;
+	g_autofree gchar *cachedir = NULL;
 	g_autofree gchar *fn = NULL;
 	g_autofree gchar *uri_str = NULL;
 	g_autoptr(SoupURI) uri = NULL;
-
-	if (!priv->no_safety_check && !priv->assume_yes) {
-		if (!fu_util_prompt_warning (dev,
-					     fu_util_get_tree_title (priv),
-					     error))
-			return FALSE;
-	}
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GError) error_prune = NULL;
 
 	/* work out what remote-specific URI fields this should use */
 	uri_tmp = fwupd_release_get_uri (rel);
@@ -1801,44 +1853,72 @@ fu_util_update_device_with_release (FuUtilPrivate *priv,
 							NULL,
 							error);
 		if (remote == NULL)
-			return FALSE;
+			return NULL;
 
 		/* local and directory remotes have the firmware already */
 		if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_LOCAL) {
 			const gchar *fn_cache = fwupd_remote_get_filename_cache (remote);
 			g_autofree gchar *path = g_path_get_dirname (fn_cache);
-
-			fn = g_build_filename (path, uri_tmp, NULL);
-		} else if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
-			fn = g_strdup (uri_tmp + 7);
-		}
-		/* install with flags chosen by the user */
-		if (fn != NULL) {
-			return fwupd_client_install (priv->client,
-						     fwupd_device_get_id (dev),
-						     fn, priv->flags, NULL, error);
+			return g_build_filename (path, uri_tmp, NULL);
 		}
+		if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY)
+			return g_strdup (uri_tmp + 7);
 
 		uri_str = fwupd_remote_build_firmware_uri (remote, uri_tmp, error);
 		if (uri_str == NULL)
-			return FALSE;
+			return NULL;
 	} else {
 		uri_str = g_strdup (uri_tmp);
 	}
 
+	/* the firmware store is keyed by checksum so that the same archive is
+	 * only downloaded once for multiple devices or reinstalls */
+	checksums = fwupd_release_get_checksums (rel);
+	checksum = fwupd_checksum_get_best (checksums);
+	cachedir = fu_firmware_cache_get_dir ();
+	fn = fu_firmware_cache_build_filename (cachedir, checksum, &error_local);
+	if (fn == NULL) {
+		g_debug ("not using firmware cache: %s", error_local->message);
+		fn = fu_util_get_user_cache_path (uri_str);
+	}
+	if (!fu_common_mkdir_parent (fn, error))
+		return NULL;
+	uri = soup_uri_new (uri_str);
+	if (!fu_util_download_file (priv, uri, fn, checksum, error))
+		return NULL;
+
+	/* mark as recently used, then keep the store within the size cap */
+	fu_firmware_cache_touch (fn);
+	if (!fu_firmware_cache_prune (cachedir,
+				      FU_FIRMWARE_CACHE_MAX_SIZE_DEFAULT,
+				      fn, &error_prune))
+		g_warning ("failed to prune firmware cache: %s", error_prune->message);
+	return g_steal_pointer (&fn);
+}
+
+static gboolean
+fu_util_update_device_with_release (FuUtilPrivate *priv,
+				    FwupdDevice *dev,
+				    FwupdRelease *rel,
+				    GError **error)
+{
+	g_autofree gchar *fn = NULL;
+
+	if (!priv->no_safety_check && !priv->assume_yes) {
+		if (!fu_util_prompt_warning (dev,
+					     fu_util_get_tree_title (priv),
+					     error))
+			return FALSE;
+	}
+
 	/* download file */
 	g_print ("Downloading %s for %s...\n",
 		 fwupd_release_get_version (rel),
 		 fwupd_device_get_name (dev));
-	fn = fu_util_get_user_cache_path (uri_str);
-	if (!fu_common_mkdir_parent (fn, error))
-		return FALSE;
-	checksums = fwupd_release_get_checksums (rel);
-	uri = soup_uri_new (uri_str);
-	if (!fu_util_download_file (priv, uri, fn,
-				    fwupd_checksum_get_best (checksums),
-				    error))
+	fn = fu_util_download_release (priv, rel, error);
+	if (fn == NULL)
 		return FALSE;
+
 	/* if the device specifies ONLY_OFFLINE automatically set this flag */
 	if (fwupd_device_has_flag (dev, FWUPD_DEVICE_FLAG_ONLY_OFFLINE))
 		priv->flags |= FWUPD_INSTALL_FLAG_OFFLINE;
@@ -1961,6 +2041,70 @@ fu_util_update_all (FuUtilPrivate *priv, GError **error)
 	return fu_util_prompt_complete (priv->completion_flags, TRUE, error);
 }
 
+static gboolean
+fu_util_prefetch (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	guint cnt = 0;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	/* this is designed to be run unattended, so be a good citizen */
+	if ((priv->flags & FWUPD_INSTALL_FLAG_FORCE) == 0 &&
+	    g_network_monitor_get_network_metered (g_network_monitor_get_default ())) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOTHING_TO_DO,
+				     "Not downloading firmware on a metered connection");
+		return FALSE;
+	}
+
+	/* get devices from daemon */
+	devices = fwupd_client_get_devices (priv->client, NULL, error);
+	if (devices == NULL)
+		return FALSE;
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		FwupdRelease *rel;
+		g_autofree gchar *fn = NULL;
+		g_autoptr(GPtrArray) rels = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* not going to have results, so save a D-Bus round-trip */
+		if (!fwupd_device_has_flag (dev, FWUPD_DEVICE_FLAG_UPDATABLE))
+			continue;
+		if (!fwupd_device_has_flag (dev, FWUPD_DEVICE_FLAG_SUPPORTED))
+			continue;
+		if (!fu_util_filter_device (priv, dev))
+			continue;
+
+		/* only the release that update would choose */
+		rels = fwupd_client_get_upgrades (priv->client,
+						  fwupd_device_get_id (dev),
+						  NULL, &error_local);
+		if (rels == NULL) {
+			g_debug ("%s", error_local->message);
+			continue;
+		}
+		rel = g_ptr_array_index (rels, 0);
+		g_print ("Downloading %s for %s...\n",
+			 fwupd_release_get_version (rel),
+			 fwupd_device_get_name (dev));
+		fn = fu_util_download_release (priv, rel, error);
+		if (fn == NULL)
+			return FALSE;
+		cnt++;
+	}
+
+	/* nothing pending */
+	if (cnt == 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOTHING_TO_DO,
+				     "No updates to download");
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_util_update_by_id (FuUtilPrivate *priv, const gchar *device_id, GError **error)
 {
@@ -2332,6 +2476,94 @@ fu_util_get_approved_firmware (FuUtilPrivate *priv, gchar **values, GError **err
 	return TRUE;
 }
 
+static void
+fu_util_get_metrics_append_summary (GString *str,
+				    const gchar *name,
+				    const gchar *label,
+				    GVariant *dict)
+{
+	const gchar *id = NULL;
+	const gchar *quantiles[] = { "0.5", "0.95", "0.99", NULL };
+	const gchar *keys[] = { "P50", "P95", "P99", NULL };
+	guint64 count = 0;
+	guint64 sum = 0;
+
+	g_variant_lookup (dict, "Id", "&s", &id);
+	g_variant_lookup (dict, "Count", "t", &count);
+	g_variant_lookup (dict, "Sum", "t", &sum);
+	for (guint i = 0; keys[i] != NULL; i++) {
+		guint64 value = 0;
+		g_variant_lookup (dict, keys[i], "t", &value);
+		g_string_append_printf (str,
+					"%s{%s=\"%s\",quantile=\"%s\"} %.6f\n",
+					name, label, id, quantiles[i],
+					(gdouble) value / G_USEC_PER_SEC);
+	}
+	g_string_append_printf (str, "%s_sum{%s=\"%s\"} %.6f\n",
+				name, label, id, (gdouble) sum / G_USEC_PER_SEC);
+	g_string_append_printf (str, "%s_count{%s=\"%s\"} %" G_GUINT64_FORMAT "\n",
+				name, label, id, count);
+}
+
+/* output in the Prometheus text exposition format */
+static gboolean
+fu_util_get_metrics (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	GVariantIter iter;
+	GVariant *dict;
+	g_autoptr(GString) str = g_string_new (NULL);
+	g_autoptr(GString) str_auth = g_string_new (NULL);
+	g_autoptr(GString) str_bytes = g_string_new (NULL);
+	g_autoptr(GVariant) metrics = NULL;
+
+	/* check args */
+	if (g_strv_length (values) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments: none expected");
+		return FALSE;
+	}
+
+	/* call into daemon */
+	metrics = fwupd_client_get_metrics (priv->client, priv->cancellable, error);
+	if (metrics == NULL)
+		return FALSE;
+
+	g_string_append (str, "# HELP fwupd_method_duration_seconds Time taken for the daemon to respond\n");
+	g_string_append (str, "# TYPE fwupd_method_duration_seconds summary\n");
+	g_string_append (str_auth, "# HELP fwupd_authorization_duration_seconds Time taken to check each PolicyKit action\n");
+	g_string_append (str_auth, "# TYPE fwupd_authorization_duration_seconds summary\n");
+	g_string_append (str_bytes, "# HELP fwupd_method_bytes_out_total Size of the daemon responses\n");
+	g_string_append (str_bytes, "# TYPE fwupd_method_bytes_out_total counter\n");
+	g_variant_iter_init (&iter, metrics);
+	while ((dict = g_variant_iter_next_value (&iter)) != NULL) {
+		const gchar *id = NULL;
+		const gchar *kind = NULL;
+		guint64 bytes_out = 0;
+
+		g_variant_lookup (dict, "Id", "&s", &id);
+		g_variant_lookup (dict, "Kind", "&s", &kind);
+		if (g_strcmp0 (kind, "authorization") == 0) {
+			fu_util_get_metrics_append_summary (str_auth,
+							    "fwupd_authorization_duration_seconds",
+							    "action", dict);
+			g_variant_unref (dict);
+			continue;
+		}
+		fu_util_get_metrics_append_summary (str,
+						    "fwupd_method_duration_seconds",
+						    "method", dict);
+		g_variant_lookup (dict, "BytesOut", "t", &bytes_out);
+		g_string_append_printf (str_bytes,
+					"fwupd_method_bytes_out_total{method=\"%s\"} %" G_GUINT64_FORMAT "\n",
+					id, bytes_out);
+		g_variant_unref (dict);
+	}
+	g_print ("%s%s%s", str->str, str_bytes->str, str_auth->str);
+	return TRUE;
+}
+
 static gboolean
 fu_util_modify_config (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -2540,6 +2772,12 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: command description */
 		     _("Erase all firmware update history"),
 		     fu_util_clear_history);
+	fu_util_cmd_array_add (cmd_array,
+		     "prefetch",
+		     NULL,
+		     /* TRANSLATORS: command description */
+		     _("Download pending firmware updates without installing"),
+		     fu_util_prefetch);
 	fu_util_cmd_array_add (cmd_array,
 		     "report-history",
 		     NULL,
@@ -2672,6 +2910,12 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: sets something in daemon.conf */
 		     _("Modifies a daemon configuration value."),
 		     fu_util_modify_config);
+	fu_util_cmd_array_add (cmd_array,
+		     "metrics",
+		     NULL,
+		     /* TRANSLATORS: how long each daemon method takes */
+		     _("Show the latency of daemon requests."),
+		     fu_util_get_metrics);
 	fu_util_cmd_array_add (cmd_array,
 		     "reinstall",
 		     "[DEVICE-ID|GUID]",
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include "fu-cabinet.h"
+#include "fu-common-cab.h"
+
+/* small enough that the fuzzer does not hit the RSS limit */
+#define FU_FUZZER_CAB_SIZE_MAX		(8 * 1024 * 1024)
+
+int		 LLVMFuzzerTestOneInput		(const guint8	*data,
+						 gsize		 size);
+
+int
+LLVMFuzzerTestOneInput (const guint8 *data, gsize size)
+{
+	g_autoptr(GBytes) blob = g_bytes_new (data, size);
+	g_autoptr(GPtrArray) releases = NULL;
+	g_autoptr(XbSilo) silo = NULL;
+
+	silo = fu_common_cab_build_silo (blob, FU_FUZZER_CAB_SIZE_MAX, NULL);
+	if (silo == NULL)
+		return 0;
+
+	/* payloads are only decompressed when the release is loaded */
+	releases = xb_silo_query (silo, "components/component/releases/release", 0, NULL);
+	if (releases == NULL)
+		return 0;
+	for (guint i = 0; i < releases->len; i++) {
+		XbNode *rel = g_ptr_array_index (releases, i);
+		fu_cabinet_load_release (rel, NULL);
+	}
+	return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include "fu-firmware.h"
+
+/* this is defined by the build system, e.g. fu_ihex_firmware_get_type */
+GType		 FU_FUZZER_FIRMWARE_GET_TYPE	(void);
+
+int		 LLVMFuzzerTestOneInput		(const guint8	*data,
+						 gsize		 size);
+
+int
+LLVMFuzzerTestOneInput (const guint8 *data, gsize size)
+{
+	g_autoptr(FuFirmware) firmware = g_object_new (FU_FUZZER_FIRMWARE_GET_TYPE (), NULL);
+	g_autoptr(GBytes) blob = g_bytes_new (data, size);
+	g_autoptr(GBytes) blob_out = NULL;
+	g_autofree gchar *str = NULL;
+
+	if (!fu_firmware_parse (firmware, blob, FWUPD_INSTALL_FLAG_FORCE, NULL))
+		return 0;
+
+	/* exercise the code paths that use the parsed data too */
+	str = fu_firmware_to_string (firmware);
+	blob_out = fu_firmware_write (firmware, NULL);
+	return 0;
+}
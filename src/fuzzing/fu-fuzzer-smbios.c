@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include "fu-smbios-private.h"
+
+int		 LLVMFuzzerTestOneInput		(const guint8	*data,
+						 gsize		 size);
+
+int
+LLVMFuzzerTestOneInput (const guint8 *data, gsize size)
+{
+	g_autoptr(FuSmbios) smbios = fu_smbios_new ();
+	g_autofree gchar *str = NULL;
+
+	if (!fu_smbios_setup_from_data (smbios, data, size, NULL))
+		return 0;
+	str = fu_smbios_to_string (smbios);
+	return 0;
+}